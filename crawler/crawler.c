@@ -8,6 +8,8 @@
  * Description: Implementation of the crawler module of Tiny Search Engine. 
  * 
  */
+#define _POSIX_C_SOURCE 200809L   // clock_gettime
+
 #include <stdio.h>
 #include <stdint.h>
 #include <unistd.h>
@@ -16,12 +18,33 @@
 #include <stdbool.h>
 #include <string.h>
 #include <errno.h>
+#include <pthread.h>
+#include <time.h>
 #include "webpage.h"
 #include "queue.h"
-#include "hash.h"
+#include "urlset.h"
 #include "pageio.h"
-
-#define HASH_LENGTH 20
+#include "fetch.h"
+#include "sched.h"
+#include "pagewriter.h"
+#include "pagestore.h"
+#include "checkpoint.h"
+#include "validators.h"
+#include "simhash.h"
+
+#define MAX_THREADS 64
+#define MAX_CONNS 1024
+#define FETCH_TIMEOUT_MS 30000L  // per transfer, async engine only
+#define FETCH_WAIT_MS 1000
+#define WRITER_QUEUE_LENGTH 64  // fetched pages held in memory before the crawl waits
+#define CHECKPOINT_INTERVAL 100 // pages
+#define CHECKPOINT_FILE ".checkpoint"
+
+#ifndef NOSLEEP // CS50 students: please don't turn off the sleep!
+#define DEFAULT_DELAY_MS 1000  // per host, from the end of one fetch to the next
+#else
+#define DEFAULT_DELAY_MS 0
+#endif
 
 // log one word (1-9 chars) about a given url
 inline static void logr(const char *word, const int depth, const char *url)
@@ -34,36 +57,98 @@ void print_webpage(void* wp){
 	logr("Queued URL", webpage_getDepth(page), webpage_getURL(page));
 }
 
-bool searchfn(void *elementp, const void *keyp) {
-	webpage_t *p = (webpage_t *) elementp;
-	const char *key = (const char *) keyp;
-	return strcmp(webpage_getURL(p), key) == 0;
+static char *pagedir;
+
+/*
+ * recrawl_t -- an earlier crawl of the same site. Pages it saved with
+ * validators are fetched conditionally, and its copy is reused for
+ * those the server reports unchanged.
+ */
+typedef struct recrawl {
+	char *pagedir;
+	validators_t *validators;
+	pagestore_t *store;     // NULL when the old pages are files
+} recrawl_t;
+
+/*
+ * crawl_t -- state shared by all crawler workers.
+ *
+ * lock guards frontier, seen and busy, which counts workers holding a page;
+ * cond is signalled whenever either changes. The crawl is over once the
+ * frontier is empty and no worker is busy, since only a busy worker
+ * can add new urls to the frontier.
+ */
+typedef struct crawl {
+	sched_t *frontier;      // pages waiting to be fetched, per host
+	urlset_t *seen;         // urls ever queued in the frontier
+	simindex_t *near;       // SimHashes of the pages saved; NULL to keep all pages
+	pagewriter_t *writer;   // saves fetched pages in the background
+	recrawl_t *old;         // NULL unless recrawling
+	fetcher_t *fetcher;     // NULL unless crawling with the async engine
+	int max_depth;
+	int busy;
+	int count;              // pages handed to the writer (the last id used)
+	int unchanged;          // pages reused from the old crawl
+	int duplicates;         // pages skipped as near-duplicates
+	char *ckpt_path;        // NULL when not checkpointing
+	int ckpt_interval;      // pages between checkpoints
+	int ckpt_count;         // count at the last checkpoint
+	bool ckpt_due;          // no new pages go out until it is taken
+	bool stopped;           // the crawl ended before the frontier ran dry
+	pthread_mutex_t lock;
+	pthread_cond_t cond;
+} crawl_t;
+
+/*
+ * frontier_put -- queues a new page for url, unless url has been seen
+ * before, and wakes a waiting worker; url must be normalized
+ * returns true if the url was new
+ */
+static bool frontier_put(crawl_t *cp, char *url, int depth) {
+	pthread_mutex_lock(&cp->lock);
+	bool added = urlset_add(cp->seen, url);
+	if (added) {
+		webpage_t *wp = webpage_new(url, depth, NULL);
+		if (wp == NULL || schedput(cp->frontier, wp) != 0) {
+			printf("Failed to queue %s\n", url);
+			webpage_delete(wp);
+		}
+		pthread_cond_signal(&cp->cond);
+	}
+	pthread_mutex_unlock(&cp->lock);
+
+	return added;
 }
 
-static char *pagedir;
+// lets the host of a page taken from the frontier hand out its next one
+static void frontier_done(crawl_t *cp, webpage_t *wp, bool fetched) {
+	pthread_mutex_lock(&cp->lock);
+	scheddone(cp->frontier, wp, fetched);
+	pthread_cond_broadcast(&cp->cond);
+	pthread_mutex_unlock(&cp->lock);
+}
 
-// parses HTML for URLs and queues them
-int parse_html_urls(queue_t *qp_, webpage_t *wp_) {
-	if (wp_ == NULL) return 1;
-	if (qp_ == NULL) return 2;
+// parses HTML for URLs and queues the ones not seen before
+int parse_html_urls(crawl_t *cp, webpage_t *wp) {
+	if (wp == NULL) return 1;
+	if (cp == NULL) return 2;
 	
-	webpage_t *wp = wp_;	
-	int depth = webpage_getDepth(wp);
-
-	char *url;
-	int pos = 1; 
-
-	while (( pos = webpage_getNextURL(wp_, pos, &url)) >= 0) {
-		wp = webpage_new(url, depth+1, NULL);
- 
-		if (wp == NULL) continue;
-		
-		if (IsInternalURL(url)){
-			logr("Found Internal", webpage_getDepth(wp), url);
-			qput(qp_, wp);
+	int depth = webpage_getDepth(wp) + 1;
+
+	webpage_token_t token;
+	for (int pos = 0; (pos = webpage_nextToken(wp, pos, &token)) > 0; ) {
+		if (token.kind != WEBPAGE_HREF) continue;
+
+		char *url = webpage_resolveHREF(wp, &token);
+		if (url == NULL) continue;
+
+		// IsInternalURL normalizes url, so repeats are caught however written
+		if (!IsInternalURL(url)) {
+			logr("Ignore External", depth, url);
+		} else if (frontier_put(cp, url, depth)) {
+			logr("Found Internal", depth, url);
 		} else {
-			logr("Ignore External", webpage_getDepth(wp), url);
-			webpage_delete(wp); 
+			logr("Ignore repeat", depth, url);
 		}
 
 		free(url); 
@@ -72,64 +157,363 @@ int parse_html_urls(queue_t *qp_, webpage_t *wp_) {
 	return 0; 
 }
 
-int crawl_from_seed(char *seed_url_, int max_depth_, queue_t *qp_, hashtable_t *htp_) {
-	webpage_t *base_wp = webpage_new(seed_url_, 0, NULL);
-  if (base_wp == NULL) {
-    printf("Unable to create base webpage\n");
-    return 1; 
-  }
+// makes the fetch of wp conditional on the copy the old crawl saved
+static void recrawl_prepare(crawl_t *cp, webpage_t *wp) {
+	if (cp->old == NULL) return;
 
-  // Fetch HTML
-  if (!webpage_fetch(base_wp)) {
-    printf("Unable to fetch initial webpage\n");
-    qput(qp_, base_wp); 
-    return 2; 
-  }
+	const char *etag, *last_modified;
+	if (validators_find(cp->old->validators, webpage_getURL(wp), &etag, &last_modified) > 0) {
+		webpage_setValidators(wp, etag, last_modified);
+	}
+}
+
+/*
+ * recrawl_reuse -- after a successful fetch of wp, fills it with the
+ * html the old crawl saved if the server reported it unchanged
+ * returns false if that copy could not be loaded
+ */
+static bool recrawl_reuse(crawl_t *cp, webpage_t *wp) {
+	if (!webpage_notModified(wp)) return true;
+
+	const char *etag, *last_modified;
+	int id = cp->old ? validators_find(cp->old->validators, webpage_getURL(wp), &etag, &last_modified) : 0;
+	webpage_t *saved = NULL;
+	if (id > 0) {
+		saved = cp->old->store ? pagestore_load(cp->old->store, id) : pageload(id, cp->old->pagedir);
+	}
+	if (saved == NULL) {
+		printf("Unable to load unchanged %s from the old crawl\n", webpage_getURL(wp));
+		return false;
+	}
+
+	char *html = malloc(webpage_getHTMLlen(saved) + 1);
+	if (html == NULL) {
+		webpage_delete(saved);
+		return false;
+	}
+	memcpy(html, webpage_getHTML(saved), webpage_getHTMLlen(saved) + 1);
+	webpage_setHTML(wp, html);
+	webpage_delete(saved);
+
+	logr("Unchanged", webpage_getDepth(wp), webpage_getURL(wp));
+	pthread_mutex_lock(&cp->lock);
+	cp->unchanged++;
+	pthread_mutex_unlock(&cp->lock);
+	return true;
+}
+
+/*
+ * fetch_page -- fetches wp, conditionally when recrawling; a page the
+ * old crawl lost its copy of is fetched again in full
+ * returns true on success
+ */
+static bool fetch_page(crawl_t *cp, webpage_t *wp) {
+	recrawl_prepare(cp, wp);
+	if (!webpage_fetch(wp)) return false;
+	if (recrawl_reuse(cp, wp)) return true;
+
+	webpage_setValidators(wp, NULL, NULL);
+	return webpage_fetch(wp);
+}
+
+// skips a page taken from the frontier without fetching it
+static void reject_page(crawl_t *cp, webpage_t *wp) {
+	frontier_done(cp, wp, false);
+	webpage_delete(wp);
+}
 
-	queue_t *base_webpage_qp = qopen();
-	qput(base_webpage_qp, base_wp);
+/*
+ * finish_page -- parses a fetched page for links and hands it to the
+ * writer, unless its text is a near-duplicate of a page already saved
+ */
+static void finish_page(crawl_t *cp, webpage_t *wp) {
+	logr("Fetched", webpage_getDepth(wp), webpage_getURL(wp)); 
+
+	// parse html for urls that will be a depth lower
+	if (webpage_getDepth(wp) != cp->max_depth && parse_html_urls(cp, wp) > 0) {
+		printf("Failed to parse HTML for %s, skipping it\n", webpage_getURL(wp));
+	}
 
-	int index = 0; 
-	for(webpage_t *wp = (webpage_t *) qget(base_webpage_qp); wp != NULL; wp = (webpage_t *) qget(base_webpage_qp)) {
-		char *url = webpage_getURL(wp);
-		if (!NormalizeURL(url)) {
-			logr("Failed to normalize url", webpage_getDepth(wp), webpage_getURL(wp));
-			continue; 
+	// pages without text are never taken for duplicates
+	uint64_t fp = cp->near != NULL ? simhash(wp) : 0;
+
+	pthread_mutex_lock(&cp->lock);
+	int original = fp != 0 ? simindex_find(cp->near, fp) : 0;
+	int id = 0;
+	if (original > 0) {
+		cp->duplicates++;
+	} else {
+		id = ++cp->count;
+		if (fp != 0 && simindex_add(cp->near, fp, id) != 0) {
+			printf("Failed to keep the SimHash of %s\n", webpage_getURL(wp));
 		}
-		if (hsearch(htp_, searchfn, url, strlen(url)) != NULL) {
-			logr("Ignore repeat", webpage_getDepth(wp), webpage_getURL(wp));
-			continue; 
-		}; 
+		if (cp->ckpt_path != NULL && cp->count - cp->ckpt_count >= cp->ckpt_interval) {
+			cp->ckpt_due = true;
+		}
+	}
+	pthread_mutex_unlock(&cp->lock);
 
-		// fetch html
-		if (index != 0 && !webpage_fetch(wp)) {
-			printf("Unable to fetch webpage for %s, skipping it\n", webpage_getURL(wp));
-			webpage_delete(wp);
- 			continue; 
+	if (original > 0) {
+		printf("%2d %*s%25s: %s (near page %d)\n", webpage_getDepth(wp), 2 * webpage_getDepth(wp), "",
+					 "Duplicate", webpage_getURL(wp), original);
+		webpage_delete(wp);
+		return;
+	}
+
+	// may wait for the writer to catch up; must not hold the lock
+	pagewriter_put(cp->writer, wp, id);
+}
+
+// fetches and parses one page taken from the frontier
+static void crawl_page(crawl_t *cp, webpage_t *wp) {
+	// fetch html; the seed arrives already fetched
+	bool ok = webpage_getHTML(wp) != NULL || fetch_page(cp, wp);
+	frontier_done(cp, wp, true);
+
+	if (!ok) {
+		printf("Unable to fetch webpage for %s, skipping it\n", webpage_getURL(wp));
+		webpage_delete(wp);
+		return; 
+	}
+
+	finish_page(cp, wp);
+}
+
+// waits on cond for at most wait_ms; lock must be held
+static void timed_wait(crawl_t *cp, long wait_ms) {
+	struct timespec ts;
+	clock_gettime(CLOCK_REALTIME, &ts);
+	ts.tv_sec += wait_ms / 1000;
+	ts.tv_nsec += (wait_ms % 1000) * 1000000L;
+	if (ts.tv_nsec >= 1000000000L) {
+		ts.tv_sec++;
+		ts.tv_nsec -= 1000000000L;
+	}
+	pthread_cond_timedwait(&cp->cond, &cp->lock, &ts);
+}
+
+/*
+ * take_checkpoint -- saves the frontier, the seen-set and the next id.
+ * Called with lock held while no page is out of the frontier, so every
+ * url is either saved, queued, or was skipped; pages still waiting in
+ * the writer are flushed first so ids below the next one are on disk.
+ */
+static void take_checkpoint(crawl_t *cp) {
+	pagewriter_flush(cp->writer);
+	if (checkpoint_save(cp->ckpt_path, cp->frontier, cp->seen, cp->near, cp->count + 1) == 0) {
+		printf("Checkpoint: %d pages saved, %d queued\n", cp->count, schedsize(cp->frontier));
+	}
+	cp->ckpt_count = cp->count;
+	cp->ckpt_due = false;
+}
+
+// blocks until a host is ready; returns NULL once the crawl is over
+static webpage_t *next_page(crawl_t *cp) {
+	webpage_t *wp = NULL;
+	long wait_ms;
+
+	pthread_mutex_lock(&cp->lock);
+	while (true) {
+		if (cp->ckpt_due) {
+			// the last worker to finish its page takes the checkpoint
+			if (cp->busy == 0) {
+				take_checkpoint(cp);
+				pthread_cond_broadcast(&cp->cond);
+			} else {
+				pthread_cond_wait(&cp->cond, &cp->lock);
+			}
+			continue;
+		}
+
+		if ((wp = schedget(cp->frontier, &wait_ms)) != NULL) {
+			break;
+		} else if (wait_ms >= 0) {
+			timed_wait(cp, wait_ms);     // every ready host is cooling down
+		} else if (cp->busy > 0) {
+			pthread_cond_wait(&cp->cond, &cp->lock);
+		} else {
+			break;
+		}
+	}
+
+	if (wp != NULL) {
+		cp->busy++;
+	} else {
+		pthread_cond_broadcast(&cp->cond); // wake the other idle workers
+	}
+	pthread_mutex_unlock(&cp->lock);
+
+	return wp;
+}
+
+static void *crawl_worker(void *arg) {
+	crawl_t *cp = (crawl_t *) arg;
+
+	for (webpage_t *wp = next_page(cp); wp != NULL; wp = next_page(cp)) {
+		crawl_page(cp, wp);
+
+		pthread_mutex_lock(&cp->lock);
+		cp->busy--;
+		pthread_cond_broadcast(&cp->cond);
+		pthread_mutex_unlock(&cp->lock);
+	}
+
+	return NULL;
+}
+
+// fetcher callback for the async engine
+static void fetched_page(webpage_t *wp, bool ok, void *arg) {
+	crawl_t *cp = (crawl_t *) arg;
+
+	if (ok && !recrawl_reuse(cp, wp)) {
+		// the old copy is gone; fetch the page again in full
+		webpage_setValidators(wp, NULL, NULL);
+		if (fetcher_add(cp->fetcher, wp) == 0) return;
+		ok = false;
+	}
+	frontier_done(cp, wp, true);
+
+	if (!ok) {
+		printf("Unable to fetch webpage for %s, skipping it\n", webpage_getURL(wp));
+		webpage_delete(wp);
+		return;
+	}
+
+	finish_page(cp, wp);
+}
+
+/*
+ * crawl_async -- crawls on the calling thread, keeping up to nconns
+ * fetches in flight through a fetcher. The crawl is over once the
+ * frontier is empty and nothing is in flight.
+ */
+static void crawl_async(crawl_t *cp, int nconns) {
+	fetcher_t *fp = fetcher_open(nconns, FETCH_TIMEOUT_MS, fetched_page, cp);
+	if (fp == NULL) {
+		printf("Failed to create fetcher\n");
+		cp->stopped = true;
+		return;
+	}
+	cp->fetcher = fp;
+
+	while (true) {
+		if (cp->ckpt_due && fetcher_inflight(fp) == 0) {
+			pthread_mutex_lock(&cp->lock);
+			take_checkpoint(cp);
+			pthread_mutex_unlock(&cp->lock);
 		}
 
-		logr("Fetched", webpage_getDepth(wp), webpage_getURL(wp)); 
+		webpage_t *wp;
+		long wait_ms = -1;
+		while (!cp->ckpt_due && fetcher_inflight(fp) < nconns &&
+					 (wp = schedget(cp->frontier, &wait_ms)) != NULL) {
+			if (webpage_getHTML(wp) != NULL) { // the seed arrives already fetched
+				frontier_done(cp, wp, true);
+				finish_page(cp, wp);
+			} else {
+				recrawl_prepare(cp, wp);
+				if (fetcher_add(fp, wp) != 0) {
+					printf("Unable to start fetch for %s, skipping it\n", webpage_getURL(wp));
+					reject_page(cp, wp);
+				}
+			}
+		}
 
-		// parse html for urls that will be a depth lower
-		if (webpage_getDepth(wp) != max_depth_ && parse_html_urls(base_webpage_qp, wp) > 0) {
-			printf("Failed to parse HTML for %s, skipping it\n", webpage_getURL(wp));
-			qput(qp_, wp);
-			hput(htp_, wp, url, strlen(url)); 			
-			++index; 
- 			continue; 
+		if (fetcher_inflight(fp) == 0) {
+			if (cp->ckpt_due) continue;  // taken at the top of the loop
+			if (wait_ms < 0) break;      // no host holding pages either
 		}
 
-		qput(qp_, wp);
-		hput(htp_, wp, url, strlen(url)); 		
-		++index; 
+		// also sleeps while every ready host is cooling down
+		if (fetcher_perform(fp, wait_ms >= 0 && wait_ms < FETCH_WAIT_MS ? wait_ms : FETCH_WAIT_MS) < 0) {
+			printf("Fetcher failed, stopping crawl\n");
+			cp->stopped = true;
+			break;
+		}
+	}
+
+	fetcher_close(fp);
+	cp->fetcher = NULL;
+}
+
+/*
+ * crawl_from_seed -- crawls from seed_url_, or, if ckpt_ is given and
+ * resume_ is set, from the state saved in checkpoint ckpt_. A checkpoint
+ * is written to ckpt_ every ckpt_interval_ pages. If old_ is given, pages
+ * it holds are fetched conditionally and reused when unchanged. If near_
+ * is given, pages near one already in it are not saved.
+ * returns the number of pages saved, counting those of earlier runs;
+ * -1 if the crawl could not start or stopped before it was done
+ */
+int crawl_from_seed(char *seed_url_, int max_depth_, int nthreads_, int nconns_, sched_t *sp_, pagewriter_t *pwp_, urlset_t *usp_,
+										char *ckpt_, int ckpt_interval_, bool resume_, recrawl_t *old_, simindex_t *near_) {
+	crawl_t crawl = { .frontier = sp_, .seen = usp_, .near = near_, .writer = pwp_, .old = old_, .max_depth = max_depth_,
+										.ckpt_path = ckpt_interval_ > 0 ? ckpt_ : NULL, .ckpt_interval = ckpt_interval_ };
+	pthread_mutex_init(&crawl.lock, NULL);
+	pthread_cond_init(&crawl.cond, NULL);
+
+	if (resume_) {
+		int next_id;
+		if (checkpoint_load(ckpt_, sp_, usp_, near_, &next_id) != 0) {
+			printf("Unable to resume from checkpoint %s\n", ckpt_);
+			return -1;
+		}
+		crawl.count = crawl.ckpt_count = next_id - 1;
+		printf("Resuming: %d pages saved, %d queued\n", crawl.count, schedsize(sp_));
+	} else {
+		webpage_t *base_wp = webpage_new(seed_url_, 0, NULL);
+		if (base_wp == NULL) {
+			printf("Unable to create base webpage\n");
+			return -1;
+		}
+
+		// Fetch HTML
+		if (!fetch_page(&crawl, base_wp)) {
+			printf("Unable to fetch initial webpage\n");
+			webpage_delete(base_wp); 
+			return -1;
+		}
+
+		urlset_add(usp_, seed_url_);
+		schedput(sp_, base_wp);
+	}
+
+	pthread_t workers[MAX_THREADS];
+	int started = 0;
+	for (; nconns_ == 0 && started < nthreads_; started++) {
+		if (pthread_create(&workers[started], NULL, crawl_worker, &crawl) != 0) {
+			printf("Failed to start crawler thread %d\n", started);
+			break;
+		}
+	}
+
+	if (nconns_ > 0) {
+		crawl_async(&crawl, nconns_);
+	} else if (started == 0) { // with no thread started, crawl on this one
+		crawl_worker(&crawl);
+	}
+
+	for (int i = 0; i < started; i++) {
+		pthread_join(workers[i], NULL);
 	}
 
-	qclose(base_webpage_qp);
+	if (old_ != NULL) {
+		printf("Reused %d unchanged pages from %s\n", crawl.unchanged, old_->pagedir);
+	}
+	if (near_ != NULL) {
+		printf("Skipped %d near-duplicate pages\n", crawl.duplicates);
+	}
 
-	return index; 
+	pthread_cond_destroy(&crawl.cond);
+	pthread_mutex_destroy(&crawl.lock);
+
+	return crawl.stopped ? -1 : crawl.count;
 }
 
-const char usage[] = "usage: crawler <seedurl> <pagedir> <maxdepth>\n";
+const char usage[] = "usage: crawler <seedurl> <pagedir> <maxdepth> [-t <threads> | -c <connections>]\n"
+	"               [-d <delay ms> | -d <host>=<delay ms>]...\n"
+	"               [-b <bloom bits per url>] [--checkpoint <pages>] [--resume] [--packed]\n"
+	"               [--recrawl <old pagedir>] [-s <max simhash distance>]\n";
 
 void validate_dir(char *pagedir) {
   struct stat path_stat;
@@ -163,7 +547,7 @@ void validate_dir(char *pagedir) {
 }
 
 int main(int argc, char *argv[]) {
-	if (argc != 4) {
+	if (argc < 4) {
 		printf(usage);
 		exit(EXIT_FAILURE); 
 	}
@@ -176,6 +560,13 @@ int main(int argc, char *argv[]) {
 	}
 
 	pagedir = argv[2];
+	// the checkpoint is kept in pagedir, so its name must fit as well
+	char ckpt_path[300];
+	if (snprintf(ckpt_path, sizeof(ckpt_path), "%s/%s", pagedir, CHECKPOINT_FILE) >= (int) sizeof(ckpt_path)) {
+		printf(usage);
+		printf("Error: path name too long: '%s'.\n", pagedir);
+		exit(EXIT_FAILURE);
+	}
 	validate_dir(pagedir); 
 
 
@@ -188,36 +579,168 @@ int main(int argc, char *argv[]) {
 		exit(EXIT_FAILURE); 
 	}
 
-	queue_t *webpage_qp = qopen();
-  if (webpage_qp == NULL) {
-    printf("Failed to create webpage queue\n");
+	sched_t *frontier = schedopen(DEFAULT_DELAY_MS);
+	if (frontier == NULL) {
+		printf("Failed to create frontier\n");
+		exit(EXIT_FAILURE);
+	}
+
+	int nthreads = 1;
+	int nconns = 0;   // 0: fetch with webpage_fetch on worker threads
+	int ckpt_interval = CHECKPOINT_INTERVAL;
+	bool resume = false;
+	bool packed = false;
+	char *old_pagedir = NULL;
+	int near_distance = -1;   // -1: keep near-duplicates
+	int bloom_bits = 0;
+	for (int i = 4; i < argc; i++) {
+		if (strcmp(argv[i], "-t") == 0 && i + 1 < argc) {
+			errno = 0;
+			nthreads = strtol(argv[++i], &endptr, 10);
+			if (*endptr != '\0' || errno != 0 || nthreads < 1 || nthreads > MAX_THREADS) {
+				printf(usage);
+				printf("Invalid <threads> argument, expected 1 to %d\n", MAX_THREADS);
+				exit(EXIT_FAILURE);
+			}
+		} else if (strcmp(argv[i], "-c") == 0 && i + 1 < argc) {
+			errno = 0;
+			nconns = strtol(argv[++i], &endptr, 10);
+			if (*endptr != '\0' || errno != 0 || nconns < 1 || nconns > MAX_CONNS) {
+				printf(usage);
+				printf("Invalid <connections> argument, expected 1 to %d\n", MAX_CONNS);
+				exit(EXIT_FAILURE);
+			}
+		} else if (strcmp(argv[i], "-d") == 0 && i + 1 < argc) {
+			char *host = argv[++i];
+			char *delay = strchr(host, '=');
+			if (delay != NULL) {
+				*delay++ = '\0';
+			} else {
+				delay = host;
+				host = NULL;
+			}
+			errno = 0;
+			long delay_ms = strtol(delay, &endptr, 10);
+			if (endptr == delay || *endptr != '\0' || errno != 0 || scheddelay(frontier, host, delay_ms) != 0) {
+				printf(usage);
+				printf("Invalid <delay ms> argument '%s'\n", delay);
+				exit(EXIT_FAILURE);
+			}
+		} else if (strcmp(argv[i], "--checkpoint") == 0 && i + 1 < argc) {
+			errno = 0;
+			ckpt_interval = strtol(argv[++i], &endptr, 10);
+			if (*endptr != '\0' || errno != 0 || ckpt_interval < 0) {
+				printf(usage);
+				printf("Invalid checkpoint interval, expected pages (0 to disable)\n");
+				exit(EXIT_FAILURE);
+			}
+		} else if (strcmp(argv[i], "-b") == 0 && i + 1 < argc) {
+			errno = 0;
+			bloom_bits = strtol(argv[++i], &endptr, 10);
+			if (*endptr != '\0' || errno != 0 || bloom_bits < 0 || bloom_bits > 64) {
+				printf(usage);
+				printf("Invalid <bloom bits per url> argument, expected 0 to 64\n");
+				exit(EXIT_FAILURE);
+			}
+		} else if (strcmp(argv[i], "-s") == 0 && i + 1 < argc) {
+			errno = 0;
+			near_distance = strtol(argv[++i], &endptr, 10);
+			if (*endptr != '\0' || errno != 0 || near_distance < 0 || near_distance > SIMHASH_MAX_DISTANCE) {
+				printf(usage);
+				printf("Invalid <max simhash distance> argument, expected 0 to %d\n", SIMHASH_MAX_DISTANCE);
+				exit(EXIT_FAILURE);
+			}
+		} else if (strcmp(argv[i], "--resume") == 0) {
+			resume = true;
+		} else if (strcmp(argv[i], "--packed") == 0) {
+			packed = true;
+		} else if (strcmp(argv[i], "--recrawl") == 0 && i + 1 < argc) {
+			old_pagedir = argv[++i];
+		} else {
+			printf(usage);
+			printf("Unknown option '%s'\n", argv[i]);
+			exit(EXIT_FAILURE);
+		}
+	}
+
+	if (nconns > 0 && nthreads > 1) {
+		printf(usage);
+		printf("-t and -c cannot be combined\n");
+		exit(EXIT_FAILURE);
+	}
+
+	// a resumed crawl keeps saving pages the way it started
+	if (resume && pagestore_exists(pagedir)) packed = true;
+
+	pagewriter_t *writer = pagewriter_open(pagedir, WRITER_QUEUE_LENGTH, packed);
+  if (writer == NULL) {
+    printf("Failed to start page writer\n");
     exit(EXIT_FAILURE);
   }
 
-  hashtable_t *webpage_htp = hopen(HASH_LENGTH);
-  if (webpage_htp == NULL) {
-    printf("Failed to create webpage hash table \n");
+  urlset_t *seen = urlset_open(bloom_bits);
+  if (seen == NULL) {
+    printf("Failed to create url set\n");
     exit(EXIT_FAILURE);
   }
-	
-	int count = crawl_from_seed(seedurl, max_depth, webpage_qp, webpage_htp);
-	printf("Crawled %d URLs\n", count);
 
-	//qapply(webpage_qp, pagesave);
-	webpage_t *page;
-	int id = 1;
-	while (( page = qget(webpage_qp)) != NULL){
-		if (pagesave(page, id++, pagedir) != 0){
-			printf("Failed to save webpage\n");
+	simindex_t *near = NULL;
+	if (near_distance >= 0 && (near = simindex_open(near_distance)) == NULL) {
+		printf("Failed to create SimHash index\n");
+		exit(EXIT_FAILURE);
+	}
+
+	recrawl_t old = { .pagedir = old_pagedir };
+	if (old_pagedir != NULL) {
+		struct stat old_stat, new_stat;
+		if (stat(old_pagedir, &old_stat) != 0 || !S_ISDIR(old_stat.st_mode)) {
+			printf(usage);
+			printf("Error: old page directory '%s' does not exist\n", old_pagedir);
+			exit(EXIT_FAILURE);
+		}
+		// the new crawl would overwrite the pages it means to reuse
+		if (stat(pagedir, &new_stat) == 0 && old_stat.st_dev == new_stat.st_dev && old_stat.st_ino == new_stat.st_ino) {
+			printf(usage);
+			printf("Error: recrawl into a different page directory than '%s'\n", old_pagedir);
+			exit(EXIT_FAILURE);
+		}
+
+		old.validators = validators_load(old_pagedir);
+		if (old.validators == NULL ||
+				(pagestore_exists(old_pagedir) && (old.store = pagestore_open(old_pagedir, false)) == NULL)) {
+			printf("Failed to open old crawl in %s\n", old_pagedir);
+			exit(EXIT_FAILURE);
 		}
-		webpage_delete(page);
+		printf("Recrawling %d pages with validators from %s\n", validators_size(old.validators), old_pagedir);
+	}
+
+	// libcurl global state is not thread-safe; set it up once for all workers
+	curl_global_init(CURL_GLOBAL_ALL);
+	
+	int count = crawl_from_seed(seedurl, max_depth, nthreads, nconns, frontier, writer, seen,
+															ckpt_path, ckpt_interval, resume, old_pagedir ? &old : NULL, near);
+	if (count >= 0) printf("Crawled %d URLs\n", count);
+
+	curl_global_cleanup();
+
+	// pages are saved as they are crawled; wait for the last ones
+	int failed = pagewriter_close(writer);
+	if (failed > 0) {
+		printf("Failed to save %d webpages\n", failed);
+	}
+
+	// a finished crawl has nothing left to resume; an unfinished one keeps its checkpoint
+	if (count >= 0 && schedsize(frontier) == 0) {
+		unlink(ckpt_path);
 	}
 	
-	printf("Crawler Complete!\n");
+	printf(count >= 0 ? "Crawler Complete!\n" : "Crawl did not finish\n");
 	// Cleanup
-	//	qapply(webpage_qp, webpage_delete); 
-	qclose(webpage_qp);
-	hclose(webpage_htp);
+	schedclose(frontier);
+	urlset_close(seen);
+	validators_close(old.validators);
+	simindex_close(near);
+	pagestore_close(old.store);
 	
-	exit(EXIT_SUCCESS);
+	exit(count >= 0 ? EXIT_SUCCESS : EXIT_FAILURE);
 }
@@ -15,6 +15,8 @@
 #include <string.h>
 #include <stdbool.h>
 #include <errno.h>
+#include <pthread.h>
+#include <time.h>
 #include <dirent.h>
 #include <sys/stat.h>
 #include <sys/types.h>
@@ -23,78 +25,53 @@
 #include "hash.h"
 #include "queue.h"
 #include "indexio.h"
+#include "pagestore.h"
+#include "termdict.h"
+#include "indexmerge.h"
+#include "segments.h"
+#include "docstore.h"
+#include "posindex.h"
+
+#define MAX_THREADS 64
+#define TERMDICT_SIZE 4096
+
+/*
+ * NormalizeWord -- lowercases the len letters at word into normalized
+ * (len + 1 bytes); returns false for words too short to index
+ */
+bool NormalizeWord(const char *word, int len, char *normalized){
+	if (len < 3) return false; // discard short words
 
-// converts a word to lowercase
-char *NormalizeWord(const char *word){
-	if (word == NULL) return NULL;
-	int len = strlen(word);
-	int i;
-	char c;
-
-	if (len < 3) return NULL; // discard short words
-	
-	char *normalized = malloc((len + 1) * sizeof(char));
-	if (!normalized) return NULL;
-	
-	for (i=0; i<len; i++){
-		c = word[i];
-
-		if ( c >= 'A' && c <= 'Z'){
-			normalized[i] = c + 32;
-		}
-		else if (c >= 'a' && c <= 'z'){
-			normalized[i] = c;
-		}
-		else {
-			free(normalized); // discard non letters
-			return NULL;
-		}
+	for (int i = 0; i < len; i++){
+		char c = word[i];
+		normalized[i] = (c >= 'A' && c <= 'Z') ? c + 32 : c;
 	}
 	normalized[len] = '\0';
-	return normalized;
-}
-
-bool document_searchfn(void *ep_, const void *keyp_) {
-	document_t *ep = (document_t *) ep_;
-	uint64_t *keyp = (uint64_t *) keyp_; 
-	return ep->id == *keyp; 
-}
-
-void cleanup_docs(void *ep_) {
-	free(ep_); 
+	return true;
 }
 
 bool searchfn(void *ep_, const void *searchkeyp_) {
 	word_index_t *ep = (word_index_t *) ep_;
 	char *key = (char *) searchkeyp_;
-	return strncmp(ep->word, key, strlen(key)) == 0;
-}
-
-static uint64_t total_count_per_word = 0;
-void aggregate_count_per_word(void *ep_) {
-	document_t *ep = (document_t *) ep_;
-	total_count_per_word += ep->count; 
+	return strcmp(ep->word, key) == 0;
 }
 
 static uint64_t total_count = 0; 
 void aggregate_count(void *ep_) {
 	word_index_t *ep = (word_index_t *) ep_;
-	queue_t *qp = ep->docs;
-	total_count_per_word = 0; 
-	qapply(qp, aggregate_count_per_word); 
-	total_count += total_count_per_word; 
+	for (uint32_t i = 0; i < ep->ndocs; i++) {
+		total_count += ep->docs[i].count;
+	}
 }
 
+// records and their words live in the indexing workers' dictionaries
 void cleanup_indices(void *ep_) {
 	word_index_t *ep = (word_index_t *) ep_;
-
-	qapply(ep->docs, cleanup_docs); 
-	qclose(ep->docs);
-	free(ep->word); 
-	free(ep); 
+	free(ep->docs);
+	free(ep->positions);
 }
 
-static char *usage = "usage: indexer <pagedir> <indexnm>\n"; 
+static char *usage = "usage: indexer <pagedir> <indexnm> [-j <threads>] [--mem-limit <megabytes>] [--update] [-p]\n"; 
 
 void validate_dir(char *pagedir) {
   struct stat path_stat;
@@ -128,19 +105,108 @@ void validate_dir(char *pagedir) {
 
 static uint64_t INDEXER_HASH_TABLE_SIZE = 100;
 
-int main(int argc, char *argv[]){
-	if (argc != 3){
-		printf("%s", usage);
-		exit(EXIT_FAILURE);
+/*
+ * index_page -- adds the words of page page_id to the dictionary of
+ * records terms, and counts them into *nwords. Each word is normalized
+ * into the dictionary's scratch buffer and looked up in place; only a
+ * new word is copied, together with its record, into the dictionary's
+ * arena. If positional, a word's position, its ordinal among the words
+ * indexed on the page, is recorded too. Returns the bytes by which the
+ * postings arrays grew.
+ */
+size_t index_page(termdict_t *terms, webpage_t *page, uint64_t page_id, bool positional, uint32_t *nwords) {
+  size_t grown = 0;
+  *nwords = 0;
+  const char *html = webpage_getHTML(page);
+  word_index_t *record = NULL;
+  webpage_token_t token;
+
+  for (int pos = 0; (pos = webpage_nextToken(page, pos, &token)) > 0; ){
+    if (token.kind != WEBPAGE_WORD) continue;
+
+    char *normalized = termdict_scratch(terms, token.length);
+    if (normalized == NULL) {
+      printf("Error: failed malloc call\n");
+      exit(EXIT_FAILURE);
+    }
+    if (!NormalizeWord(html + token.offset, token.length, normalized)) {
+      continue;
+    }
+
+    if ((record = termdict_find(terms, normalized, token.length)) == NULL) {
+      record = termdict_alloc(terms, sizeof(word_index_t));
+      if (record == NULL) {
+        printf("Error: failed malloc call\n");
+        exit(EXIT_FAILURE);
+      }
+      *record = (word_index_t) { .docs = NULL, .ndocs = 0, .capacity = 0 };
+      record->word = (char *) termdict_add(terms, normalized, token.length, record);
+      if (record->word == NULL) {
+        printf("Error: failed malloc call\n");
+        exit(EXIT_FAILURE);
+      }
+    }
+
+    uint32_t capacity = record->capacity;
+    if (!postings_add(record, page_id) || (positional && !positions_add(record, *nwords))) {
+      printf("Error: failed malloc call\n");
+      exit(EXIT_FAILURE);
+    }
+    (*nwords)++;
+    grown += (record->capacity - capacity) * sizeof(document_t);
+  }
+  return grown;
+}
+
+// page_row_t -- what the docstore keeps of an indexed page; its url follows it in the rows file
+typedef struct page_row {
+	uint64_t id;
+	uint32_t depth;
+	uint32_t length;
+	uint32_t terms;         // words indexed
+	uint32_t url_len;
+} page_row_t;
+
+/*
+ * corpus_t -- the pages to index: their ids in ascending order, and
+ * where to load them from. Loading is safe from several threads. Each
+ * worker writes a row for every page it indexes to a file of its own,
+ * rows[w], so the urls wait on disk, not in memory, for the docstore;
+ * a page that could not be loaded has no row.
+ */
+typedef struct corpus {
+	char *pagedir;
+	pagestore_t *store;     // NULL when the pages are files
+	uint64_t mark;          // the lowest stamp of a page saved after collection
+	uint64_t *ids;
+	FILE *rows[MAX_THREADS]; // in id order
+	int nrows;
+	int nids;
+	int capacity;
+	bool positional;        // record where each word occurs on its pages
+} corpus_t;
+
+static void add_id(corpus_t *cp, uint64_t page_id) {
+	if (cp->nids == cp->capacity) {
+		cp->capacity = cp->capacity ? 2 * cp->capacity : 1024;
+		cp->ids = realloc(cp->ids, cp->capacity * sizeof(uint64_t));
+		if (cp->ids == NULL) {
+			printf("Error: failed malloc call\n");
+			exit(EXIT_FAILURE);
+		}
 	}
-	char *pagedir = argv[1];
-	validate_dir(pagedir);
+	cp->ids[cp->nids++] = page_id;
+}
 
-	// create output file (validate indexnm)
-	// find what index we need to go to
-	char *indexnm = argv[2];
+static int compare_ids(const void *a, const void *b) {
+	uint64_t x = *(const uint64_t *) a, y = *(const uint64_t *) b;
+	return x < y ? -1 : x > y;
+}
 
-	DIR *d = opendir(pagedir);
+// finds the ids of the numbered page files in pagedir
+void collect_files(corpus_t *cp) {
+	cp->mark = time(NULL);
+	DIR *d = opendir(cp->pagedir);
 	if (d == NULL) {
 		printf("Error: could not open page directory\n");
 		exit(EXIT_FAILURE); 
@@ -152,17 +218,10 @@ int main(int argc, char *argv[]){
   char *endptr;
   uint64_t page_id;
 
-  hashtable_t *htp = hopen(INDEXER_HASH_TABLE_SIZE);
-  if (htp == NULL) {
-    printf("Error: could not create hash table\n");
-    exit(EXIT_FAILURE);
-  }
-
-	webpage_t *page; 
   while ((dir = readdir(d)) != NULL) {
     struct stat stbuf;
     filename = dir->d_name;
-    sprintf(filepath, "%s/%s", pagedir,dir->d_name);
+    sprintf(filepath, "%s/%s", cp->pagedir, dir->d_name);
     if (stat(filepath, &stbuf) == -1) {
       printf("Unable to stat file: %s\n",filepath);
       continue;
@@ -180,66 +239,601 @@ int main(int argc, char *argv[]){
       continue;
     }
 
-    printf("Received proper page id: %ld\n", page_id);
+    add_id(cp, page_id);
+  }
 
-    char *word = NULL;
-    char *normalized = NULL;
-		
-		page = pageload(page_id, pagedir);
-    if (page == NULL){
-      printf("Error: could not load page %ld from directory %s\n", page_id, pagedir);
-      continue;
-    }
+	closedir(d); 
+}
 
-		word_index_t *record = NULL;
-    document_t *doc_record = NULL;
-    for (int pos = 0; (pos = webpage_getNextWord(page, pos, &word)) > 0; free(word)){
-      normalized = NormalizeWord(word);
-      if (normalized == NULL) {
-        continue;
-      }
+// finds the ids of the pages in the page store of pagedir
+void collect_store(corpus_t *cp) {
+  cp->store = pagestore_open(cp->pagedir, false);
+  if (cp->store == NULL) {
+    printf("Error: could not open page store in %s\n", cp->pagedir);
+    exit(EXIT_FAILURE);
+  }
+  cp->mark = pagestore_end(cp->store);
 
-      if ((record = hsearch(htp, searchfn, normalized, strlen(normalized))) == NULL) {
-        record = malloc(sizeof(word_index_t));
-        if (record == NULL) {
-          printf("Error: failed malloc call\n");
-          exit(EXIT_FAILURE);
-        }
+  for (int page_id = 1; page_id <= pagestore_maxid(cp->store); page_id++) {
+    char *url = pagestore_url(cp->store, page_id);
+    if (url == NULL) continue;
+    free(url);
+    add_id(cp, page_id);
+  }
+}
 
-        record->word = normalized;
-        record->docs = qopen();
+/*
+ * worker_t -- an indexing thread. It indexes the pages ids[first] up
+ * to ids[last - 1] into a private dictionary, then deals the records
+ * out into one queue per partition of the term space. In the merge
+ * phase, worker m merges partition m of every worker into merged. The
+ * records stay in the dictionary that made them until the index is
+ * saved.
+ *
+ * With a memory budget, a worker instead writes its dictionary out as
+ * a sorted run, a binary index of its own, whenever the dictionary and
+ * its postings outgrow the budget, and once more at the end; the runs
+ * of all workers are then merged into the index.
+ */
+typedef struct worker {
+	corpus_t *corpus;
+	int first, last;
+	termdict_t *terms;
+	FILE *rows;             // the docstore rows of its pages
+	size_t postings_bytes;  // held by the postings of terms
+	size_t budget;          // 0 for no budget
+	char *indexnm;
+	char **runs;            // the run files written, in id order
+	int nruns;
+	int nparts;
+	queue_t **parts;
+	struct worker *workers; // all of them, in id order
+	int nworkers;
+	int part;               // the partition this worker merges
+	hashtable_t *merged;
+} worker_t;
+
+// the partition of the term space word falls in (FNV-1a)
+static int word_part(const char *word, int nparts) {
+	uint32_t h = 2166136261u;
+	for (const unsigned char *p = (const unsigned char *) word; *p; p++) {
+		h ^= *p;
+		h *= 16777619u;
+	}
+	return h % nparts;
+}
 
-        hput(htp, record, normalized, strlen(normalized));
-      } else {
-        free(normalized);
-      }
+static _Thread_local worker_t *current_worker;
+static void deal_record(void *ep) {
+	word_index_t *record = (word_index_t *) ep;
+	qput(current_worker->parts[word_part(record->word, current_worker->nparts)], record);
+}
 
-      if ((doc_record = qsearch(record->docs, document_searchfn, &page_id)) == NULL){
-        doc_record = malloc(sizeof(document_t));
-        if (doc_record == NULL) {
-          printf("Error: failed malloc call\n");
-          exit(EXIT_FAILURE);
-        }
+// the records of a dictionary, to sort by word
+static _Thread_local word_index_t **run_records;
+static _Thread_local uint32_t run_nrecords;
+static void collect_record(void *ep) {
+	run_records[run_nrecords++] = (word_index_t *) ep;
+}
 
-        doc_record->id = page_id;
-        doc_record->count = 0;
+static int compare_records(const void *a, const void *b) {
+	return strcmp((*(word_index_t * const *) a)->word, (*(word_index_t * const *) b)->word);
+}
 
-        qput(record->docs, doc_record);
-      }
+/*
+ * save_run -- writes the worker's dictionary to its next run file in
+ * term order, and starts a new dictionary
+ */
+static void save_run(worker_t *wp) {
+	char *runnm = malloc(strlen(wp->indexnm) + 32);
+	char **runs = realloc(wp->runs, (wp->nruns + 1) * sizeof(char *));
+	run_records = malloc((termdict_size(wp->terms) + 1) * sizeof(word_index_t *));
+	if (runnm == NULL || runs == NULL || run_records == NULL) {
+		printf("Error: failed malloc call\n");
+		exit(EXIT_FAILURE);
+	}
+	wp->runs = runs;
+	sprintf(runnm, "%s.run%d.%d", wp->indexnm, wp->part, wp->nruns);
+	wp->runs[wp->nruns++] = runnm;
 
-      doc_record->count += 1;
+	run_nrecords = 0;
+	termdict_apply(wp->terms, collect_record);
+	qsort(run_records, run_nrecords, sizeof(word_index_t *), compare_records);
+
+	indexwriter_t *iwp = indexwriter_open(runnm);
+	if (iwp == NULL) {
+		printf("Error: could not create run file %s\n", runnm);
+		exit(EXIT_FAILURE);
+	}
+	for (uint32_t i = 0; i < run_nrecords; i++) {
+		if (indexwriter_add(iwp, run_records[i]->word, run_records[i]->docs, run_records[i]->ndocs) != 0) break;
+		free(run_records[i]->docs);
+		run_records[i]->docs = NULL;
+	}
+	if (indexwriter_close(iwp) != 0) {
+		printf("Error: could not write run file %s\n", runnm);
+		exit(EXIT_FAILURE);
+	}
+	printf("Wrote run %s of %u terms\n", runnm, run_nrecords);
+	free(run_records);
+	run_records = NULL;
+
+	termdict_close(wp->terms);
+	wp->postings_bytes = 0;
+	if ((wp->terms = termdict_open(TERMDICT_SIZE)) == NULL) {
+		printf("Error: could not create term dictionary\n");
+		exit(EXIT_FAILURE);
+	}
+}
+
+static void *index_worker(void *arg) {
+	worker_t *wp = (worker_t *) arg;
+	corpus_t *cp = wp->corpus;
+
+	for (int i = wp->first; i < wp->last; i++) {
+		uint64_t page_id = cp->ids[i];
+		printf("Received proper page id: %lu\n", page_id);
+
+		webpage_t *page = cp->store ? pagestore_load(cp->store, page_id) : pageload(page_id, cp->pagedir);
+		if (page == NULL){
+			printf("Error: could not load page %lu from directory %s\n", page_id, cp->pagedir);
+			continue;
 		}
 
+		char *url = webpage_getURL(page);
+		page_row_t row = { .id = page_id, .depth = webpage_getDepth(page), .length = webpage_getHTMLlen(page),
+											 .url_len = strlen(url) };
+		wp->postings_bytes += index_page(wp->terms, page, page_id, cp->positional, &row.terms);
+		if (fwrite(&row, sizeof(row), 1, wp->rows) != 1 || fwrite(url, 1, row.url_len, wp->rows) != row.url_len) {
+			printf("Error: could not write the docstore rows of %s\n", wp->indexnm);
+			exit(EXIT_FAILURE);
+		}
 		webpage_delete(page);
-  }
 
-	closedir(d); 
+		if (wp->budget > 0 && termdict_memory(wp->terms) + wp->postings_bytes > wp->budget) {
+			save_run(wp);
+		}
+	}
+
+	if (wp->budget > 0) {
+		if (termdict_size(wp->terms) > 0) save_run(wp);
+		return NULL;
+	}
+	current_worker = wp;
+	termdict_apply(wp->terms, deal_record);
+	return NULL;
+}
+
+/*
+ * merge_worker -- merges partition part of every worker. Workers index
+ * ascending id ranges in order, so appending their postings for a word
+ * in worker order keeps each posting list sorted by id.
+ */
+static void *merge_worker(void *arg) {
+	worker_t *wp = (worker_t *) arg;
+
+	for (int w = 0; w < wp->nworkers; w++) {
+		queue_t *part = wp->workers[w].parts[wp->part];
+		word_index_t *record;
+		while ((record = qget(part)) != NULL) {
+			word_index_t *found = hsearch(wp->merged, searchfn, record->word, strlen(record->word));
+			if (found == NULL) {
+				hput(wp->merged, record, record->word, strlen(record->word));
+			} else {
+				if (!postings_concat(found, record)) {
+					printf("Error: failed malloc call\n");
+					exit(EXIT_FAILURE);
+				}
+				free(record->docs);
+				record->docs = NULL;
+				free(record->positions);
+				record->positions = NULL;
+			}
+		}
+		qclose(part);
+	}
+	return NULL;
+}
+
+// runs fn on every worker, each on a thread of its own
+static void run_workers(worker_t *workers, int nworkers, void *(*fn)(void *)) {
+	pthread_t threads[MAX_THREADS];
+	for (int w = 0; w < nworkers; w++) {
+		if (pthread_create(&threads[w], NULL, fn, &workers[w]) != 0) {
+			printf("Error: could not start indexer thread %d\n", w);
+			exit(EXIT_FAILURE);
+		}
+	}
+	for (int w = 0; w < nworkers; w++) {
+		pthread_join(threads[w], NULL);
+	}
+}
+
+// merges the runs of every worker, in id order, into the index, and removes them
+static void merge_runs(worker_t *workers, int nworkers, char *indexnm) {
+	char *runs[MAX_THREADS * 64];
+	int nruns = 0;
+	for (int w = 0; w < nworkers; w++) {
+		for (int r = 0; r < workers[w].nruns; r++) {
+			if (nruns == MAX_THREADS * 64) {
+				printf("Error: too many runs; raise --mem-limit\n");
+				exit(EXIT_FAILURE);
+			}
+			runs[nruns++] = workers[w].runs[r];
+		}
+	}
 
-	if (indexsave(htp, indexnm) != 0) {
+	printf("Merging %d runs into %s\n", nruns, indexnm);
+	int32_t result = nruns == 1 ? rename(runs[0], indexnm) : indexmerge(runs, nruns, indexnm);
+	for (int r = 0; r < nruns; r++) {
+		remove(runs[r]);
+		free(runs[r]);
+	}
+	for (int w = 0; w < nworkers; w++) {
+		free(workers[w].runs);
+	}
+	if (result != 0) {
 		printf("Failed saving indexes\n");
-		exit(EXIT_FAILURE); 
-	}; 
+		exit(EXIT_FAILURE);
+	}
+}
+
+/*
+ * build_index -- indexes the pages of the corpus into indexnm with
+ * nthreads workers, in memory or, given mem_limit megabytes, through
+ * runs
+ */
+static void build_index(corpus_t *cp, int nthreads, long mem_limit, char *indexnm) {
+	// no more workers than pages; the budget is shared between them
+	int nworkers = nthreads < cp->nids ? nthreads : (cp->nids > 0 ? cp->nids : 1);
+	worker_t workers[MAX_THREADS];
+	for (int w = 0; w < nworkers; w++) {
+		workers[w] = (worker_t) { .corpus = cp, .nparts = nworkers, .workers = workers,
+															.nworkers = nworkers, .part = w,
+															.first = (int64_t) cp->nids * w / nworkers,
+															.last = (int64_t) cp->nids * (w + 1) / nworkers,
+															.budget = (size_t) mem_limit * 1024 * 1024 / nworkers,
+															.indexnm = indexnm };
+		workers[w].terms = termdict_open(TERMDICT_SIZE);
+		workers[w].merged = hopen(INDEXER_HASH_TABLE_SIZE);
+		workers[w].parts = calloc(nworkers, sizeof(queue_t *));
+		if (workers[w].terms == NULL || workers[w].merged == NULL || workers[w].parts == NULL) {
+			printf("Error: could not create hash table\n");
+			exit(EXIT_FAILURE);
+		}
+		// the rows file is removed at once; it lasts until save_docstore closes it
+		char *rowsnm = malloc(strlen(indexnm) + 32);
+		if (rowsnm == NULL) {
+			printf("Error: failed malloc call\n");
+			exit(EXIT_FAILURE);
+		}
+		sprintf(rowsnm, "%s.rows%d", indexnm, w);
+		if ((workers[w].rows = fopen(rowsnm, "w+")) == NULL) {
+			printf("Error: could not create rows file %s\n", rowsnm);
+			exit(EXIT_FAILURE);
+		}
+		remove(rowsnm);
+		free(rowsnm);
+		cp->rows[w] = workers[w].rows;
+		for (int m = 0; m < nworkers; m++) {
+			if ((workers[w].parts[m] = qopen()) == NULL) {
+				printf("Error: could not create queue\n");
+				exit(EXIT_FAILURE);
+			}
+		}
+	}
+
+	// positions of an earlier build no longer match the index
+	char *posnm = posindex_file(indexnm);
+	if (posnm == NULL) {
+		printf("Error: failed malloc call\n");
+		exit(EXIT_FAILURE);
+	}
+	if (!cp->positional) remove(posnm);
+
+	run_workers(workers, nworkers, index_worker);
+	cp->nrows = nworkers;
+	if (mem_limit > 0) {
+		merge_runs(workers, nworkers, indexnm);
+		for (int w = 0; w < nworkers; w++) {
+			for (int m = 0; m < nworkers; m++) {
+				qclose(workers[w].parts[m]);
+			}
+		}
+	} else {
+		run_workers(workers, nworkers, merge_worker);
+
+		hashtable_t *merged[MAX_THREADS];
+		for (int w = 0; w < nworkers; w++) {
+			merged[w] = workers[w].merged;
+		}
+		if (indexsave_positional(merged, nworkers, indexnm, cp->positional ? posnm : NULL) != 0) {
+			printf("Failed saving indexes\n");
+			exit(EXIT_FAILURE); 
+		}; 
+		for (int w = 0; w < nworkers; w++) {
+			happly(merged[w], cleanup_indices); 
+		}
+	}
 	
-	happly(htp, cleanup_indices); 
-	hclose(htp); 
+	for (int w = 0; w < nworkers; w++) {
+		hclose(workers[w].merged); 
+		free(workers[w].parts);
+	}
+	for (int w = 0; w < nworkers; w++) {
+		termdict_close(workers[w].terms);
+	}
+	free(posnm);
+}
+
+// the number of words index_page indexes on page
+static uint32_t page_words(webpage_t *page) {
+	uint32_t nwords = 0;
+	webpage_token_t token;
+	for (int pos = 0; (pos = webpage_nextToken(page, pos, &token)) > 0; ) {
+		if (token.kind == WEBPAGE_WORD && token.length >= 3) nwords++;
+	}
+	return nwords;
+}
+
+/*
+ * next_row -- reads the next docstore row the workers wrote, in id
+ * order, into row and its url into *url, a buffer of *cap bytes that
+ * grows as needed; returns false when there are no rows left. Each
+ * rows file is closed once it is read.
+ */
+static bool next_row(corpus_t *cp, int *r, page_row_t *row, char **url, size_t *cap) {
+	for (; *r < cp->nrows; fclose(cp->rows[(*r)++])) {
+		if (fread(row, sizeof(page_row_t), 1, cp->rows[*r]) != 1) continue;
+		if (row->url_len + 1 > *cap) {
+			*cap = row->url_len + 1;
+			if ((*url = realloc(*url, *cap)) == NULL) {
+				printf("Error: failed malloc call\n");
+				exit(EXIT_FAILURE);
+			}
+		}
+		if (fread(*url, 1, row->url_len, cp->rows[*r]) != row->url_len) {
+			printf("Error: could not read the docstore rows\n");
+			exit(EXIT_FAILURE);
+		}
+		(*url)[row->url_len] = '\0';
+		return true;
+	}
+	return false;
+}
+
+/*
+ * save_docstore -- writes the docstore of the index indexnm over the
+ * nall pages all: those just indexed from the rows their workers
+ * wrote, the others from the docstore old, or, indexed before there
+ * was one, from the page itself
+ */
+static void save_docstore(corpus_t *cp, uint64_t *all, int nall, docstore_t *old, char *indexnm) {
+	char *docsnm = docstore_file(indexnm);
+	char *tmpnm = malloc(strlen(indexnm) + 16);
+	if (docsnm == NULL || tmpnm == NULL) {
+		printf("Error: failed malloc call\n");
+		exit(EXIT_FAILURE);
+	}
+	// readers may have the old one mapped; it is replaced, never rewritten
+	sprintf(tmpnm, "%s.tmp", docsnm);
+	docstore_writer_t *dwp = docstore_writer_open(tmpnm);
+	if (dwp == NULL) exit(EXIT_FAILURE);
+
+	for (int r = 0; r < cp->nrows; r++) {
+		if (fflush(cp->rows[r]) != 0 || fseek(cp->rows[r], 0, SEEK_SET) != 0) {
+			printf("Error: could not write the docstore rows\n");
+			exit(EXIT_FAILURE);
+		}
+	}
+	int r = 0;
+	page_row_t row;
+	char *url = NULL;
+	size_t cap = 0;
+	bool more = next_row(cp, &r, &row, &url, &cap);
+
+	int j = 0;
+	for (int i = 0; i < nall; i++) {
+		uint64_t page_id = all[i];
+		docstore_doc_t doc;
+		if (j < cp->nids && cp->ids[j] == page_id) {
+			j++;
+			if (!more || row.id != page_id) continue;
+			doc = (docstore_doc_t) { .url = url, .depth = row.depth, .length = row.length, .terms = row.terms };
+		} else if (!docstore_get(old, page_id, &doc)) {
+			webpage_t *page = cp->store ? pagestore_load(cp->store, page_id) : pageload(page_id, cp->pagedir);
+			if (page == NULL) continue;
+			doc = (docstore_doc_t) { .url = webpage_getURL(page), .depth = webpage_getDepth(page),
+															 .length = webpage_getHTMLlen(page), .terms = page_words(page) };
+			docstore_writer_add(dwp, page_id, &doc);
+			webpage_delete(page);
+			continue;
+		}
+		docstore_writer_add(dwp, page_id, &doc);
+		if (more && row.id == page_id) more = next_row(cp, &r, &row, &url, &cap);
+	}
+	for (; r < cp->nrows; r++) fclose(cp->rows[r]);
+	free(url);
+	if (docstore_writer_close(dwp) != 0 || rename(tmpnm, docsnm) != 0) {
+		printf("Failed saving docstore %s\n", docsnm);
+		remove(tmpnm);
+		exit(EXIT_FAILURE);
+	}
+	free(tmpnm);
+	free(docsnm);
+}
+
+// the stamp of page_id: when it was last saved, comparable with the corpus mark
+static uint64_t page_stamp(corpus_t *cp, uint64_t page_id) {
+	if (cp->store != NULL) return pagestore_stamp(cp->store, page_id);
+
+	char filepath[300];
+	struct stat stbuf;
+	sprintf(filepath, "%s/%lu", cp->pagedir, page_id);
+	return stat(filepath, &stbuf) == 0 ? (uint64_t) stbuf.st_mtime : 0;
+}
+
+/*
+ * update_index -- brings the segmented index indexnm up to date with
+ * the corpus. Pages deleted, or saved again since the last update, get
+ * a tombstone in their segment; only the new and saved pages are
+ * indexed, into a new segment; then the merge policy runs. An index
+ * that does not exist yet is created with every page in one segment.
+ */
+static void update_index(corpus_t *cp, int nthreads, long mem_limit, char *indexnm) {
+	struct stat stbuf;
+	segments_t *ssp = NULL;
+	if (segments_exists(indexnm)) {
+		ssp = segments_load(indexnm);
+	} else if (stat(indexnm, &stbuf) == 0) {
+		printf("Error: %s is not a segmented index; remove it, or index without --update\n", indexnm);
+		exit(EXIT_FAILURE);
+	} else {
+		ssp = segments_new();
+	}
+	if (ssp == NULL) {
+		printf("Error: could not read index %s\n", indexnm);
+		exit(EXIT_FAILURE);
+	}
+
+	uint64_t *all = malloc((cp->nids > 0 ? cp->nids : 1) * sizeof(uint64_t));
+	if (all == NULL) {
+		printf("Error: failed malloc call\n");
+		exit(EXIT_FAILURE);
+	}
+	memcpy(all, cp->ids, cp->nids * sizeof(uint64_t));
+	int nall = cp->nids;
+
+	int ndeleted = 0, nchanged = 0;
+	for (int s = 0; s < ssp->nsegs; s++) {
+		segment_t *sp = &ssp->segs[s];
+		for (uint32_t i = 0; i < sp->nids; i++) {
+			uint64_t page_id = sp->ids[i];
+			if (!segment_live(sp, page_id) ||
+					bsearch(&page_id, cp->ids, cp->nids, sizeof(uint64_t), compare_ids) != NULL) continue;
+			if (segments_delete(ssp, page_id) != 0) {
+				printf("Error: failed malloc call\n");
+				exit(EXIT_FAILURE);
+			}
+			ndeleted++;
+		}
+	}
+
+	// a mark of the other layout says nothing of when pages were saved
+	bool comparable = ssp->store == (cp->store != NULL);
+	int n = 0;
+	for (int i = 0; i < cp->nids; i++) {
+		uint64_t page_id = cp->ids[i];
+		if (segments_find(ssp, page_id) >= 0) {
+			if (comparable && page_stamp(cp, page_id) < ssp->mark) continue;
+			if (segments_delete(ssp, page_id) != 0) {
+				printf("Error: failed malloc call\n");
+				exit(EXIT_FAILURE);
+			}
+			nchanged++;
+		}
+		cp->ids[n++] = page_id;
+	}
+	cp->nids = n;
+	printf("Updating %s: %d new, %d changed, %d deleted pages\n", indexnm, n - nchanged, nchanged, ndeleted);
+
+	if (cp->nids > 0) {
+		char *segnm = segments_file(indexnm, ssp->next_gen);
+		if (segnm == NULL) {
+			printf("Error: failed malloc call\n");
+			exit(EXIT_FAILURE);
+		}
+		build_index(cp, nthreads, mem_limit, segnm);
+		free(segnm);
+		if (segments_add(ssp, cp->ids, cp->nids) != 0) {
+			printf("Error: failed malloc call\n");
+			exit(EXIT_FAILURE);
+		}
+	}
+	ssp->store = cp->store != NULL;
+	ssp->mark = cp->mark;
+
+	// the docstore goes first: until the manifest is saved, its new pages are in no segment
+	char *docsnm = docstore_file(indexnm);
+	docstore_t *old = docsnm != NULL ? docstore_open(docsnm) : NULL;
+	save_docstore(cp, all, nall, old, indexnm);
+	docstore_close(old);
+	free(docsnm);
+	free(all);
+
+	if (segments_compact(ssp, indexnm) < 0 || segments_save(ssp, indexnm) != 0) {
+		printf("Failed saving indexes\n");
+		exit(EXIT_FAILURE);
+	}
+	segments_free(ssp);
+}
+
+int main(int argc, char *argv[]){
+	if (argc < 3){
+		printf("%s", usage);
+		exit(EXIT_FAILURE);
+	}
+	char *pagedir = argv[1];
+	validate_dir(pagedir);
+
+	// create output file (validate indexnm)
+	// find what index we need to go to
+	char *indexnm = argv[2];
+
+	int nthreads = 1;
+	long mem_limit = 0;    // megabytes; 0 to index in memory
+	bool update = false;
+	bool positional = false;
+	for (int i = 3; i < argc; i++) {
+		char *endptr;
+		if (strcmp(argv[i], "-j") == 0 && i + 1 < argc) {
+			errno = 0;
+			nthreads = strtol(argv[++i], &endptr, 10);
+			if (*endptr != '\0' || errno != 0 || nthreads < 1 || nthreads > MAX_THREADS) {
+				printf("%s", usage);
+				printf("Invalid <threads> argument, expected 1 to %d\n", MAX_THREADS);
+				exit(EXIT_FAILURE);
+			}
+		} else if (strcmp(argv[i], "--mem-limit") == 0 && i + 1 < argc) {
+			errno = 0;
+			mem_limit = strtol(argv[++i], &endptr, 10);
+			if (*endptr != '\0' || errno != 0 || mem_limit < 1 || mem_limit > 1024 * 1024) {
+				printf("%s", usage);
+				printf("Invalid <megabytes> argument, expected 1 to %d\n", 1024 * 1024);
+				exit(EXIT_FAILURE);
+			}
+		} else if (strcmp(argv[i], "--update") == 0) {
+			update = true;
+		} else if (strcmp(argv[i], "-p") == 0) {
+			positional = true;
+		} else {
+			printf("%s", usage);
+			printf("Unknown option '%s'\n", argv[i]);
+			exit(EXIT_FAILURE);
+		}
+	}
+
+	// runs and segments are merged without their positions
+	if (positional && (mem_limit > 0 || update)) {
+		printf("%s", usage);
+		printf("A positional index (-p) is built in memory, without --mem-limit or --update\n");
+		exit(EXIT_FAILURE);
+	}
+
+	corpus_t corpus = { .pagedir = pagedir, .positional = positional };
+  if (pagestore_exists(pagedir)) {
+    collect_store(&corpus);
+  } else {
+    collect_files(&corpus);
+  }
+	qsort(corpus.ids, corpus.nids, sizeof(uint64_t), compare_ids);
+
+	if (update) {
+		update_index(&corpus, nthreads, mem_limit, indexnm);
+	} else {
+		build_index(&corpus, nthreads, mem_limit, indexnm);
+		save_docstore(&corpus, corpus.ids, corpus.nids, NULL, indexnm);
+	}
+	pagestore_close(corpus.store);
+	free(corpus.ids);
 }
@@ -9,13 +9,22 @@
  * 
  */
 
+#define _POSIX_C_SOURCE 200809L   // strtok_r, open_memstream, sigaction, clock_gettime
 
 #include <stdio.h>
 #include <stdlib.h>
 #include <limits.h>
+#include <math.h>
 #include "hash.h"
+#include "lhash.h"
 #include "queue.h"
+#include "bqueue.h"
 #include "indexio.h"
+#include "indexmap.h"
+#include "segments.h"
+#include "docstore.h"
+#include "posindex.h"
+#include "pagestore.h"
 #include <string.h>
 #include <stdlib.h>
 #include <stdint.h>
@@ -26,14 +35,30 @@
 #include <dirent.h>
 #include <errno.h>
 #include <stdbool.h>
+#include <pthread.h>
+#include <signal.h>
+#include <time.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
 
 
 static uint64_t LINE_LEN = 256;
 
+#define MAX_THREADS 64
+#define BATCH_QUERIES 4096        // queries read, and answered, at a time in a batch
+#define SERVE_THREADS 4           // workers of a server started without -j
+#define SERVE_BACKLOG 64          // connections not yet accepted, and queries not yet taken by a worker
+#define SERVE_SEND_TIMEOUT 10     // seconds a worker waits on a client that does not take its answer
+
+static char *usage = "usage: query <pageDir> <indexFile> [-q <queryFile> <outFile>] [--bm25] [-k <results>] [-j <threads>] [--serve <socketPath|port>]\n";
+
 static FILE *out_fp = NULL;
 
 
-// converts a word to lowercase
+// converts a word to lowercase; a trailing '*' (a prefix query) is kept
 char *NormalizeWord(const char *word){
 	if (word == NULL) return NULL;
 	int len = strlen(word);
@@ -41,41 +66,152 @@ char *NormalizeWord(const char *word){
 	char *normalized = malloc((len + 1) * sizeof(char));
 	if (!normalized) return NULL;
 	for (int i = 0; i < len; i++) {
-		if (!isalpha(word[i])) {
+		if (word[i] == '*' && i == len - 1 && i > 0) {
+			normalized[i] = '*';
+		} else if (!isalpha(word[i])) {
 			free(normalized);
 			return NULL;
+		} else {
+			normalized[i] = tolower(word[i]);
 		}
-		normalized[i] = tolower(word[i]);
 	}
 	normalized[len] = '\0';
 	return normalized;
 }
 
-// hsearch helper for document_t
-static bool match_docid(void *elementp, const void *keyp){
-	document_t *doc = (document_t *) elementp;
-	uint64_t target = *(uint64_t *) keyp;
-	return(doc->id == target);
-}
-
 // hsearch helper for word_index_t
 static bool match_word(void *elementp, const void *keyp){
 	word_index_t *w = (word_index_t *) elementp;
 	return strcmp(w->word, (const char *)keyp) == 0;
 }
 
-// get count for a given word in document ID 1
-static int count_for_word(hashtable_t *index, const char *word, const uint64_t docid){
-	if (!index || !word) return 0;
+static indexmap_t **index_maps = NULL;    // the mapped index, or one per segment
+static int nmaps = 0;
+static segments_t *index_segments = NULL; // the manifest of a segmented index
+
+// appends the postings of term t of mapped index m to entry, but for those with a tombstone
+static void gather_term(int m, int64_t t, word_index_t *entry){
+	indexmap_iter_t it;
+	if (!indexmap_postings(index_maps[m], t, &it)) return;
+	while (indexmap_next(&it)) {
+		if (index_segments != NULL && segment_deleted(&index_segments->segs[m], it.id)) continue;
+		postings_append(entry, it.id, it.count);
+	}
+}
 
-	// find word_index struct in hashtable
-	word_index_t *entry = hsearch(index, match_word, word, strlen(word));
-	if (entry == NULL || entry->docs == NULL) return 0;
+static void merge_postings(word_index_t *entry);
+
+/*
+ * map_word -- decodes the postings of a word from a mapped index, from
+ * every segment of a segmented index. A word missing from the index
+ * has no postings.
+ */
+static word_index_t *map_word(const char *word){
+	int len = strlen(word);
+	word_index_t *entry = word_index_new(word, len);
+	if (entry == NULL) return NULL;
+	for (int m = 0; m < nmaps; m++) {
+		int64_t t = indexmap_find(index_maps[m], word, len);
+		if (t >= 0) gather_term(m, t, entry);
+	}
+	if (nmaps > 1) merge_postings(entry);
+	return entry;
+}
+
+static int compare_docs(const void *a, const void *b){
+	uint64_t ida = ((const document_t *) a)->id, idb = ((const document_t *) b)->id;
+	return ida < idb ? -1 : ida > idb;
+}
+
+// sorts the postings gathered for a prefix by id, adding up the counts of each document
+static void merge_postings(word_index_t *entry){
+	if (entry->ndocs == 0) return;
+	qsort(entry->docs, entry->ndocs, sizeof(document_t), compare_docs);
+	uint32_t n = 1;
+	for (uint32_t i = 1; i < entry->ndocs; i++) {
+		if (entry->docs[i].id == entry->docs[n - 1].id) {
+			entry->docs[n - 1].count += entry->docs[i].count;
+		} else {
+			entry->docs[n++] = entry->docs[i];
+		}
+	}
+	entry->ndocs = n;
+}
+
+static _Thread_local word_index_t *prefix_entry = NULL;
+static void gather_prefix(void *ep){
+	word_index_t *record = (word_index_t *) ep;
+	int len = strlen(prefix_entry->word) - 1;
+	if (strncmp(record->word, prefix_entry->word, len) != 0 || strchr(record->word, '*') != NULL) return;
+	for (uint32_t i = 0; i < record->ndocs; i++) {
+		postings_append(prefix_entry, record->docs[i].id, record->docs[i].count);
+	}
+}
 
-	document_t *doc = qsearch(entry->docs, match_docid, &docid);
-	if (doc == NULL) return 0;
+/*
+ * prefix_word -- the postings of every word starting with the prefix
+ * "word*", merged into one entry: the count of a document is the
+ * number of times any of the words occur in it
+ */
+static word_index_t *prefix_word(hashtable_t *index, const char *word){
+	int len = strlen(word);
+	word_index_t *entry = word_index_new(word, len);
+	if (entry == NULL) return NULL;
+
+	int64_t first, last;
+	if (index_maps == NULL) {
+		prefix_entry = entry;
+		happly(index, gather_prefix);
+		prefix_entry = NULL;
+	}
+	for (int m = 0; m < nmaps; m++) {
+		if (!indexmap_prefix(index_maps[m], word, len - 1, &first, &last)) continue;
+		for (int64_t t = first; t < last; t++) gather_term(m, t, entry);
+	}
+	merge_postings(entry);
+	return entry;
+}
+
+static lhashtable_t *word_cache = NULL;   // words decoded or gathered for past queries
+static bool cache_all = true;             // false for a server, which caches no prefixes or phrases
+static posindex_t *index_positions = NULL; // of a mapped index built with -p
+
+static word_index_t *phrase_word(hashtable_t *index, const char *phrase);
 
-	return doc->count;
+/*
+ * cached -- whether the entry of word is kept for later queries. A
+ * server would cache every prefix and phrase its clients ever ask for,
+ * so it only keeps words, of which there are no more than the index
+ * holds; the others are built for each query and freed with it.
+ */
+static bool cached(const char *word) {
+	int len = strlen(word);
+	return cache_all || (word[0] != '"' && (len <= 1 || word[len - 1] != '*'));
+}
+
+/*
+ * find_word -- the entry of a word, of a prefix "word*", or of a phrase
+ * (see phrase_word), building it on first use from a mapped index and
+ * caching it, if it is cached at all. Queries run on many threads at
+ * once: an entry two of them build together is cached once.
+ */
+static word_index_t *find_word(hashtable_t *index, const char *word){
+	if (!index || !word) return NULL;
+
+	// find word_index struct in hashtable
+	int len = strlen(word);
+	word_index_t *entry = hsearch(index, match_word, word, len);
+	if (entry == NULL) entry = lhsearch(word_cache, match_word, word, len);
+	if (entry != NULL) return entry;
+
+	if (word[0] == '"') entry = phrase_word(index, word);
+	else if (len > 1 && word[len - 1] == '*') entry = prefix_word(index, word);
+	else if (index_maps != NULL) entry = map_word(word);
+	if (entry != NULL && cached(word) && lhputnew(word_cache, entry, match_word, entry->word, len) != 0) {
+		word_index_free(entry);
+		entry = lhsearch(word_cache, match_word, word, len);
+	}
+	return entry;
 }
 
 typedef struct doc_url {
@@ -83,7 +219,40 @@ typedef struct doc_url {
 	char *url; 
 } doc_url_t; 
 
-static hashtable_t *urlload(const char *pagedir) {
+// loads the urls of the pages packed in the page store of pagedir
+static hashtable_t *urlload_store(char *pagedir) {
+	pagestore_t *psp = pagestore_open(pagedir, false);
+	if (psp == NULL) {
+		printf("Error: could not open page store in %s\n", pagedir);
+		exit(EXIT_FAILURE);
+	}
+
+	hashtable_t *htp = hopen(100);
+	if (htp == NULL) {
+		printf("Error: could not create hash table\n");
+		exit(EXIT_FAILURE); 
+	}
+
+	char key[32];
+	for (int page_id = 1; page_id <= pagestore_maxid(psp); page_id++) {
+		char *url_ = pagestore_url(psp, page_id);
+		if (url_ == NULL) continue;
+		printf("URL: %s for doc: %d\n", url_, page_id);
+
+		doc_url_t *d = malloc(sizeof(doc_url_t));
+		d->url = url_;
+		d->docid = page_id;
+		sprintf(key, "%d", page_id);
+		hput(htp, d, key, strlen(key));
+	}
+
+	pagestore_close(psp);
+	return htp;
+}
+
+static hashtable_t *urlload(char *pagedir) {
+	if (pagestore_exists(pagedir)) return urlload_store(pagedir);
+
 	DIR *d = opendir(pagedir);
 	if (d == NULL) {
 		printf("Error: could not open page directory\n");
@@ -161,25 +330,14 @@ bool word_search_fn(void *ep, const void *searchkeyp) {
 	return strlen(element) == strlen(key) && strcmp(element, key) == 0; 
 }
 
-static int min_count = -1;
-static uint64_t current_docid = 1; 
 static hashtable_t *index_table = NULL;
-void apply_word_count(void *ep) {
-	char *element = (char *) ep;
-	int count = count_for_word(index_table, element, current_docid);
-	if (min_count == -1 || count < min_count) min_count = count;
-}
 
 void cleanup_word(void *ep) {
 	free(ep); 
 }
 
 void cleanup_index(void *ep) {
-	word_index_t *element = (word_index_t *) ep;
-	free(element->word);
-	qapply(element->docs, cleanup_word); 
-	qclose(element->docs);
-	free(element); 
+	word_index_free((word_index_t *) ep);
 }
 
 void cleanup_url(void *ep) {
@@ -189,42 +347,451 @@ void cleanup_url(void *ep) {
 }
 
 static hashtable_t *url_map = NULL;
-static int query_max_count = -1; 
-void apply_andseq_word_count(void *ep) {
-	queue_t *element = (queue_t *) ep;
-	qapply(element, apply_word_count);
-	if (min_count > query_max_count) query_max_count = min_count; 
-	min_count = -1;
+static docstore_t *doc_store = NULL;     // NULL: the urls are in url_map
+
+static bool match_docid(void *ep, const void *keyp) {
+	return ((doc_url_t *) ep)->docid == strtoull((const char *) keyp, NULL, 10);
 }
 
-static queue_t *final_query = NULL;
+// the url and statistics of page id, from the docstore or the url map; false for a page with none
+static bool find_doc(uint64_t id, docstore_doc_t *doc) {
+	if (doc_store != NULL) return docstore_get(doc_store, id, doc);
 
-void apply_per_doc_query_rank(void *ep) {
-	doc_url_t *element = (doc_url_t *) ep;
-	uint64_t docid = element->docid;
-	char *url = element->url;
+	char key[32];
+	sprintf(key, "%lu", id);
+	doc_url_t *d = hsearch(url_map, match_docid, key, strlen(key));
+	if (d == NULL) return false;
+	*doc = (docstore_doc_t) { .url = d->url };
+	return true;
+}
+
+#define BM25_K1 1.2
+#define BM25_B 0.75
 
-	current_docid = docid;
-	qapply(final_query, apply_andseq_word_count);
-	if ((query_max_count == -1 ? 0 : query_max_count) != 0){
-		printf("rank: %d : doc: %ld : %s\n", (query_max_count == -1 ? 0 : query_max_count), docid, url);
+static bool bm25 = false;                // rank by BM25 rather than by counts
+static double avg_terms = 1;             // the average page length, in terms
+
+/*
+ * bm25_weight -- the BM25 weight of a word found tf times on a page of
+ * terms terms, and on df pages in all
+ */
+static double bm25_weight(uint64_t tf, uint32_t df, uint32_t terms) {
+	double ndocs = docstore_ndocs(doc_store);
+	double idf = log(1 + (ndocs - df + 0.5) / (df + 0.5));
+	double norm = BM25_K1 * (1 - BM25_B + BM25_B * terms / avg_terms);
+	return idf * tf * (BM25_K1 + 1) / (tf + norm);
+}
+
+#define BOUND_BLOCK 64               // postings under one block bound
+
+/*
+ * term_cursor_t -- walks the postings of a query word in id order. The
+ * bounds are the most any page can rank on the word alone: over all
+ * its postings, and over each block of BOUND_BLOCK of them.
+ */
+typedef struct term_cursor {
+	word_index_t *entry;    // NULL for a word on no page
+	bool owned;             // the entry is not cached, and is freed with the query
+	uint32_t pos;
+	double bound;
+	double *block_bounds;
+} term_cursor_t;
+
+/*
+ * cursor_seek -- moves the cursor forward to its first posting with an
+ * id of at least target: galloping from where it is, then a binary
+ * search, so skipping far costs the log of the distance.
+ * returns NULL past the last posting
+ */
+static document_t *cursor_seek(term_cursor_t *tc, uint64_t target) {
+	word_index_t *entry = tc->entry;
+	if (entry == NULL || tc->pos >= entry->ndocs) return NULL;
+	document_t *docs = entry->docs;
+	if (docs[tc->pos].id >= target) return &docs[tc->pos];
+
+	// docs[lo] is before target, and docs[hi] is not, or hi is the end
+	uint32_t lo = tc->pos, step = 1;
+	while (step < entry->ndocs - lo && docs[lo + step].id < target) {
+		lo += step;
+		step *= 2;
 	}
-	query_max_count = -1;
-	current_docid = 1; 
+	uint32_t hi = step < entry->ndocs - lo ? lo + step : entry->ndocs;
+	while (hi - lo > 1) {
+		uint32_t mid = lo + (hi - lo) / 2;
+		if (docs[mid].id < target) lo = mid;
+		else hi = mid;
+	}
+	tc->pos = hi;
+	return hi < entry->ndocs ? &docs[hi] : NULL;
 }
 
-void apply_per_doc_query_rank_fp(void *ep) {
-	doc_url_t *element = (doc_url_t *) ep;
-	uint64_t docid = element->docid;
-	char *url = element->url;
+/*
+ * andseq_cursor_t -- walks the pages that have every word of an and
+ * sequence; its words are ordered by postings, shortest first, so the
+ * rarest word picks the pages the others are sought at
+ */
+typedef struct andseq_cursor {
+	term_cursor_t *terms;
+	int nterms;
+	uint64_t doc;           // the current page; UINT64_MAX past the last
+	double bound;           // no page ranks higher on this sequence
+} andseq_cursor_t;
+
+// moves the sequence to its first page with every word from target on
+static void andseq_seek(andseq_cursor_t *sc, uint64_t target) {
+	if (sc->nterms == 0) {
+		sc->doc = UINT64_MAX;
+		return;
+	}
+	int matched = 0;
+	for (int i = 0; matched < sc->nterms; i = (i + 1) % sc->nterms) {
+		document_t *doc = cursor_seek(&sc->terms[i], target);
+		if (doc == NULL) {
+			sc->doc = UINT64_MAX;
+			return;
+		}
+		if (doc->id == target) {
+			matched++;
+		} else {
+			target = doc->id;
+			matched = 1;
+		}
+	}
+	sc->doc = target;
+}
+
+/*
+ * andseq_score -- the rank of the sequence's current page: the least
+ * count of its words, or by BM25 the sum of their weights
+ */
+static double andseq_score(andseq_cursor_t *sc, uint32_t terms) {
+	double score = 0;
+	for (int i = 0; i < sc->nterms; i++) {
+		term_cursor_t *tc = &sc->terms[i];
+		uint64_t count = tc->entry->docs[tc->pos].count;
+		if (bm25) {
+			score += bm25_weight(count, tc->entry->ndocs, terms);
+		} else if (i == 0 || count < score) {
+			score = count;
+		}
+	}
+	return score;
+}
+
+/*
+ * andseq_block_bound -- the most the sequence can rank before next, the
+ * first id at which one of its words starts a new block
+ */
+static double andseq_block_bound(andseq_cursor_t *sc, uint64_t *next) {
+	double bound = 0;
+	*next = UINT64_MAX;
+	for (int i = 0; i < sc->nterms; i++) {
+		term_cursor_t *tc = &sc->terms[i];
+		uint32_t block = tc->pos / BOUND_BLOCK, end = (block + 1) * BOUND_BLOCK;
+		if (end < tc->entry->ndocs && tc->entry->docs[end].id < *next) *next = tc->entry->docs[end].id;
+		if (bm25) bound += tc->block_bounds[block];
+		else if (i == 0 || tc->block_bounds[block] < bound) bound = tc->block_bounds[block];
+	}
+	return bound;
+}
+
+static int compare_cursors(const void *a, const void *b) {
+	const term_cursor_t *x = a, *y = b;
+	uint32_t nx = x->entry ? x->entry->ndocs : 0, ny = y->entry ? y->entry->ndocs : 0;
+	return nx < ny ? -1 : nx > ny;
+}
+
+// query_run_t -- the cursors of a query, one per and sequence
+typedef struct query_run {
+	andseq_cursor_t *seqs;
+	int nseqs;
+} query_run_t;
+
+static _Thread_local query_run_t *opening = NULL;   // the query whose cursors are being opened
+
+void open_word_cursor(void *ep) {
+	andseq_cursor_t *sc = &opening->seqs[opening->nseqs - 1];
+	term_cursor_t *terms = realloc(sc->terms, (sc->nterms + 1) * sizeof(term_cursor_t));
+	if (terms == NULL) {
+		printf("Error: failed malloc call\n");
+		exit(EXIT_FAILURE);
+	}
+	sc->terms = terms;
+
+	/*
+	 * a bound is the highest count, or by BM25 the weight of that count
+	 * on a page of no length, which no page can outweigh
+	 */
+	word_index_t *entry = find_word(index_table, (char *) ep);
+	uint32_t ndocs = entry != NULL ? entry->ndocs : 0;
+	double *block_bounds = malloc(((ndocs + BOUND_BLOCK - 1) / BOUND_BLOCK + 1) * sizeof(double));
+	if (block_bounds == NULL) {
+		printf("Error: failed malloc call\n");
+		exit(EXIT_FAILURE);
+	}
+	double bound = 0;
+	for (uint32_t b = 0; b * BOUND_BLOCK < ndocs; b++) {
+		uint64_t max_count = 0;
+		for (uint32_t i = b * BOUND_BLOCK; i < ndocs && i < (b + 1) * BOUND_BLOCK; i++) {
+			if (entry->docs[i].count > max_count) max_count = entry->docs[i].count;
+		}
+		block_bounds[b] = bm25 ? bm25_weight(max_count, ndocs, 0) : max_count;
+		if (block_bounds[b] > bound) bound = block_bounds[b];
+	}
+	sc->terms[sc->nterms++] = (term_cursor_t) { .entry = entry, .owned = !cached((char *) ep), .bound = bound,
+																							.block_bounds = block_bounds };
+}
+
+void open_andseq_cursor(void *ep) {
+	andseq_cursor_t *seqs = realloc(opening->seqs, (opening->nseqs + 1) * sizeof(andseq_cursor_t));
+	if (seqs == NULL) {
+		printf("Error: failed malloc call\n");
+		exit(EXIT_FAILURE);
+	}
+	opening->seqs = seqs;
+	opening->seqs[opening->nseqs++] = (andseq_cursor_t) { .terms = NULL, .nterms = 0 };
+	qapply((queue_t *) ep, open_word_cursor);
+
+	// the bound is summed in the order andseq_score sums the weights
+	andseq_cursor_t *sc = &opening->seqs[opening->nseqs - 1];
+	qsort(sc->terms, sc->nterms, sizeof(term_cursor_t), compare_cursors);
+	for (int i = 0; i < sc->nterms; i++) {
+		double bound = sc->terms[i].bound;
+		if (bm25) sc->bound += bound;
+		else if (i == 0 || bound < sc->bound) sc->bound = bound;
+	}
+	andseq_seek(sc, 0);
+}
+
+/*
+ * phrase_word -- the pages on which the words of a phrase, "w1 w2 ...",
+ * occur in order next to each other, or of a proximity query,
+ * "w1 w2 ..."~N, in order with at most N other words between each and
+ * the next, as one entry: the count of a page is the number of times
+ * the phrase starts on it. The postings of the words are intersected
+ * first, and only the pages that have all of them have their positions
+ * read, from the positional index, and merged.
+ */
+static word_index_t *phrase_word(hashtable_t *index, const char *phrase){
+	int len = strlen(phrase);
+	word_index_t *entry = word_index_new(phrase, len);
+	char *words = malloc(len + 1);
+	if (entry == NULL || words == NULL) {
+		printf("Error: failed malloc call\n");
+		exit(EXIT_FAILURE);
+	}
+	strcpy(words, phrase + 1);
+	char *close = strchr(words, '"');
+	*close = '\0';
+	uint32_t slop = close[1] == '~' ? strtoul(close + 2, NULL, 10) : 0;
+
+	int nwords = 1;
+	for (char *c = words; *c != '\0'; c++) nwords += *c == ' ';
+	term_cursor_t *terms = calloc(nwords, sizeof(term_cursor_t));
+	posindex_iter_t *iters = calloc(nwords, sizeof(posindex_iter_t));
+	uint32_t *read = calloc(nwords, sizeof(uint32_t));       // the postings whose positions have been read past
+	uint32_t **positions = calloc(nwords, sizeof(uint32_t *));
+	uint64_t **next = calloc(nwords, sizeof(uint64_t *));      // room for posindex_phrase
+	uint64_t *counts = calloc(nwords, sizeof(uint64_t)), *capacities = calloc(nwords, sizeof(uint64_t));
+	if (terms == NULL || iters == NULL || read == NULL || positions == NULL || next == NULL || counts == NULL ||
+			capacities == NULL) {
+		printf("Error: failed malloc call\n");
+		exit(EXIT_FAILURE);
+	}
 
-	current_docid = docid;
-	qapply(final_query, apply_andseq_word_count);
-	if ((query_max_count == -1 ? 0 : query_max_count) != 0){
-		fprintf(out_fp, "rank: %d : doc: %ld : %s\n", (query_max_count == -1 ? 0 : query_max_count), docid, url);
+	bool found = index_positions != NULL;
+	char *saveptr;
+	int w = 0;
+	for (char *word = strtok_r(words, " ", &saveptr); word != NULL; word = strtok_r(NULL, " ", &saveptr), w++) {
+		terms[w].entry = find_word(index, word);
+		int64_t t = found ? indexmap_find(index_maps[0], word, strlen(word)) : -1;
+		found = found && terms[w].entry != NULL && t >= 0 && posindex_positions(index_positions, t, &iters[w]);
 	}
-	query_max_count = -1;
-	current_docid = 1; 
+
+	andseq_cursor_t sc = { .terms = terms, .nterms = nwords, .doc = UINT64_MAX };
+	if (found) andseq_seek(&sc, 0);
+	while (sc.doc != UINT64_MAX) {
+		for (w = 0; w < nwords; w++) {
+			document_t *docs = terms[w].entry->docs;
+			uint64_t skipped = 0;
+			for (uint32_t i = read[w]; i < terms[w].pos; i++) skipped += docs[i].count;
+			counts[w] = docs[terms[w].pos].count;
+			read[w] = terms[w].pos + 1;
+			if (counts[w] > capacities[w]) {
+				uint32_t *p = realloc(positions[w], counts[w] * sizeof(uint32_t));
+				if (p != NULL) positions[w] = p;
+				uint64_t *n = realloc(next[w], (counts[w] + 1) * sizeof(uint64_t));
+				if (n != NULL) next[w] = n;
+				if (p == NULL || n == NULL) {
+					printf("Error: failed malloc call\n");
+					exit(EXIT_FAILURE);
+				}
+				capacities[w] = counts[w];
+			}
+			if (!posindex_skip(&iters[w], skipped) || !posindex_read(&iters[w], counts[w], positions[w])) {
+				printf("Error: the positional index is corrupt\n");
+				sc.doc = UINT64_MAX;
+				break;
+			}
+		}
+		if (sc.doc == UINT64_MAX) break;
+
+		uint64_t matches = posindex_phrase(positions, counts, next, nwords, slop);
+		if (matches > 0 && !postings_append(entry, sc.doc, matches)) {
+			printf("Error: failed malloc call\n");
+			exit(EXIT_FAILURE);
+		}
+		andseq_seek(&sc, sc.doc + 1);
+	}
+
+	for (w = 0; w < nwords; w++) {
+		free(positions[w]);
+		free(next[w]);
+	}
+	free(positions);
+	free(next);
+	free(counts);
+	free(capacities);
+	free(read);
+	free(iters);
+	free(terms);
+	free(words);
+	return entry;
+}
+
+// result_t -- a ranked page; url points into the docstore or the url map
+typedef struct result {
+	double score;
+	uint64_t id;
+	const char *url;
+} result_t;
+
+// whether a ranks below b: by score, and on a tie the higher id
+static bool result_below(const result_t *a, const result_t *b) {
+	return a->score < b->score || (a->score == b->score && a->id > b->id);
+}
+
+static int compare_results(const void *a, const void *b) {
+	const result_t *x = a, *y = b;
+	return result_below(y, x) ? -1 : result_below(x, y);
+}
+
+// moves heap[i] down the min-heap of n results to where it belongs
+static void heap_sift_down(result_t *heap, int n, int i) {
+	for (;;) {
+		int least = i, l = 2 * i + 1, r = 2 * i + 2;
+		if (l < n && result_below(&heap[l], &heap[least])) least = l;
+		if (r < n && result_below(&heap[r], &heap[least])) least = r;
+		if (least == i) return;
+		result_t t = heap[i];
+		heap[i] = heap[least];
+		heap[least] = t;
+		i = least;
+	}
+}
+
+// adds a result to the min-heap of n results, which has room for it
+static void heap_push(result_t *heap, int n, result_t r) {
+	int i = n;
+	heap[i] = r;
+	while (i > 0 && result_below(&heap[i], &heap[(i - 1) / 2])) {
+		result_t t = heap[i];
+		heap[i] = heap[(i - 1) / 2];
+		heap[(i - 1) / 2] = t;
+		i = (i - 1) / 2;
+	}
+}
+
+static void print_result(FILE *fp, const result_t *r) {
+	if (bm25) {
+		fprintf(fp, "rank: %.4f : doc: %ld : %s\n", r->score, r->id, r->url);
+	} else {
+		fprintf(fp, "rank: %d : doc: %ld : %s\n", (int) r->score, r->id, r->url);
+	}
+}
+
+static int top_k = 0;                    // print only the best top_k pages; 0 for all
+
+/*
+ * run_query -- ranks the pages matching the query and prints them to
+ * fp, document at a time: each and sequence intersects the postings of
+ * its words, and the query walks the union of its sequences, so only
+ * the pages that match are ever looked at. A page ranks as its best
+ * sequence. Every page is printed in id order, or with top_k the best
+ * top_k by rank, kept in a min-heap.
+ *
+ * A page takes the rank of its best sequence, so once the heap is full
+ * a sequence bound to rank no higher than the least page in it cannot
+ * change the results: it is dropped, and its postings are never walked
+ * again (MaxScore). Short of that, a sequence skips the blocks of
+ * postings whose bounds keep it out, without looking up or ranking
+ * their pages (block-max WAND). When no sequence is left the query
+ * stops early.
+ */
+static void run_query(queue_t *query, FILE *fp) {
+	query_run_t run = { .seqs = NULL, .nseqs = 0 };
+	opening = &run;
+	qapply(query, open_andseq_cursor);
+	opening = NULL;
+	andseq_cursor_t *seqs = run.seqs;
+	int nseqs = run.nseqs;
+
+	result_t *heap = top_k > 0 ? malloc(top_k * sizeof(result_t)) : NULL;
+	if (top_k > 0 && heap == NULL) {
+		printf("Error: failed malloc call\n");
+		exit(EXIT_FAILURE);
+	}
+	int nheap = 0;
+
+	for (;;) {
+		uint64_t id = UINT64_MAX;
+		for (int s = 0; s < nseqs; s++) {
+			andseq_cursor_t *sc = &seqs[s];
+			if (heap != NULL && nheap == top_k) {
+				if (sc->bound <= heap[0].score) sc->doc = UINT64_MAX;
+				uint64_t next;
+				while (sc->doc != UINT64_MAX && andseq_block_bound(sc, &next) <= heap[0].score) {
+					if (next == UINT64_MAX) sc->doc = UINT64_MAX;
+					else andseq_seek(sc, next);
+				}
+			}
+			if (sc->doc < id) id = sc->doc;
+		}
+		if (id == UINT64_MAX) break;
+
+		docstore_doc_t doc;
+		bool named = find_doc(id, &doc);
+		double score = 0;
+		for (int s = 0; s < nseqs; s++) {
+			if (seqs[s].doc != id) continue;
+			double seq_score = named ? andseq_score(&seqs[s], doc.terms) : 0;
+			if (seq_score > score) score = seq_score;
+			andseq_seek(&seqs[s], id + 1);
+		}
+
+		if (score <= 0) continue;
+		result_t r = { .score = score, .id = id, .url = doc.url };
+		if (heap == NULL) {
+			print_result(fp, &r);
+		} else if (nheap < top_k) {
+			heap_push(heap, nheap++, r);
+		} else if (result_below(&heap[0], &r)) {
+			heap[0] = r;
+			heap_sift_down(heap, nheap, 0);
+		}
+	}
+
+	if (heap != NULL) qsort(heap, nheap, sizeof(result_t), compare_results);
+	for (int i = 0; i < nheap; i++) print_result(fp, &heap[i]);
+	free(heap);
+	for (int s = 0; s < nseqs; s++) {
+		for (int i = 0; i < seqs[s].nterms; i++) {
+			if (seqs[s].terms[i].owned) word_index_free(seqs[s].terms[i].entry);
+			free(seqs[s].terms[i].block_bounds);
+		}
+		free(seqs[s].terms);
+	}
+	free(seqs);
 }
 
 void cleanup_andseq(void *ep) {
@@ -233,66 +800,93 @@ void cleanup_andseq(void *ep) {
 	qclose(element);
 }
 
-static int andseq_word_count = 0;
+static _Thread_local FILE *print_fp = NULL;
+static _Thread_local int andseq_word_count = 0;
 
 void apply_print_andseq(void *ep) {
 	char *element = (char *) ep;
 	if (andseq_word_count != 0) {
-		printf(" and "); 
-	}
-	printf("%s", element);
-	andseq_word_count++; 
-}
-
-void apply_print_andseq_fp(void *ep) {
-	char *element = (char *) ep;
-	if (andseq_word_count != 0) {
-		fprintf(out_fp," and "); 
+		fprintf(print_fp, " and "); 
 	}
-	fprintf(out_fp, "%s", element);
+	fprintf(print_fp, "%s", element);
 	andseq_word_count++; 
 }
 
-static int andseq_count = 0;
+static _Thread_local int andseq_count = 0;
 
 void apply_print_query(void *ep) {
 	queue_t *element = (queue_t *) ep;
 	if (andseq_count == 0) {
-		printf("("); 
+		fprintf(print_fp, "("); 
 	} else {
-		printf(" or \n("); 
+		fprintf(print_fp, " or \n("); 
 	}
 	qapply(element, apply_print_andseq);
 	andseq_word_count = 0; 
-	printf(")");
-	andseq_count++; 
-}
-
-void apply_print_query_fp(void *ep) {
-	queue_t *element = (queue_t *) ep;
-	if (andseq_count == 0) {
-		fprintf(out_fp, "("); 
-	} else {
-		fprintf(out_fp, " or \n("); 
-	}
-	qapply(element, apply_print_andseq_fp);
-	andseq_word_count = 0; 
-	fprintf(out_fp, ")");
+	fprintf(print_fp, ")");
 	andseq_count++; 
 }
 
-void print_query(queue_t *query) {
-	printf("[");
+void print_query(queue_t *query, FILE *fp) {
+	print_fp = fp;
+	fprintf(fp, "[");
   qapply(query, apply_print_query);
-	printf("]\n");
+	fprintf(fp, "]\n");
   andseq_count = 0;
+	print_fp = NULL;
 }
 
-void print_query_fp(queue_t *query) {
-	fprintf(out_fp, "[");
-  qapply(query, apply_print_query_fp);
-	fprintf(out_fp, "]\n");
-  andseq_count = 0;
+#define MAX_SLOP 1000              // words a proximity query may allow between its words
+
+/*
+ * read_phrase -- reads a phrase, "w1 w2 ...", or a proximity query,
+ * "w1 w2 ..."~N, from its first token on, taking the rest of its tokens
+ * from strtok_r. Returns it normalized, or a phrase of one word as the
+ * word, in a new string; NULL if it is not valid.
+ */
+static char *read_phrase(char *token, char **saveptr) {
+	char *phrase = malloc(LINE_LEN + 16);
+	if (phrase == NULL) {
+		printf("Error: failed malloc call\n");
+		exit(EXIT_FAILURE);
+	}
+	strcpy(phrase, "\"");
+	int nwords = 0;
+	char *word = NULL;
+
+	for (token++; token != NULL; token = strtok_r(NULL, " ", saveptr)) {
+		char *close = strchr(token, '"');
+		if (close != NULL) *close = '\0';
+		free(word);
+		word = NormalizeWord(token);
+		if (word == NULL || strlen(word) < 3 || strchr(word, '*') != NULL) break;
+		if (nwords++ > 0) strcat(phrase, " ");
+		strcat(phrase, word);
+		if (close == NULL) continue;
+
+		char *slop = close + 1, *endptr;
+		if (*slop == '~') {
+			errno = 0;
+			long n = strtol(slop + 1, &endptr, 10);
+			if (!isdigit((unsigned char) slop[1]) || *endptr != '\0' || errno != 0 || n > MAX_SLOP) break;
+			if (n > 0) sprintf(phrase + strlen(phrase), "\"~%ld", n);
+			else strcat(phrase, "\"");
+		} else if (*slop == '\0') {
+			strcat(phrase, "\"");
+		} else {
+			break;
+		}
+		if (nwords == 1) {
+			free(phrase);
+			return word;
+		}
+		free(word);
+		return phrase;
+	}
+
+	free(word);
+	free(phrase);
+	return NULL;
 }
 
 queue_t *build_query(char *line) {
@@ -310,8 +904,9 @@ queue_t *build_query(char *line) {
 
 	queue_t *current_andseq = NULL;
 	line[strcspn(line, "\n")] = '\0'; 
-	for (char *token = strtok(line, " "); token != NULL; token = strtok(NULL, " ")) {
-		char *lowercase = NormalizeWord(token);
+	char *saveptr;
+	for (char *token = strtok_r(line, " ", &saveptr); token != NULL; token = strtok_r(NULL, " ", &saveptr)) {
+		char *lowercase = token[0] == '"' ? read_phrase(token, &saveptr) : NormalizeWord(token);
 		if (lowercase == NULL) {
 			valid = false;
 			break; 
@@ -382,9 +977,498 @@ queue_t *build_query(char *line) {
 	return query; 
 }
 
+static _Thread_local bool phrased = false;   // whether the query checked has a phrase
+
+void check_phrase(void *ep) {
+	if (((char *) ep)[0] == '"') phrased = true;
+}
+
+void check_andseq_phrase(void *ep) {
+	qapply((queue_t *) ep, check_phrase);
+}
+
+// answers a line of queries, to fp
+static void answer_query(char *line, FILE *fp) {
+	queue_t *query = build_query(line);
+	if (query == NULL) {
+		fprintf(fp, "[invalid query]\n");
+		return;
+	}
+	print_query(query, fp);
+
+	phrased = false;
+	qapply(query, check_andseq_phrase);
+	if (phrased && index_positions == NULL) {
+		fprintf(fp, "[phrases need an index built with -p]\n");
+	} else {
+		run_query(query, fp);
+	}
+	qapply(query, cleanup_andseq);
+	qclose(query);
+}
+
+// batch_t -- a batch of queries, taken by threads in turn, and their answers
+typedef struct batch {
+	char **lines;
+	char **answers;
+	size_t *lens;
+	int nlines;
+	int next;               // the first query no thread has taken
+	pthread_mutex_t lock;
+} batch_t;
+
+static void *batch_worker(void *arg) {
+	batch_t *bp = (batch_t *) arg;
+	for (;;) {
+		pthread_mutex_lock(&bp->lock);
+		int i = bp->next++;
+		pthread_mutex_unlock(&bp->lock);
+		if (i >= bp->nlines) return NULL;
+
+		FILE *fp = open_memstream(&bp->answers[i], &bp->lens[i]);
+		if (fp == NULL) {
+			printf("Error: could not buffer the answer to a query\n");
+			exit(EXIT_FAILURE);
+		}
+		answer_query(bp->lines[i], fp);
+		fclose(fp);
+	}
+}
+
+/*
+ * run_batch -- answers the queries of query_fp on nthreads threads, a
+ * batch of BATCH_QUERIES at a time, and writes the answers to fp in the
+ * order of the queries. The index, docstore and url map are only read,
+ * and every query keeps its state to itself; the threads share the
+ * cache of decoded words.
+ */
+static void run_batch(FILE *query_fp, FILE *fp, int nthreads) {
+	batch_t batch = { .lines = calloc(BATCH_QUERIES, sizeof(char *)), .answers = calloc(BATCH_QUERIES, sizeof(char *)),
+										.lens = calloc(BATCH_QUERIES, sizeof(size_t)) };
+	if (batch.lines == NULL || batch.answers == NULL || batch.lens == NULL) {
+		printf("Error: failed malloc call\n");
+		exit(EXIT_FAILURE);
+	}
+	pthread_mutex_init(&batch.lock, NULL);
+
+	char line[LINE_LEN];
+	bool more = true;
+	while (more) {
+		batch.nlines = 0;
+		batch.next = 0;
+		while (batch.nlines < BATCH_QUERIES && (more = fgets(line, sizeof(line), query_fp) != NULL)) {
+			if ((batch.lines[batch.nlines] = malloc(strlen(line) + 1)) == NULL) {
+				printf("Error: failed malloc call\n");
+				exit(EXIT_FAILURE);
+			}
+			strcpy(batch.lines[batch.nlines++], line);
+		}
+
+		pthread_t threads[MAX_THREADS];
+		for (int t = 0; t < nthreads; t++) {
+			if (pthread_create(&threads[t], NULL, batch_worker, &batch) != 0) {
+				printf("Error: could not start query thread %d\n", t);
+				exit(EXIT_FAILURE);
+			}
+		}
+		for (int t = 0; t < nthreads; t++) {
+			pthread_join(threads[t], NULL);
+		}
+
+		for (int i = 0; i < batch.nlines; i++) {
+			fwrite(batch.answers[i], 1, batch.lens[i], fp);
+			free(batch.answers[i]);
+			free(batch.lines[i]);
+		}
+	}
+
+	pthread_mutex_destroy(&batch.lock);
+	free(batch.lines);
+	free(batch.answers);
+	free(batch.lens);
+}
+
+static volatile sig_atomic_t serving = 1;
+
+static void stop_serving(int sig) {
+	(void) sig;
+	serving = 0;
+}
+
+// whether the address to serve on is a port on localhost, rather than the path of a unix socket
+static bool serve_port(const char *addr) {
+	return *addr != '\0' && strspn(addr, "0123456789") == strlen(addr);
+}
+
+// opens the listening socket for addr; returns -1 on failure
+static int serve_listen(char *addr) {
+	int fd;
+	if (serve_port(addr)) {
+		long port = strtol(addr, NULL, 10);
+		if (port < 1 || port > 65535) {
+			printf("Error: invalid port %s\n", addr);
+			return -1;
+		}
+		struct sockaddr_in addr_in = { .sin_family = AF_INET, .sin_port = htons(port),
+															 .sin_addr.s_addr = htonl(INADDR_LOOPBACK) };
+		int on = 1;
+		if ((fd = socket(AF_INET, SOCK_STREAM, 0)) < 0 ||
+				setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on)) != 0 ||
+				bind(fd, (struct sockaddr *) &addr_in, sizeof(addr_in)) != 0) {
+			printf("Error: could not bind to port %s\n", addr);
+			if (fd >= 0) close(fd);
+			return -1;
+		}
+	} else {
+		struct sockaddr_un addr_un = { .sun_family = AF_UNIX };
+		if (strlen(addr) >= sizeof(addr_un.sun_path)) {
+			printf("Error: socket path %s is too long\n", addr);
+			return -1;
+		}
+		strcpy(addr_un.sun_path, addr);
+		unlink(addr);              // left by a server that was killed
+		if ((fd = socket(AF_UNIX, SOCK_STREAM, 0)) < 0 || bind(fd, (struct sockaddr *) &addr_un, sizeof(addr_un)) != 0) {
+			printf("Error: could not bind to socket %s\n", addr);
+			if (fd >= 0) close(fd);
+			return -1;
+		}
+	}
+	if (listen(fd, SERVE_BACKLOG) != 0) {
+		printf("Error: could not listen on %s\n", addr);
+		close(fd);
+		return -1;
+	}
+	return fd;
+}
+
+/*
+ * client_t -- a connection to a client. The server thread reads what
+ * the client sends into buf and hands its queries to the workers a
+ * line at a time. While a worker answers one, the client is busy: it
+ * is not read from, and gets no other query answered, so its answers
+ * go back in order, and no client holds a worker while it is idle.
+ */
+typedef struct client {
+	int fd;
+	char *buf;              // read, and not yet handed to a worker
+	size_t len;
+	size_t capacity;
+	size_t skipped;         // characters of a line too long to keep; 0 if none
+	bool busy;              // a worker is answering one of its queries
+	bool hungup;            // nothing more is to be read from it
+	bool failed;            // an answer could not be sent
+} client_t;
+
+// request_t -- a query of a client, for a worker to answer
+typedef struct request {
+	client_t *client;
+	char *line;             // NULL for a line too long to answer
+	size_t length;          // of the line, in characters
+} request_t;
+
+static int serve_done[2];     // a pipe on which workers hand back the clients they are done with
+
+// writes the len bytes of buf to fd; false if they could not all be sent
+static bool send_all(int fd, const char *buf, size_t len) {
+	while (len > 0) {
+		ssize_t sent = write(fd, buf, len);
+		if (sent < 0 && errno == EINTR) continue;
+		if (sent <= 0) return false;
+		buf += sent;
+		len -= sent;
+	}
+	return true;
+}
+
+/*
+ * serve_request -- answers a query of a client; false if the answer
+ * could not be sent. An answer is what a query file gets, followed by
+ * the line "time: <ms> ms", the time taken to answer, and an empty
+ * line. A line longer than a query file may hold is answered "[query
+ * too long]", whole, rather than split into several queries.
+ */
+static bool serve_request(request_t *rp) {
+	char *answer = NULL;
+	size_t size = 0;
+	FILE *out = open_memstream(&answer, &size);
+	if (out == NULL) return false;
+
+	char query[LINE_LEN];
+	if (rp->line == NULL) sprintf(query, "(%zu characters)", rp->length);
+	else strcpy(query, rp->line);
+	query[strcspn(query, "\r\n")] = '\0';
+
+	struct timespec start, end;
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	if (rp->line == NULL) fprintf(out, "[query too long]\n");
+	else answer_query(rp->line, out);
+	clock_gettime(CLOCK_MONOTONIC, &end);
+	double ms = (end.tv_sec - start.tv_sec) * 1e3 + (end.tv_nsec - start.tv_nsec) / 1e6;
+	fprintf(out, "time: %.3f ms\n\n", ms);
+
+	bool sent = fclose(out) == 0 && send_all(rp->client->fd, answer, size);
+	free(answer);
+	if (sent) printf("Answered '%s' in %.3f ms\n", query, ms);
+	return sent;
+}
+
+// answers requests until the queue is shut down and drained
+static void *serve_worker(void *arg) {
+	bqueue_t *requests = (bqueue_t *) arg;
+	request_t *rp;
+	while ((rp = bqget(requests)) != NULL) {
+		if (!serve_request(rp)) rp->client->failed = true;
+		if (write(serve_done[1], &rp->client, sizeof(client_t *)) != sizeof(client_t *)) {
+			printf("Error: could not hand back a client\n");
+		}
+		free(rp->line);
+		free(rp);
+	}
+	return NULL;
+}
+
+/*
+ * next_request -- hands the next whole line the client sent, or its
+ * last one once it has hung up, to the workers; returns false if it
+ * has none. Of a line too long to answer, only the length is kept.
+ */
+static bool next_request(client_t *cp, bqueue_t *requests) {
+	char *nl = memchr(cp->buf, '\n', cp->len);
+	size_t len = nl != NULL ? (size_t) (nl - cp->buf) + 1 : cp->len;
+	if (nl == NULL && !(cp->hungup && cp->len + cp->skipped > 0)) {
+		if (cp->len >= LINE_LEN) {          // the line is too long already; the rest of it is only counted
+			cp->skipped += cp->len;
+			cp->len = 0;
+		}
+		return false;
+	}
+
+	request_t *rp = malloc(sizeof(request_t));
+	if (rp == NULL) {
+		printf("Error: failed malloc call\n");
+		exit(EXIT_FAILURE);
+	}
+	*rp = (request_t) { .client = cp, .length = cp->skipped + len };
+	if (rp->length < LINE_LEN && (rp->line = malloc(len + 1)) != NULL) {
+		memcpy(rp->line, cp->buf, len);
+		rp->line[len] = '\0';
+	}
+	memmove(cp->buf, cp->buf + len, cp->len - len);
+	cp->len -= len;
+	cp->skipped = 0;
+	cp->busy = true;
+	bqput(requests, rp);
+	return true;
+}
+
+// reads what the client has sent; false if it has hung up
+static bool read_client(client_t *cp) {
+	if (cp->capacity - cp->len < 4096) {
+		char *buf = realloc(cp->buf, cp->capacity + 4096);
+		if (buf == NULL) return false;
+		cp->buf = buf;
+		cp->capacity += 4096;
+	}
+	ssize_t n = read(cp->fd, cp->buf + cp->len, cp->capacity - cp->len);
+	if (n < 0 && errno == EINTR) return true;
+	if (n <= 0) return false;
+	cp->len += n;
+	return true;
+}
+
+// whether the client is done with: hung up with nothing left to answer, or failed
+static bool client_done(client_t *cp) {
+	return !cp->busy && (cp->failed || (cp->hungup && cp->len == 0 && cp->skipped == 0));
+}
+
+static void close_client(client_t *cp) {
+	close(cp->fd);
+	free(cp->buf);
+	free(cp);
+}
+
+/*
+ * run_server -- answers the clients connecting to addr, a localhost
+ * port or a unix socket, with the index loaded once for all of them.
+ * This thread accepts the clients and polls them all; each query it
+ * reads is answered by one of nthreads workers, so idle clients hold
+ * no thread. Serves until interrupted; the workers then finish the
+ * answers they are sending, the queries still queued are dropped, the
+ * connections are closed and the socket is removed.
+ */
+static void run_server(char *addr, int nthreads) {
+	int lfd = serve_listen(addr);
+	if (lfd < 0) exit(EXIT_FAILURE);
+
+	// poll is interrupted by a signal to stop; only this thread takes it
+	struct sigaction sa = { .sa_handler = stop_serving };
+	sigemptyset(&sa.sa_mask);
+	sigaction(SIGINT, &sa, NULL);
+	sigaction(SIGTERM, &sa, NULL);
+	signal(SIGPIPE, SIG_IGN);     // a client hanging up fails the write instead
+	sigset_t stops;
+	sigemptyset(&stops);
+	sigaddset(&stops, SIGINT);
+	sigaddset(&stops, SIGTERM);
+
+	bqueue_t *requests = bqopen(SERVE_BACKLOG);
+	if (requests == NULL || pipe(serve_done) != 0) {
+		printf("Error: could not create request queue\n");
+		exit(EXIT_FAILURE);
+	}
+	pthread_t threads[MAX_THREADS];
+	pthread_sigmask(SIG_BLOCK, &stops, NULL);
+	for (int t = 0; t < nthreads; t++) {
+		if (pthread_create(&threads[t], NULL, serve_worker, requests) != 0) {
+			printf("Error: could not start query thread %d\n", t);
+			exit(EXIT_FAILURE);
+		}
+	}
+	pthread_sigmask(SIG_UNBLOCK, &stops, NULL);
+	printf("Serving queries on %s with %d threads\n", addr, nthreads);
+	fflush(stdout);
+
+	int nclients = 0, capacity = 64;
+	client_t **clients = malloc(capacity * sizeof(client_t *));
+	struct pollfd *fds = malloc(capacity * sizeof(struct pollfd));
+	if (clients == NULL || fds == NULL) {
+		printf("Error: failed malloc call\n");
+		exit(EXIT_FAILURE);
+	}
+	while (serving) {
+		// the listening socket, the pipe of clients handed back, then every idle client
+		int nfds = 2;
+		fds[0] = (struct pollfd) { .fd = lfd, .events = POLLIN };
+		fds[1] = (struct pollfd) { .fd = serve_done[0], .events = POLLIN };
+		for (int c = 0; c < nclients; c++) {
+			fds[nfds++] = (struct pollfd) { .fd = clients[c]->busy || clients[c]->hungup ? -1 : clients[c]->fd,
+																			.events = POLLIN };
+		}
+		if (poll(fds, nfds, -1) < 0) {
+			if (errno != EINTR) printf("Error: poll failed\n");
+			continue;
+		}
+
+		for (int c = 0; c < nclients; c++) {
+			client_t *cp = clients[c];
+			if (fds[c + 2].revents != 0 && !read_client(cp)) cp->hungup = true;
+			if (fds[c + 2].revents != 0) next_request(cp, requests);
+		}
+		if (fds[1].revents & POLLIN) {
+			client_t *done[64];
+			ssize_t n = read(serve_done[0], done, sizeof(done));
+			for (int d = 0; d < n / (ssize_t) sizeof(client_t *); d++) {
+				done[d]->busy = false;
+				if (!done[d]->failed) next_request(done[d], requests);
+			}
+		}
+		int kept = 0;
+		for (int c = 0; c < nclients; c++) {
+			if (client_done(clients[c])) close_client(clients[c]);
+			else clients[kept++] = clients[c];
+		}
+		nclients = kept;
+
+		if (fds[0].revents & POLLIN) {
+			int fd = accept(lfd, NULL, NULL);
+			if (fd < 0) {
+				if (errno != EINTR) printf("Error: accept failed\n");
+				continue;
+			}
+			if (nclients + 3 > capacity) {
+				capacity *= 2;
+				clients = realloc(clients, capacity * sizeof(client_t *));
+				fds = realloc(fds, capacity * sizeof(struct pollfd));
+			}
+			client_t *cp = calloc(1, sizeof(client_t));
+			if (clients == NULL || fds == NULL || cp == NULL) {
+				printf("Error: failed malloc call\n");
+				exit(EXIT_FAILURE);
+			}
+			// a client that does not read its answers cannot hold a worker for long
+			struct timeval timeout = { .tv_sec = SERVE_SEND_TIMEOUT };
+			setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+			cp->fd = fd;
+			clients[nclients++] = cp;
+		}
+	}
+
+	// the queries still queued are dropped, not answered
+	bqshutdown(requests);
+	request_t *rp;
+	while ((rp = bqget(requests)) != NULL) {
+		free(rp->line);
+		free(rp);
+	}
+	for (int t = 0; t < nthreads; t++) {
+		pthread_join(threads[t], NULL);
+	}
+	bqclose(requests);
+	for (int c = 0; c < nclients; c++) close_client(clients[c]);
+	free(clients);
+	free(fds);
+	close(serve_done[0]);
+	close(serve_done[1]);
+	close(lfd);
+	if (!serve_port(addr)) unlink(addr);
+	printf("Stopped serving on %s\n", addr);
+	exit(EXIT_SUCCESS);
+}
+
+// maps every segment the manifest index_file names; false if one is missing
+static bool map_segments(char *index_file){
+	if ((index_segments = segments_load(index_file)) == NULL) {
+		printf("Error: count not load index file '%s'\n", index_file);
+		exit(EXIT_FAILURE);
+	}
+	index_maps = calloc(index_segments->nsegs > 0 ? index_segments->nsegs : 1, sizeof(indexmap_t *));
+	if (index_maps == NULL) {
+		printf("Error: failed malloc call\n");
+		exit(EXIT_FAILURE);
+	}
+	for (nmaps = 0; nmaps < index_segments->nsegs; nmaps++) {
+		char *segnm = segments_file(index_file, index_segments->segs[nmaps].gen);
+		index_maps[nmaps] = segnm != NULL ? indexmap_open(segnm) : NULL;
+		free(segnm);
+		if (index_maps[nmaps] == NULL) return false;
+	}
+	return true;
+}
+
+/*
+ * map_index -- maps a binary index file, or every segment of a
+ * segmented one; false for an index that has to be loaded instead
+ */
+static bool map_index(char *index_file){
+	if (!segments_exists(index_file)) {
+		indexmap_t *imp = index_is_binary(index_file) ? indexmap_open(index_file) : NULL;
+		if (imp == NULL) return false;
+		index_maps = malloc(sizeof(indexmap_t *));
+		if (index_maps == NULL) {
+			printf("Error: failed malloc call\n");
+			exit(EXIT_FAILURE);
+		}
+		index_maps[nmaps++] = imp;
+		return true;
+	}
+
+	// an update may merge segments away between reading the manifest and mapping them
+	for (int attempt = 0; !map_segments(index_file); attempt++) {
+		for (int m = 0; m < nmaps; m++) indexmap_close(index_maps[m]);
+		free(index_maps);
+		segments_free(index_segments);
+		nmaps = 0;
+		if (attempt == 2) {
+			printf("Error: could not map the segments of index file '%s'\n", index_file);
+			exit(EXIT_FAILURE);
+		}
+	}
+	return true;
+}
+
 int main(int argc, char *argv[]) {
 	if (argc < 3){
-		printf("usage: query <pageDir> <indexFile> [-q]\n");
+		printf("%s", usage);
 		exit(EXIT_FAILURE);
 	}
 	char line[LINE_LEN];
@@ -418,83 +1502,137 @@ int main(int argc, char *argv[]) {
 	
 	printf("Directory '%s' exists and is accessible.\n", pageDir);
 
+	char *query_file = NULL, *out_file = NULL;
+	int nthreads = 0;                 // to answer a query file, or clients, on; 0 if not given
+	char *serve_addr = NULL;
+	for (int i = 3; i < argc; i++) {
+		if (strcmp(argv[i], "-q") == 0 && i + 2 < argc) {
+			query_file = argv[++i];
+			out_file = argv[++i];
+		} else if (strcmp(argv[i], "--bm25") == 0) {
+			bm25 = true;
+		} else if (strcmp(argv[i], "-j") == 0 && i + 1 < argc) {
+			char *endptr;
+			errno = 0;
+			nthreads = strtol(argv[++i], &endptr, 10);
+			if (*endptr != '\0' || errno != 0 || nthreads < 1 || nthreads > MAX_THREADS) {
+				printf("%s", usage);
+				printf("Invalid <threads> argument, expected 1 to %d\n", MAX_THREADS);
+				exit(EXIT_FAILURE);
+			}
+		} else if (strcmp(argv[i], "-k") == 0 && i + 1 < argc) {
+			char *endptr;
+			errno = 0;
+			long k = strtol(argv[++i], &endptr, 10);
+			if (*endptr != '\0' || errno != 0 || k < 1 || k > INT_MAX / (long) sizeof(result_t)) {
+				printf("%s", usage);
+				printf("Invalid <results> argument, expected a positive number\n");
+				exit(EXIT_FAILURE);
+			}
+			top_k = k;
+		} else if (strcmp(argv[i], "--serve") == 0 && i + 1 < argc) {
+			serve_addr = argv[++i];
+		} else {
+			printf("%s", usage);
+			exit(EXIT_FAILURE);
+		}
+	}
+
+	if (serve_addr != NULL && query_file != NULL) {
+		printf("%s", usage);
+		printf("A server does not take a query file\n");
+		exit(EXIT_FAILURE);
+	}
+
 	// handle -q quiet mode
-	if (argc == 6 && strcmp(argv[3], "-q") == 0) {
-		query_fp = fopen(argv[4], "r");
+	if (query_file != NULL) {
+		query_fp = fopen(query_file, "r");
 		if (!query_fp){
 			printf("Error opening input file\n");
 			exit(EXIT_FAILURE);
 		}
-		out_fp = fopen(argv[5], "w");
+		out_fp = fopen(out_file, "w");
 		if (!out_fp){
 			printf("Error opening output file\n");
 			fclose(query_fp);
 			exit(EXIT_FAILURE);
 		}
-		freopen(argv[4], "r", stdin); // redirect stdin from query file
+		freopen(query_file, "r", stdin); // redirect stdin from query file
 		quiet = true;
 	}
-	else if (argc > 3){
-		printf("usage: query <pageDir> <indexFile> [-q]\n");
-		exit(EXIT_FAILURE);
-	}
 						
 	
-	// load index file
-	index_table = indexload(index_file);
+	// map a binary or segmented index file; load a text or older one
+	index_table = map_index(index_file) ? hopen(100) : indexload(index_file);
 	if (index_table == NULL) {
 		printf("Error: count not load index file '%s'\n", index_file);
 		exit(EXIT_FAILURE);
 	}
+	if ((word_cache = lhopen(1024)) == NULL) {
+		printf("Error: could not create hash table\n");
+		exit(EXIT_FAILURE);
+	}
 
-	url_map = urlload(pageDir);
-	if (url_map == NULL) {
+	// positions are kept for a whole index, not for segments
+	char *pos_file = posindex_file(index_file);
+	if (pos_file != NULL && nmaps == 1 && index_segments == NULL) index_positions = posindex_open(pos_file);
+	free(pos_file);
+	if (index_positions != NULL && posindex_nterms(index_positions) != indexmap_nterms(index_maps[0])) {
+		printf("Error: the positional index does not match index file '%s'; phrases are off\n", index_file);
+		posindex_close(index_positions);
+		index_positions = NULL;
+	}
+
+	// the docstore next to the index names the pages; without one, every page is read for its url
+	char *docs_file = docstore_file(index_file);
+	doc_store = docs_file != NULL ? docstore_open(docs_file) : NULL;
+	free(docs_file);
+	if (doc_store == NULL) url_map = urlload(pageDir);
+	if (doc_store == NULL && url_map == NULL) {
 		printf("Error: could not load url map\n");
 		exit(EXIT_FAILURE);
 	}
+	if (bm25 && doc_store == NULL) {
+		printf("Error: BM25 ranking needs the docstore of an index built with document statistics\n");
+		exit(EXIT_FAILURE);
+	}
+	if (docstore_ndocs(doc_store) > 0 && docstore_total_terms(doc_store) > 0) {
+		avg_terms = (double) docstore_total_terms(doc_store) / docstore_ndocs(doc_store);
+	}
 
-	while (true) {
-			
-		if (query_fp == stdin){
-			printf("> ");		
-		}
-		
-		if (fgets(line, sizeof(line), stdin) == NULL) {
-			break; 
-		}
-
-		queue_t *query = build_query(line);
-		if (query == NULL) {
-			if (!quiet){
-				printf("[invalid query]\n");
-			}
-			else {
-				fprintf(out_fp, "[invalid query]\n");
-			}
-		} else {
-			final_query = query;
-			if (!quiet){
-				print_query(query);
-				happly(url_map, apply_per_doc_query_rank);
+	// clients are answered by a server, a query file in batches on -j threads, and typed queries one at a time
+	if (serve_addr != NULL) {
+		cache_all = false;
+		run_server(serve_addr, nthreads > 0 ? nthreads : SERVE_THREADS);
+	} else if (quiet && nthreads > 1) {
+		run_batch(stdin, out_fp, nthreads);
+	} else {
+		while (true) {
+			if (query_fp == stdin){
+				printf("> ");		
 			}
-			else {
-				print_query_fp(query);
-				happly(url_map, apply_per_doc_query_rank_fp);
+		
+			if (fgets(line, sizeof(line), stdin) == NULL) {
+				break; 
 			}
 
-			final_query = NULL;
-			qapply(query, cleanup_andseq);
-		  qclose(query); 
-
+			answer_query(line, quiet ? out_fp : stdout);
 		}
-
-		min_count = -1;
 	}
 	
 	happly(index_table, cleanup_index); 
 	hclose(index_table);
-	happly(url_map, cleanup_url);
-	hclose(url_map); 
+	lhapply(word_cache, cleanup_index);
+	lhclose(word_cache);
+	for (int m = 0; m < nmaps; m++) indexmap_close(index_maps[m]);
+	free(index_maps);
+	segments_free(index_segments);
+	if (url_map != NULL) {
+		happly(url_map, cleanup_url);
+		hclose(url_map);
+	}
+	docstore_close(doc_store);
+	posindex_close(index_positions);
 
 	if (query_fp != stdin) fclose(query_fp);
 	if (out_fp != stdout) fclose(out_fp);
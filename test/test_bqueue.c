@@ -0,0 +1,69 @@
+/* 
+ * test_bqueue.c --- 
+ * 
+ * Author: Khaidar Kairbek
+ * Created: 10-18-2026
+ * Version: 1.0
+ * 
+ * Description: verify the bounded queue blocks a fast producer and
+ * delivers every element, in order, to a slow consumer
+ * 
+ */
+
+#include "testutil.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <pthread.h>
+#include <unistd.h>
+#include "bqueue.h"
+
+#define N 100
+#define CAPACITY 4
+
+static int consumed[N];
+static int nconsumed = 0;
+
+void *consumer(void *arg) {
+	bqueue_t *bq = arg;
+	int *val;
+	while ((val = bqget(bq)) != NULL) {
+		if (nconsumed < N) consumed[nconsumed] = *val;
+		nconsumed++;
+		free(val);
+		if (nconsumed % 50 == 0) sleep(1); // let the producer fill up
+	}
+	return NULL;
+}
+
+int main(void) {
+	printf("Running bounded queue test...\n");
+
+	bqueue_t *bq = bqopen(CAPACITY);
+	printf("Putting %d elements through a queue of %d to a slow consumer...\n", N, CAPACITY);
+	pthread_t cons;
+	pthread_create(&cons, NULL, consumer, bq);
+
+	for (int i = 0; i < N; i++) {
+		int *val = malloc(sizeof(int));
+		*val = i;
+		if (bqput(bq, val) != 0) fail("Put: an element was rejected before shutdown");
+	}
+	bqshutdown(bq);
+	pthread_join(cons, NULL);
+
+	printf("Consumed %d of %d elements\n", nconsumed, N);
+	if (nconsumed != N) fail("Get: not every element was delivered");
+	for (int i = 0; i < N; i++) {
+		if (consumed[i] != i) fail("Get: elements came out of order");
+	}
+	printf("Every element was delivered, in order\n");
+
+	int *late = malloc(sizeof(int));
+	if (bqput(bq, late) == 0) fail("Put: an element was accepted after shutdown");
+	free(late);
+	printf("Puts after shutdown are rejected\n");
+
+	bqclose(bq);
+	printf("Bounded queue test complete.\n");
+	exit(EXIT_SUCCESS);
+}
@@ -0,0 +1,116 @@
+/*
+ * test_checkpoint.c ---
+ *
+ * Author: Khaidar Kairbek
+ * Created: 10-18-2026
+ * Version: 1.0
+ *
+ * Description: verify a checkpoint brings back the frontier, the
+ * seen-set and the next id, and that a checkpoint of another version
+ * or one cut off is refused without being removed, so that a failed
+ * --resume can be tried again
+ *
+ */
+
+#define _POSIX_C_SOURCE 200809L   // truncate
+
+#include "testutil.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "checkpoint.h"
+
+#define NPAGES 50
+
+static long file_size(const char *path) {
+	FILE *fp = fopen(path, "rb");
+	if (fp == NULL) return -1;
+	fseek(fp, 0, SEEK_END);
+	long len = ftell(fp);
+	fclose(fp);
+	return len;
+}
+
+int main(void) {
+	printf("Running checkpoint test...\n");
+	char dir[] = "/tmp/test_checkpointXXXXXX";
+	make_temp_dir(dir);
+	char path[64];
+	snprintf(path, sizeof(path), "%s/.checkpoint", dir);
+
+	sched_t *frontier = schedopen(0);
+	urlset_t *seen = urlset_open(0);
+	char url[64];
+	for (int i = 0; i < NPAGES; i++) {
+		sprintf(url, "http://host%d.example.com/%d.html", i % 7, i);
+		urlset_add(seen, url);
+		if (i % 2 == 0) schedput(frontier, webpage_new(url, i % 3, NULL));
+	}
+	if (checkpoint_save(path, frontier, seen, NULL, 42) != 0) fail("Save: checkpoint not written");
+	printf("Saved %d queued pages of %lu seen urls\n", schedsize(frontier), (unsigned long) urlset_size(seen));
+
+	// a path whose temporary name does not fit is refused, not truncated
+	char long_path[300];
+	int n = snprintf(long_path, sizeof(long_path), "%s/", dir);
+	while (n < (int) sizeof(long_path) - 3) n += sprintf(long_path + n, "./");
+	strcpy(long_path + n, "c");
+	if (checkpoint_save(long_path, frontier, seen, NULL, 42) == 0) fail("Save: a path too long was taken");
+	if (access(long_path, F_OK) == 0) fail("Save: a checkpoint was written under a truncated name");
+	printf("A path too long to name its temporary file is refused\n");
+	schedclose(frontier);
+	urlset_close(seen);
+
+	frontier = schedopen(0);
+	seen = urlset_open(0);
+	int next_id = 0;
+	if (checkpoint_load(path, frontier, seen, NULL, &next_id) != 0) fail("Load: checkpoint refused");
+	printf("Loaded %d queued pages of %lu seen urls, next id %d\n", schedsize(frontier),
+				 (unsigned long) urlset_size(seen), next_id);
+	if (next_id != 42 || schedsize(frontier) != NPAGES / 2 || urlset_size(seen) != NPAGES ||
+			!urlset_contains(seen, "http://host0.example.com/49.html")) {
+		fail("Load: crawl state differs from the one saved");
+	}
+	schedclose(frontier);
+	urlset_close(seen);
+
+	// the version follows the 8-byte magic
+	long len = file_size(path);
+	FILE *fp = fopen(path, "r+b");
+	uint32_t version = 99;
+	fseek(fp, 8, SEEK_SET);
+	fwrite(&version, sizeof(version), 1, fp);
+	fclose(fp);
+	printf("Loading a checkpoint of version %u...\n", version);
+	frontier = schedopen(0);
+	seen = urlset_open(0);
+	if (checkpoint_load(path, frontier, seen, NULL, &next_id) == 0) fail("Load: took a checkpoint of another version");
+	if (schedsize(frontier) != 0 || file_size(path) != len) fail("Load: refused checkpoint was changed");
+	printf("Refused, and left on disk\n");
+	schedclose(frontier);
+	urlset_close(seen);
+
+	// a checkpoint cut off inside the frontier
+	frontier = schedopen(0);
+	seen = urlset_open(0);
+	for (int i = 0; i < NPAGES; i++) {
+		sprintf(url, "http://host%d.example.com/%d.html", i % 7, i);
+		schedput(frontier, webpage_new(url, 0, NULL));
+	}
+	checkpoint_save(path, frontier, seen, NULL, 1);
+	schedclose(frontier);
+	len = file_size(path);
+	if (truncate(path, len - 40) != 0) fail("truncate failed");
+	printf("Loading a checkpoint cut off by 40 bytes...\n");
+	frontier = schedopen(0);
+	if (checkpoint_load(path, frontier, seen, NULL, &next_id) == 0) fail("Load: took a cut-off checkpoint");
+	if (file_size(path) != len - 40) fail("Load: refused checkpoint was changed");
+	printf("Refused, and left on disk\n");
+	schedclose(frontier);
+	urlset_close(seen);
+
+	remove(path);
+	remove(dir);
+	printf("Checkpoint test complete.\n");
+	exit(EXIT_SUCCESS);
+}
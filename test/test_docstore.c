@@ -0,0 +1,98 @@
+/*
+ * test_docstore.c ---
+ *
+ * Author: Khaidar Kairbek
+ * Created: 10-18-2026
+ * Version: 1.0
+ *
+ * Description: verify a docstore finds the url, depth, length and
+ * terms of every page written to it by id, knows the ids with no page,
+ * totals the pages and their terms, and refuses writes out of order
+ * and files it cannot map safely
+ *
+ */
+
+#define _POSIX_C_SOURCE 200809L   // truncate
+
+#include "testutil.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "docstore.h"
+
+#define NPAGES 500
+
+int main(void) {
+	printf("Running docstore test...\n");
+	char dir[] = "/tmp/test_docstoreXXXXXX";
+	make_temp_dir(dir);
+	char indexnm[64];
+	snprintf(indexnm, sizeof(indexnm), "%s/index", dir);
+	char *docsnm = docstore_file(indexnm);
+	if (docsnm == NULL || strcmp(docsnm + strlen(indexnm), ".docs") != 0) fail("File: the docstore is not next to the index");
+	printf("Docstore: %s\n", docsnm);
+
+	// every third id has no page
+	printf("Writing pages 1 to %d, leaving out every third...\n", NPAGES);
+	char url[64];
+	docstore_writer_t *dwp = docstore_writer_open(docsnm);
+	if (dwp == NULL) fail("Writer: did not open");
+	uint64_t ndocs = 0, total_terms = 0;
+	for (int id = 1; id <= NPAGES; id++) {
+		if (id % 3 == 0) continue;
+		sprintf(url, "http://example.com/page%d.html", id);
+		docstore_doc_t doc = { .url = url, .depth = id % 4, .length = 1000 + id, .terms = id / 2 };
+		if (docstore_writer_add(dwp, id, &doc) != 0) fail("Writer: a page was refused");
+		ndocs++;
+		total_terms += id / 2;
+	}
+	if (docstore_writer_close(dwp) != 0) fail("Writer: did not close");
+
+	docstore_t *dsp = docstore_open(docsnm);
+	if (dsp == NULL || docstore_maxid(dsp) != NPAGES) fail("Open: the docstore does not cover the ids written");
+	if (docstore_ndocs(dsp) != ndocs || docstore_total_terms(dsp) != total_terms) fail("Open: wrong totals");
+	printf("Mapped %lu pages of %lu terms in all\n", (unsigned long) docstore_ndocs(dsp),
+				 (unsigned long) docstore_total_terms(dsp));
+
+	docstore_doc_t doc;
+	for (int id = 1; id <= NPAGES; id++) {
+		if (id % 3 == 0) {
+			if (docstore_get(dsp, id, &doc)) fail("Get: an id with no page was found");
+			continue;
+		}
+		sprintf(url, "http://example.com/page%d.html", id);
+		if (!docstore_get(dsp, id, &doc) || strcmp(doc.url, url) != 0 || doc.depth != (uint32_t) id % 4 ||
+				doc.length != (uint32_t) 1000 + id || doc.terms != (uint32_t) id / 2) {
+			fail("Get: a page differs from the one written");
+		}
+	}
+	if (docstore_get(dsp, 0, &doc) || docstore_get(dsp, NPAGES + 1, &doc)) fail("Get: an id out of range was found");
+	printf("Every page is found by id; ids with no page or out of range are not\n");
+	docstore_close(dsp);
+
+	docstore_doc_t a = { .url = "http://a" }, b = { .url = "http://b" };
+	dwp = docstore_writer_open(docsnm);
+	if (docstore_writer_add(dwp, 5, &a) != 0) fail("Writer: a page was refused");
+	if (docstore_writer_add(dwp, 5, &b) == 0) fail("Writer: an id out of order was taken");
+	if (docstore_writer_close(dwp) == 0) fail("Writer: the failure was not reported on close");
+	printf("The writer refuses an id out of order, and fails on close\n");
+
+	dwp = docstore_writer_open(docsnm);
+	docstore_writer_add(dwp, 1, &a);
+	docstore_writer_close(dwp);
+	FILE *fp = fopen(docsnm, "r");
+	fseek(fp, 0, SEEK_END);
+	long len = ftell(fp);
+	fclose(fp);
+	if (truncate(docsnm, len - 4) != 0 || docstore_open(docsnm) != NULL) fail("Open: a cut-off table was mapped");
+	remove(docsnm);
+	if (docstore_open(docsnm) != NULL) fail("Open: a missing docstore was mapped");
+	printf("Cut-off and missing docstores are not mapped\n");
+
+	free(docsnm);
+	remove(dir);
+
+	printf("Docstore test complete.\n");
+	exit(EXIT_SUCCESS);
+}
@@ -0,0 +1,149 @@
+/*
+ * test_indexio.c ---
+ *
+ * Author: Khaidar Kairbek
+ * Created: 10-18-2026
+ * Version: 1.0
+ *
+ * Description: verify posting arrays count repeats in place, grow,
+ * concatenate and search, and survive a save and load of the index in
+ * both the binary and the text format
+ *
+ */
+
+#define _POSIX_C_SOURCE 200809L   // truncate
+
+#include "testutil.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "hash.h"
+#include "varint.h"
+#include "indexio.h"
+
+static bool match_word(void *ep, const void *keyp) {
+	return strcmp(((word_index_t *) ep)->word, (const char *) keyp) == 0;
+}
+
+static void free_record(void *ep) {
+	word_index_free((word_index_t *) ep);
+}
+
+// loads indexnm and compares it with the two words saved in it
+static void check_loaded(char *indexnm, word_index_t *record, const char *format) {
+	hashtable_t *loaded = indexload(indexnm);
+	if (loaded == NULL) fail("Load: the index did not load");
+
+	word_index_t *back = hsearch(loaded, match_word, "pages", 5);
+	if (back == NULL || back->ndocs != record->ndocs) fail("Load: the postings lost their length");
+	if (memcmp(back->docs, record->docs, record->ndocs * sizeof(document_t)) != 0) fail("Load: the postings differ");
+	back = hsearch(loaded, match_word, "tiny", 4);
+	if (back == NULL || back->ndocs != 1 || back->docs[0].id != 4) fail("Load: the second word did not load");
+	printf("The %s index loads back both words and their postings\n", format);
+
+	happly(loaded, free_record);
+	hclose(loaded);
+}
+
+int main(void) {
+	printf("Running index io test...\n");
+	word_index_t *record = word_index_new("pagesXXX", 5);
+	if (record == NULL || strcmp(record->word, "pages") != 0) fail("New: the record copied more than len characters");
+	if (record->ndocs != 0) fail("New: a new record has postings");
+
+	printf("Adding pages 1, 1 and 3...\n");
+	postings_add(record, 1);
+	postings_add(record, 1);
+	postings_add(record, 3);
+	if (record->ndocs != 2) fail("Add: a repeat on the same page added a posting");
+	if (record->docs[0].id != 1 || record->docs[0].count != 2) fail("Add: a repeat did not bump the last count");
+	if (record->docs[1].id != 3 || record->docs[1].count != 1) fail("Add: a new page did not append a posting");
+	printf("A repeat bumps the last count; a new page appends a posting\n");
+
+	for (uint64_t id = 4; id < 1004; id++) postings_add(record, id);
+	if (record->ndocs != 1002 || record->capacity < 1002) fail("Add: the postings did not grow");
+	if (record->docs[1001].id != 1003) fail("Add: the grown postings lost their order");
+	printf("The postings grew to %u, in order\n", record->ndocs);
+
+	word_index_t *tail = word_index_new("pages", 5);
+	postings_append(tail, 2000, 7);
+	postings_append(tail, 2001, 9);
+	if (!postings_concat(record, tail)) fail("Concat: failed");
+	if (record->ndocs != 1004 || record->docs[1003].id != 2001 || record->docs[1003].count != 9) {
+		fail("Concat: the other postings were not appended");
+	}
+	if (tail->ndocs != 2) fail("Concat: the source was changed");
+	word_index_free(tail);
+	printf("Concatenated 2 more postings, leaving their source intact\n");
+
+	if (postings_find(record, 1) == NULL || postings_find(record, 1)->count != 2) fail("Find: missed the first posting");
+	if (postings_find(record, 500) == NULL || postings_find(record, 500)->id != 500) fail("Find: missed a middle posting");
+	if (postings_find(record, 2000) == NULL || postings_find(record, 2000)->count != 7) {
+		fail("Find: missed a concatenated posting");
+	}
+	if (postings_find(record, 2) != NULL || postings_find(record, 5000) != NULL) fail("Find: found a page with no posting");
+	printf("Find hits the first, middle and concatenated postings, and misses gaps\n");
+
+	char dir[] = "/tmp/test_indexioXXXXXX";
+	make_temp_dir(dir);
+	char indexnm[64];
+	snprintf(indexnm, sizeof(indexnm), "%s/index", dir);
+
+	hashtable_t *htp = hopen(10);
+	hput(htp, record, record->word, strlen(record->word));
+	word_index_t *other = word_index_new("tiny", 4);
+	postings_add(other, 4);
+	hput(htp, other, other->word, strlen(other->word));
+	if (indexsave(htp, indexnm) != 0) fail("Save: the binary index did not save");
+	if (!index_is_binary(indexnm)) fail("Save: the binary index is not recognized");
+	check_loaded(indexnm, record, "binary");
+
+	FILE *fp = fopen(indexnm, "r");
+	fseek(fp, 0, SEEK_END);
+	long binary_len = ftell(fp);
+	fclose(fp);
+
+	if (indexsave_text(htp, indexnm) != 0) fail("Save: the text index did not save");
+	if (index_is_binary(indexnm)) fail("Save: the text index is taken for a binary one");
+	check_loaded(indexnm, record, "text");
+
+	fp = fopen(indexnm, "r");
+	fseek(fp, 0, SEEK_END);
+	long text_len = ftell(fp);
+	fclose(fp);
+	printf("Binary index: %ld bytes; text index: %ld bytes\n", binary_len, text_len);
+	if (binary_len * 2 >= text_len) fail("Save: the binary index is not under half the size of the text one");
+
+	indexwriter_t *iwp = indexwriter_open(indexnm);
+	if (indexwriter_add(iwp, "tiny", other->docs, other->ndocs) != 0) fail("Writer: a term was refused");
+	if (indexwriter_add(iwp, "pages", record->docs, record->ndocs) == 0) fail("Writer: a term out of order was taken");
+	if (indexwriter_close(iwp) == 0) fail("Writer: the failure was not reported on close");
+	printf("The writer refuses a term out of order, and fails on close\n");
+
+	// a binary index cut short must not load
+	indexsave(htp, indexnm);
+	if (truncate(indexnm, binary_len - 3) != 0 || indexload(indexnm) != NULL) fail("Load: a truncated index loaded");
+	printf("A truncated index does not load\n");
+
+	uint8_t buf[VARINT_MAX_LEN];
+	uint64_t values[] = { 0, 1, 127, 128, 16383, 16384, UINT32_MAX, UINT64_MAX };
+	for (int i = 0; i < 8; i++) {
+		uint64_t v;
+		int n = varint_put(buf, values[i]);
+		if (varint_get(buf, buf + n, &v) != n || v != values[i]) fail("Varint: a value did not round trip");
+		if (varint_get(buf, buf + n - 1, &v) != 0) fail("Varint: a truncated varint was read");
+	}
+	if (varint_put(buf, 127) != 1 || varint_put(buf, 128) != 2 || varint_put(buf, UINT64_MAX) != VARINT_MAX_LEN) {
+		fail("Varint: wrong lengths");
+	}
+	printf("Varints round trip, take the expected lengths and detect truncation\n");
+
+	happly(htp, free_record);
+	hclose(htp);
+	remove(indexnm);
+	remove(dir);
+
+	printf("Index io test complete.\n");
+	exit(EXIT_SUCCESS);
+}
@@ -0,0 +1,153 @@
+/*
+ * test_indexmap.c ---
+ *
+ * Author: Khaidar Kairbek
+ * Created: 10-18-2026
+ * Version: 1.0
+ *
+ * Description: verify a mapped index finds every saved word, and only
+ * those, numbers them in order, finds the range of terms with a
+ * prefix, walks their postings as saved, and refuses files it cannot
+ * map safely
+ *
+ */
+
+#define _POSIX_C_SOURCE 200809L   // truncate
+
+#include "testutil.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "hash.h"
+#include "indexio.h"
+#include "indexmap.h"
+
+#define NWORDS 300
+
+static void free_record(void *ep) {
+	word_index_free((word_index_t *) ep);
+}
+
+// word i has postings i + 1, 2(i + 1), ... up to 1000, each counted i + 1 times
+static word_index_t *make_word(int i) {
+	char word[16];
+	int len = sprintf(word, "w%d", i);
+	word_index_t *record = word_index_new(word, len);
+	for (uint64_t id = i + 1; id <= 1000; id += i + 1) {
+		postings_append(record, id, i + 1);
+	}
+	return record;
+}
+
+int main(void) {
+	printf("Running index map test...\n");
+	char dir[] = "/tmp/test_indexmapXXXXXX";
+	make_temp_dir(dir);
+	char indexnm[64];
+	snprintf(indexnm, sizeof(indexnm), "%s/index", dir);
+
+	hashtable_t *htp = hopen(100);
+	for (int i = 0; i < NWORDS; i++) {
+		word_index_t *record = make_word(i);
+		hput(htp, record, record->word, strlen(record->word));
+	}
+	// prefixes of each other, to check the term order
+	const char *nested[] = { "page", "pages", "pagesx" };
+	for (int i = 0; i < 3; i++) {
+		word_index_t *record = word_index_new(nested[i], strlen(nested[i]));
+		postings_append(record, i + 1, 1);
+		hput(htp, record, record->word, strlen(record->word));
+	}
+	if (indexsave(htp, indexnm) != 0) fail("Save: the index did not save");
+
+	indexmap_t *imp = indexmap_open(indexnm);
+	if (imp == NULL) fail("Open: the index did not map");
+	if (indexmap_nterms(imp) != NWORDS + 3) fail("Open: wrong number of terms");
+	printf("Mapped an index of %lu terms\n", (unsigned long) indexmap_nterms(imp));
+
+	char word[16];
+	for (int i = 0; i < NWORDS; i++) {
+		int len = sprintf(word, "w%d", i);
+		int64_t t = indexmap_find(imp, word, len);
+		char *term = indexmap_term(imp, t);
+		if (t < 0 || term == NULL || strcmp(term, word) != 0) fail("Find: a saved word was not found");
+		free(term);
+
+		indexmap_iter_t it;
+		uint64_t id = i + 1;
+		if (!indexmap_postings(imp, t, &it) || it.ndocs != 1000 / (i + 1)) fail("Postings: wrong number of postings");
+		while (indexmap_next(&it)) {
+			if (it.id != id || it.count != (uint64_t) i + 1) fail("Postings: a posting differs from the saved one");
+			id += i + 1;
+		}
+		if (it.remaining != 0 || id <= 1000) fail("Postings: the walk stopped short");
+	}
+	printf("Every word is found, and its postings walk as saved\n");
+
+	for (int i = 0; i < 3; i++) {
+		word_index_t *record = indexmap_record(imp, indexmap_find(imp, nested[i], strlen(nested[i])));
+		if (record == NULL || strcmp(record->word, nested[i]) != 0 || record->ndocs != 1 ||
+				record->docs[0].id != (uint64_t) i + 1) {
+			fail("Find: words that are prefixes of each other were mixed up");
+		}
+		word_index_free(record);
+	}
+	if (indexmap_find(imp, "pag", 3) != -1 || indexmap_find(imp, "pagesxx", 7) != -1 ||
+			indexmap_find(imp, "a", 1) != -1 || indexmap_find(imp, "zzz", 3) != -1) {
+		fail("Find: an absent word was found");
+	}
+	if (indexmap_term(imp, NWORDS + 3) != NULL || indexmap_term(imp, -1) != NULL) fail("Term: a term out of range was given");
+	printf("page, pages and pagesx are told apart; absent words are not found\n");
+
+	char *previous = indexmap_term(imp, 0);
+	for (int64_t t = 1; t < NWORDS + 3; t++) {
+		char *term = indexmap_term(imp, t);
+		if (term == NULL || previous == NULL || strcmp(previous, term) >= 0) fail("Term: terms are not in strcmp order");
+		free(previous);
+		previous = term;
+	}
+	free(previous);
+	printf("Terms are numbered in strcmp order\n");
+
+	// w1, w10 to w19, and w100 to w199
+	int64_t first, last;
+	if (!indexmap_prefix(imp, "w1", 2, &first, &last) || last - first != 111) fail("Prefix: wrong range for w1");
+	for (int64_t t = first; t < last; t++) {
+		char *term = indexmap_term(imp, t);
+		if (term == NULL || strncmp(term, "w1", 2) != 0) fail("Prefix: a term in the range lacks the prefix");
+		free(term);
+	}
+	printf("Prefix w1 covers terms %ld to %ld\n", (long) first, (long) last - 1);
+	if (!indexmap_prefix(imp, "w", 1, &first, &last) || first != 3 || last != NWORDS + 3) fail("Prefix: wrong range at the end");
+	if (!indexmap_prefix(imp, "pages", 5, &first, &last) || first != 1 || last != 3) fail("Prefix: wrong range at the start");
+	if (!indexmap_prefix(imp, "", 0, &first, &last) || first != 0 || last != NWORDS + 3) {
+		fail("Prefix: the empty prefix does not cover every term");
+	}
+	if (indexmap_prefix(imp, "w1x", 3, &first, &last) || indexmap_prefix(imp, "zz", 2, &first, &last) ||
+			indexmap_prefix(imp, "a", 1, &first, &last)) {
+		fail("Prefix: a prefix of no term gave a range");
+	}
+	printf("Prefix ranges hold at the start and end; a prefix of no term has none\n");
+	indexmap_close(imp);
+
+	// a text index is not mapped
+	if (indexsave_text(htp, indexnm) != 0 || indexmap_open(indexnm) != NULL) fail("Open: a text index was mapped");
+
+	// a cut-off table is refused rather than followed
+	indexsave(htp, indexnm);
+	FILE *fp = fopen(indexnm, "r");
+	fseek(fp, 0, SEEK_END);
+	long len = ftell(fp);
+	fclose(fp);
+	if (truncate(indexnm, len - 8) != 0 || indexmap_open(indexnm) != NULL) fail("Open: a truncated index was mapped");
+	printf("Text and truncated indexes are not mapped\n");
+
+	happly(htp, free_record);
+	hclose(htp);
+	remove(indexnm);
+	remove(dir);
+
+	printf("Index map test complete.\n");
+	exit(EXIT_SUCCESS);
+}
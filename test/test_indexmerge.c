@@ -0,0 +1,199 @@
+/*
+ * test_indexmerge.c ---
+ *
+ * Author: Khaidar Kairbek
+ * Created: 10-18-2026
+ * Version: 1.0
+ *
+ * Description: verify merging binary indexes keeps every term once, in
+ * order, joins the postings of a term found in several inputs in input
+ * order, streams long posting lists through, merges interleaved inputs
+ * by id when keeping live postings only, and refuses inputs that are
+ * missing or out of order
+ *
+ */
+
+#include "testutil.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "indexio.h"
+#include "indexmap.h"
+#include "indexmerge.h"
+
+#define NINPUTS 3
+#define NWORDS 200
+#define LONG_LIST 200000   // postings per input of the long term
+
+// input n holds the words w<i> with i % (n + 1) == 0, on page 1000n + i
+static int32_t write_input(char *indexnm, int n) {
+	char words[NWORDS][16];
+	for (int i = 0; i < NWORDS; i++) sprintf(words[i], "w%03d", i);
+
+	indexwriter_t *iwp = indexwriter_open(indexnm);
+	if (iwp == NULL) return -1;
+	for (int i = 0; i < NWORDS; i += n + 1) {
+		document_t doc = { .id = 1000 * n + i, .count = n + 1 };
+		indexwriter_add(iwp, words[i], &doc, 1);
+	}
+	return indexwriter_close(iwp);
+}
+
+// input n holds "long" on LONG_LIST pages from n * LONG_LIST + 1, and "tail" on its last page
+static int32_t write_long_input(char *indexnm, int n) {
+	indexwriter_t *iwp = indexwriter_open(indexnm);
+	if (iwp == NULL) return -1;
+	uint64_t first = (uint64_t) n * LONG_LIST + 1;
+	indexwriter_begin(iwp, "long");
+	for (uint64_t id = first; id < first + LONG_LIST; id++) indexwriter_posting(iwp, id, id % 7 + 1);
+	indexwriter_end(iwp);
+	document_t doc = { .id = first + LONG_LIST - 1, .count = 1 };
+	indexwriter_add(iwp, "tail", &doc, 1);
+	return indexwriter_close(iwp);
+}
+
+// input 0 holds "both" on every page up to 2N + 1, input 1 on the odd pages from 3;
+// both hold "gone" on page 1
+static int32_t write_interleaved_input(char *indexnm, int n) {
+	indexwriter_t *iwp = indexwriter_open(indexnm);
+	if (iwp == NULL) return -1;
+	indexwriter_begin(iwp, "both");
+	for (uint64_t id = n == 0 ? 1 : 3; id <= 2 * NWORDS + 1; id += n + 1) indexwriter_posting(iwp, id, n + 1);
+	indexwriter_end(iwp);
+	document_t doc = { .id = 1, .count = 1 };
+	indexwriter_add(iwp, "gone", &doc, 1);
+	return indexwriter_close(iwp);
+}
+
+// even pages are live in input 0, odd ones in input 1, and page 1 in neither
+static bool live_parity(int input, uint64_t id) {
+	return id > 1 && (int) (id % 2) == input;
+}
+
+// no spill files may be left next to an index once it is written
+static bool spills_left(const char *indexnm) {
+	char path[128];
+	snprintf(path, sizeof(path), "%s.lexicon.tmp", indexnm);
+	if (access(path, F_OK) == 0) return true;
+	snprintf(path, sizeof(path), "%s.blocks.tmp", indexnm);
+	return access(path, F_OK) == 0;
+}
+
+int main(void) {
+	printf("Running index merge test...\n");
+	char dir[] = "/tmp/test_indexmergeXXXXXX";
+	make_temp_dir(dir);
+	char names[NINPUTS][64], indexnm[64];
+	char *inputs[NINPUTS];
+	for (int n = 0; n < NINPUTS; n++) {
+		snprintf(names[n], sizeof(names[n]), "%s/run%d", dir, n);
+		inputs[n] = names[n];
+		if (write_input(inputs[n], n) != 0) fail("Write: an input did not save");
+	}
+	snprintf(indexnm, sizeof(indexnm), "%s/index", dir);
+
+	printf("Merging %d inputs of up to %d terms...\n", NINPUTS, NWORDS);
+	if (indexmerge(inputs, NINPUTS, indexnm) != 0) fail("Merge: the inputs did not merge");
+	if (spills_left(indexnm)) fail("Merge: spill files were left behind");
+	indexmap_t *imp = indexmap_open(indexnm);
+	if (imp == NULL || indexmap_nterms(imp) != NWORDS) fail("Merge: a term is missing or repeated");
+
+	for (int i = 0; i < NWORDS; i++) {
+		char word[16];
+		int len = sprintf(word, "w%03d", i);
+		word_index_t *record = indexmap_record(imp, indexmap_find(imp, word, len));
+		if (record == NULL) fail("Merge: a term cannot be read back");
+		uint32_t ndocs = 0;
+		for (int n = 0; n < NINPUTS; n++) {
+			if (i % (n + 1) != 0) continue;
+			if (ndocs >= record->ndocs || record->docs[ndocs].id != (uint64_t) 1000 * n + i ||
+					record->docs[ndocs].count != (uint64_t) n + 1) {
+				fail("Merge: the postings of a shared term are not joined in input order");
+			}
+			ndocs++;
+		}
+		if (record->ndocs != ndocs) fail("Merge: a term has postings it was never given");
+		word_index_free(record);
+	}
+	printf("Every term appears once, with its postings joined in input order\n");
+	indexmap_close(imp);
+
+	if (indexmerge(inputs, 1, indexnm) != 0 || (imp = indexmap_open(indexnm)) == NULL ||
+			indexmap_nterms(imp) != NWORDS) {
+		fail("Merge: a single input did not merge to a copy");
+	}
+	indexmap_close(imp);
+	if (indexmerge(inputs, 0, indexnm) != 0 || (imp = indexmap_open(indexnm)) == NULL ||
+			indexmap_nterms(imp) != 0) {
+		fail("Merge: no inputs did not merge to an empty index");
+	}
+	indexmap_close(imp);
+	printf("A single input merges to a copy; no inputs to an empty index\n");
+
+	// the ids of a later input must follow those of the ones before it
+	char *reversed[] = { inputs[1], inputs[0] };
+	if (indexmerge(reversed, 2, indexnm) == 0) fail("Merge: inputs out of id order were taken");
+	char missing[80];
+	snprintf(missing, sizeof(missing), "%s/missing", dir);
+	char *absent[] = { inputs[0], missing };
+	if (indexmerge(absent, 2, indexnm) == 0) fail("Merge: a missing input was taken");
+	if (spills_left(indexnm)) fail("Merge: a refused merge left spill files behind");
+	printf("Inputs out of id order and missing inputs are refused\n");
+
+	// a posting list far longer than any buffer goes through one posting at a time
+	printf("Merging %d inputs of a term on %d pages each...\n", NINPUTS, LONG_LIST);
+	for (int n = 0; n < NINPUTS; n++) {
+		if (write_long_input(inputs[n], n) != 0) fail("Write: a long input did not save");
+	}
+	if (indexmerge(inputs, NINPUTS, indexnm) != 0) fail("Merge: the long inputs did not merge");
+	if (spills_left(indexnm)) fail("Merge: spill files were left behind");
+	imp = indexmap_open(indexnm);
+	if (imp == NULL || indexmap_nterms(imp) != 2) fail("Merge: the long index has the wrong terms");
+	word_index_t *record = indexmap_record(imp, indexmap_find(imp, "long", 4));
+	if (record == NULL || record->ndocs != NINPUTS * LONG_LIST) fail("Merge: the long term lost postings");
+	for (uint32_t d = 0; d < record->ndocs; d++) {
+		if (record->docs[d].id != d + 1 || record->docs[d].count != (d + 1) % 7 + 1) {
+			fail("Merge: a posting of the long term is wrong");
+		}
+	}
+	word_index_free(record);
+	record = indexmap_record(imp, indexmap_find(imp, "tail", 4));
+	if (record == NULL || record->ndocs != NINPUTS || record->docs[NINPUTS - 1].id != NINPUTS * LONG_LIST) {
+		fail("Merge: the term after the long one is wrong");
+	}
+	word_index_free(record);
+	printf("All %d postings of the long term came through in order\n", NINPUTS * LONG_LIST);
+	indexmap_close(imp);
+
+	// with a live test the inputs may interleave, and are merged by id
+	printf("Merging 2 inputs with interleaved ids, keeping live postings...\n");
+	for (int n = 0; n < 2; n++) {
+		if (write_interleaved_input(inputs[n], n) != 0) fail("Write: an interleaved input did not save");
+	}
+	if (indexmerge(inputs, 2, indexnm) == 0) fail("Merge: interleaved inputs were taken without a live test");
+	if (spills_left(indexnm)) fail("Merge: a refused merge left spill files behind");
+	if (indexmerge_live(inputs, 2, live_parity, indexnm) != 0) fail("Merge: the interleaved inputs did not merge");
+	if (spills_left(indexnm)) fail("Merge: spill files were left behind");
+	imp = indexmap_open(indexnm);
+	if (imp == NULL || indexmap_nterms(imp) != 1) fail("Merge: a term with no live postings was kept");
+	if (indexmap_find(imp, "gone", 4) >= 0) fail("Merge: the dead term \"gone\" was kept");
+	record = indexmap_record(imp, indexmap_find(imp, "both", 4));
+	if (record == NULL || record->ndocs != 2 * NWORDS) fail("Merge: the interleaved term has the wrong postings");
+	for (uint32_t d = 0; d < record->ndocs; d++) {
+		uint64_t id = d + 2;
+		if (record->docs[d].id != id || record->docs[d].count != id % 2 + 1) {
+			fail("Merge: the interleaved postings are not in id order");
+		}
+	}
+	word_index_free(record);
+	printf("Interleaved postings are merged by id; a term with none live is dropped\n");
+	indexmap_close(imp);
+
+	for (int n = 0; n < NINPUTS; n++) remove(inputs[n]);
+	remove(indexnm);
+	remove(dir);
+
+	printf("Index merge test complete.\n");
+	exit(EXIT_SUCCESS);
+}
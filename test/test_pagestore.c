@@ -0,0 +1,200 @@
+/*
+ * test_pagestore.c ---
+ *
+ * Author: Khaidar Kairbek
+ * Created: 10-18-2026
+ * Version: 1.0
+ *
+ * Description: verify pages packed into a page store load back by id,
+ * survive reopening, convert to and from page files, and that urls too
+ * long for a record and records cut off or corrupt are refused
+ *
+ */
+
+#define _POSIX_C_SOURCE 200809L   // pwrite, truncate
+
+#include "testutil.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include "webpage.h"
+#include "pageio.h"
+#include "pagestore.h"
+
+#define N 50
+#define LONG_URL_LEN 70000
+
+static webpage_t *make_page(int id, const char *tag) {
+	char url[100], html[200];
+	sprintf(url, "https://thayer.github.io/engs50/page%d.html", id);
+	sprintf(html, "<html><body>%s page %d\n<a href=\"x\">x</a></body></html>", tag, id);
+	char *h = malloc(strlen(html) + 1);
+	strcpy(h, html);
+	return webpage_new(url, id % 4, h);
+}
+
+static bool same_page(webpage_t *a, webpage_t *b) {
+	return a != NULL && b != NULL &&
+		strcmp(webpage_getURL(a), webpage_getURL(b)) == 0 &&
+		webpage_getDepth(a) == webpage_getDepth(b) &&
+		webpage_getHTMLlen(a) == webpage_getHTMLlen(b) &&
+		strcmp(webpage_getHTML(a), webpage_getHTML(b)) == 0;
+}
+
+static bool all_pages_match(pagestore_t *ps, const char *tag) {
+	for (int id = 1; id <= N; id++) {
+		webpage_t *want = make_page(id, tag);
+		webpage_t *got = pagestore_load(ps, id);
+		bool ok = same_page(want, got);
+		webpage_delete(want);
+		webpage_delete(got);
+		if (!ok) return false;
+	}
+	return true;
+}
+
+// where the record of id starts in pages.dat, from its entry in pages.idx
+static uint64_t record_offset(const char *dir, int id) {
+	char path[300];
+	sprintf(path, "%s/pages.idx", dir);
+	uint64_t offset = 0;
+	int fd = open(path, O_RDONLY);
+	if (fd < 0 || pread(fd, &offset, sizeof(offset), 16 + (id - 1) * 16) != sizeof(offset)) fail("cannot read pages.idx");
+	close(fd);
+	return offset;
+}
+
+// overwrites len bytes of pages.dat at offset
+static void poke(const char *dir, uint64_t offset, const void *bytes, size_t len) {
+	char path[300];
+	sprintf(path, "%s/pages.dat", dir);
+	int fd = open(path, O_WRONLY);
+	if (fd < 0 || pwrite(fd, bytes, len, offset) != (ssize_t) len) fail("cannot write pages.dat");
+	close(fd);
+}
+
+int main(void) {
+	printf("Running page store test...\n");
+	char dir[] = "/tmp/test_pagestoreXXXXXX";
+	make_temp_dir(dir);
+
+	if (pagestore_exists(dir)) fail("Exists: an empty directory has a store");
+	if (pagestore_open(dir, false) != NULL) fail("Open: read-only open of a missing store succeeded");
+
+	// ids saved out of order, with a hole at N+2
+	printf("Saving pages %d down to 1, then %d...\n", N, N + 3);
+	pagestore_t *ps = pagestore_open(dir, true);
+	for (int id = N; id >= 1; id--) {
+		webpage_t *page = make_page(id, "first");
+		pagestore_save(ps, page, id);
+		webpage_delete(page);
+	}
+	webpage_t *last = make_page(N + 3, "first");
+	pagestore_save(ps, last, N + 3);
+	webpage_delete(last);
+	if (pagestore_maxid(ps) != N + 3) fail("Maxid: not the highest saved id");
+	if (!all_pages_match(ps, "first")) fail("Load: a page differs from the one saved");
+	if (pagestore_load(ps, N + 2) != NULL || pagestore_load(ps, N + 4) != NULL) fail("Load: an id without a page loaded");
+	printf("Pages load back by id; ids without a page load nothing\n");
+	pagestore_close(ps);
+
+	ps = pagestore_open(dir, false);
+	if (ps == NULL || pagestore_maxid(ps) != N + 3) fail("Open: the store did not reopen");
+	if (!all_pages_match(ps, "first")) fail("Load: a page differs after reopening");
+	char *url = pagestore_url(ps, 7);
+	if (url == NULL || strcmp(url, "https://thayer.github.io/engs50/page7.html") != 0) fail("Url: wrong url for page 7");
+	printf("Reopened; page 7 is %s\n", url);
+	free(url);
+	webpage_t *page = make_page(1, "x");
+	if (pagestore_save(ps, page, 1) == 0) fail("Save: a read-only store took a page");
+	webpage_delete(page);
+	pagestore_close(ps);
+
+	// saving over an id replaces the page
+	ps = pagestore_open(dir, true);
+	for (int id = 1; id <= N; id++) {
+		webpage_t *page = make_page(id, "second");
+		pagestore_save(ps, page, id);
+		webpage_delete(page);
+	}
+	if (!all_pages_match(ps, "second")) fail("Save: saving again did not replace the pages");
+	printf("Saving again replaces pages\n");
+	pagestore_close(ps);
+
+	// export to page files, then pack them into a fresh store
+	if (pagestore_export(dir) != N + 1) fail("Export: not every page was written");
+	page = pageload(5, dir);
+	webpage_t *want = make_page(5, "second");
+	if (!same_page(page, want)) fail("Export: page file 5 differs");
+	webpage_delete(page);
+	webpage_delete(want);
+
+	char path[300];
+	sprintf(path, "%s/pages.dat", dir);
+	unlink(path);
+	sprintf(path, "%s/pages.idx", dir);
+	unlink(path);
+	if (pagestore_import(dir) != N + 1) fail("Import: not every page file was packed");
+	ps = pagestore_open(dir, false);
+	if (!all_pages_match(ps, "second")) fail("Import: a page differs");
+	printf("Exported %d page files and packed them again\n", N + 1);
+	pagestore_close(ps);
+
+	// a url a record cannot hold is refused, not cut short
+	char *long_url = malloc(LONG_URL_LEN + 1);
+	strcpy(long_url, "https://thayer.github.io/");
+	memset(long_url + strlen(long_url), 'x', LONG_URL_LEN - strlen(long_url));
+	long_url[LONG_URL_LEN] = '\0';
+	ps = pagestore_open(dir, true);
+	page = webpage_new(long_url, 0, NULL);
+	printf("Saving a page with a %d byte url...\n", LONG_URL_LEN);
+	if (pagestore_save(ps, page, N + 10) == 0 || pagestore_load(ps, N + 10) != NULL) fail("Save: took a url too long");
+	webpage_delete(page);
+	free(long_url);
+	pagestore_close(ps);
+
+	// records whose lengths run past their end
+	printf("Corrupting the url length of page 3 and the html length of page 4...\n");
+	uint16_t url_len = 60000;
+	poke(dir, record_offset(dir, 3), &url_len, sizeof(url_len));
+	uint32_t html_len = 1 << 30;
+	webpage_t *p4 = make_page(4, "second");
+	poke(dir, record_offset(dir, 4) + sizeof(uint16_t) + strlen(webpage_getURL(p4)) + sizeof(uint32_t),
+			 &html_len, sizeof(html_len));
+	webpage_delete(p4);
+	ps = pagestore_open(dir, false);
+	if (pagestore_load(ps, 3) != NULL || pagestore_url(ps, 3) != NULL) fail("Load: took a url running past its record");
+	if (pagestore_load(ps, 4) != NULL) fail("Load: took html running past its record");
+	page = pagestore_load(ps, 5);
+	if (page == NULL) fail("Load: a sound page next to corrupt ones did not load");
+	webpage_delete(page);
+	printf("Corrupt pages are refused; their neighbours still load\n");
+	pagestore_close(ps);
+
+	// a data file cut off in the middle of the last record
+	sprintf(path, "%s/pages.dat", dir);
+	struct stat st;
+	stat(path, &st);
+	if (truncate(path, st.st_size - 10) != 0) fail("truncate failed");
+	int top = 0;
+	uint64_t top_offset = 0;
+	for (int id = 1; id <= N + 3; id++) {
+		if (id != N + 2 && record_offset(dir, id) >= top_offset) {
+			top_offset = record_offset(dir, id);
+			top = id;
+		}
+	}
+	printf("Cutting 10 bytes off the record of page %d...\n", top);
+	ps = pagestore_open(dir, false);
+	if (pagestore_load(ps, top) != NULL || pagestore_url(ps, top) != NULL) fail("Load: took a cut-off page");
+	pagestore_close(ps);
+	printf("The cut-off page is refused\n");
+
+	if (remove_dir(dir) != 0) fail("Cleanup: the store directory was not removed");
+
+	printf("Page store test complete.\n");
+	exit(EXIT_SUCCESS);
+}
@@ -0,0 +1,205 @@
+/*
+ * test_posindex.c ---
+ *
+ * Author: Khaidar Kairbek
+ * Created: 10-18-2026
+ * Version: 1.0
+ *
+ * Description: verify positions recorded with the postings of an index
+ * are saved in a positional index of their own, term by term in the
+ * order of the index, read back posting by posting, follow their
+ * postings through a concatenation, that a cut-off positional index
+ * is not mapped, and that phrases are matched in time linear in their
+ * positions, even with a repeated word and a large slop
+ *
+ */
+
+#define _POSIX_C_SOURCE 200809L   // truncate
+
+#include "testutil.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "hash.h"
+#include "indexio.h"
+#include "indexmap.h"
+#include "posindex.h"
+
+#define NPAGES 200
+#define MAX_WORDS 8
+#define NTRIALS 2000
+#define REPEATS 20000     // positions of the repeated word
+#define WIDE_SLOP 1000
+
+static void free_record(void *ep) {
+	word_index_free((word_index_t *) ep);
+}
+
+// page id has "even" at positions 0, 2, 4, ... id % 7 + 1 times, and "odd" between them
+static bool add_page(word_index_t *even, word_index_t *odd, uint64_t id) {
+	uint32_t n = id % 7 + 1;
+	for (uint32_t i = 0; i < 2 * n; i++) {
+		word_index_t *record = i % 2 == 0 ? even : odd;
+		if (!postings_add(record, id) || !positions_add(record, i)) return false;
+	}
+	return true;
+}
+
+// whether the positions of the postings of word, walked from the start, are those add_page gave them
+static bool positions_match(indexmap_t *imp, posindex_t *pip, const char *word, uint32_t offset) {
+	int64_t t = indexmap_find(imp, word, strlen(word));
+	word_index_t *record = imp ? indexmap_record(imp, t) : NULL;
+	posindex_iter_t it;
+	if (record == NULL || !posindex_positions(pip, t, &it)) {
+		word_index_free(record);
+		return false;
+	}
+
+	// every third posting is skipped over
+	bool ok = record->ndocs == NPAGES;
+	uint32_t positions[8];
+	for (uint32_t i = 0; ok && i < record->ndocs; i++) {
+		document_t *doc = &record->docs[i];
+		if (i % 3 == 2) {
+			ok = posindex_skip(&it, doc->count);
+			continue;
+		}
+		ok = doc->count == doc->id % 7 + 1 && posindex_read(&it, doc->count, positions);
+		for (uint32_t j = 0; ok && j < doc->count; j++) ok = positions[j] == 2 * j + offset;
+	}
+	word_index_free(record);
+	return ok && it.next == it.end;
+}
+
+// whether, on the page words, the words phrase[i] to phrase[n - 1] follow position prev; by brute force
+static bool follows(const int *words, int len, const int *phrase, int i, int n, int prev, uint32_t slop) {
+	if (i == n) return true;
+	for (int q = prev + 1; q < len && q <= prev + (int) slop + 1; q++) {
+		if (words[q] == phrase[i] && follows(words, len, phrase, i + 1, n, q, slop)) return true;
+	}
+	return false;
+}
+
+// posindex_phrase against brute force on small random pages of a 3-word vocabulary
+static void check_phrases(void) {
+	int words[40], phrase[MAX_WORDS];
+	uint32_t *positions[MAX_WORDS];
+	uint64_t *next[MAX_WORDS], counts[MAX_WORDS];
+	for (int w = 0; w < MAX_WORDS; w++) {
+		positions[w] = malloc(40 * sizeof(uint32_t));
+		next[w] = malloc(41 * sizeof(uint64_t));
+	}
+	srand(25);
+	for (int trial = 0; trial < NTRIALS; trial++) {
+		int len = rand() % 40 + 1, n = rand() % 4 + 2;
+		uint32_t slop = rand() % 4;
+		for (int q = 0; q < len; q++) words[q] = rand() % 3;
+		for (int w = 0; w < n; w++) {
+			phrase[w] = rand() % 3;
+			counts[w] = 0;
+			for (int q = 0; q < len; q++) {
+				if (words[q] == phrase[w]) positions[w][counts[w]++] = q;
+			}
+		}
+		uint64_t want = 0;
+		for (int q = 0; q < len; q++) {
+			if (words[q] == phrase[0] && follows(words, len, phrase, 1, n, q, slop)) want++;
+		}
+		if (posindex_phrase(positions, counts, next, n, slop) != want) fail("Phrase: a match count differs from brute force");
+	}
+	printf("%d random phrases match as brute force counts them\n", NTRIALS);
+	for (int w = 0; w < MAX_WORDS; w++) {
+		free(positions[w]);
+		free(next[w]);
+	}
+
+	// one word over and over, asked for MAX_WORDS times with a wide slop
+	printf("Matching \"a\" %d times with slop %d on a page of %d a's...\n", MAX_WORDS, WIDE_SLOP, REPEATS);
+	uint32_t *all = malloc(REPEATS * sizeof(uint32_t));
+	for (uint32_t q = 0; q < REPEATS; q++) all[q] = q;
+	for (int w = 0; w < MAX_WORDS; w++) {
+		positions[w] = all;
+		counts[w] = REPEATS;
+		next[w] = malloc((REPEATS + 1) * sizeof(uint64_t));
+	}
+	if (posindex_phrase(positions, counts, next, MAX_WORDS, WIDE_SLOP) != REPEATS - MAX_WORDS + 1) {
+		fail("Phrase: the repeated word matched the wrong number of times");
+	}
+	// spread out past the slop, nothing follows
+	for (uint32_t q = 0; q < REPEATS; q++) all[q] = q * (WIDE_SLOP + 2);
+	if (posindex_phrase(positions, counts, next, MAX_WORDS, WIDE_SLOP) != 0) fail("Phrase: words too far apart matched");
+	printf("The repeated word matches once per start, and not at all when spread out\n");
+	for (int w = 0; w < MAX_WORDS; w++) free(next[w]);
+	free(all);
+}
+
+int main(void) {
+	printf("Running positional index test...\n");
+	char dir[] = "/tmp/test_posindexXXXXXX";
+	make_temp_dir(dir);
+	char indexnm[64];
+	snprintf(indexnm, sizeof(indexnm), "%s/index", dir);
+	char *posnm = posindex_file(indexnm);
+	if (posnm == NULL || strcmp(posnm + strlen(indexnm), ".pos") != 0) fail("File: the positional index is not next to the index");
+	printf("Positional index: %s\n", posnm);
+
+	// the second half of the pages is indexed apart, then concatenated
+	word_index_t *even = word_index_new("even", 4), *odd = word_index_new("odd", 3);
+	word_index_t *even2 = word_index_new("even", 4), *odd2 = word_index_new("odd", 3);
+	bool added = true;
+	for (uint64_t id = 1; id <= NPAGES; id++) {
+		added = added && (id <= NPAGES / 2 ? add_page(even, odd, id) : add_page(even2, odd2, id));
+	}
+	if (!added) fail("Add: positions were not added");
+	if (!postings_concat(even, even2) || !postings_concat(odd, odd2)) fail("Concat: positions did not follow their postings");
+	printf("Recorded positions on %d pages, half of them indexed apart and concatenated\n", NPAGES);
+	word_index_free(even2);
+	word_index_free(odd2);
+
+	// a word with no positions still takes its place in the order
+	hashtable_t *htp = hopen(16);
+	word_index_t *plain = word_index_new("middle", 6);
+	postings_append(plain, 1, 1);
+	hput(htp, even, even->word, strlen(even->word));
+	hput(htp, odd, odd->word, strlen(odd->word));
+	hput(htp, plain, plain->word, strlen(plain->word));
+	if (indexsave_positional(&htp, 1, indexnm, posnm) != 0) fail("Save: the index and its positions did not save");
+
+	indexmap_t *imp = indexmap_open(indexnm);
+	posindex_t *pip = posindex_open(posnm);
+	if (pip == NULL || imp == NULL || posindex_nterms(pip) != indexmap_nterms(imp)) fail("Open: the positions do not cover every term");
+	if (!positions_match(imp, pip, "even", 0) || !positions_match(imp, pip, "odd", 1)) {
+		fail("Read: positions do not read back by posting");
+	}
+	printf("Positions of \"even\" and \"odd\" read back posting by posting\n");
+	posindex_iter_t it;
+	if (!posindex_positions(pip, indexmap_find(imp, "middle", 6), &it) || it.next != it.end) {
+		fail("Read: a word saved without positions has some");
+	}
+	if (posindex_positions(pip, 3, &it) || posindex_positions(pip, -1, &it)) fail("Read: a term out of range has positions");
+	printf("A word saved without positions has none; terms out of range have none\n");
+	indexmap_close(imp);
+	posindex_close(pip);
+
+	happly(htp, free_record);
+	hclose(htp);
+
+	FILE *fp = fopen(posnm, "r");
+	fseek(fp, 0, SEEK_END);
+	long len = ftell(fp);
+	fclose(fp);
+	if (truncate(posnm, len - 4) != 0 || posindex_open(posnm) != NULL) fail("Open: a cut-off table was mapped");
+	remove(posnm);
+	if (posindex_open(posnm) != NULL) fail("Open: a missing positional index was mapped");
+	printf("Cut-off and missing positional indexes are not mapped\n");
+
+	remove(indexnm);
+	free(posnm);
+	remove(dir);
+
+	check_phrases();
+
+	printf("Positional index test complete.\n");
+	exit(EXIT_SUCCESS);
+}
@@ -0,0 +1,122 @@
+/*
+ * test_sched.c ---
+ *
+ * Author: Khaidar Kairbek
+ * Created: 10-18-2026
+ * Version: 1.0
+ *
+ * Description: verify the scheduler hands out one page per host at a
+ * time, honours per-host delays, and keeps every page it accepts when
+ * more hosts are ready than its heap first has room for
+ *
+ */
+
+#define _POSIX_C_SOURCE 200809L   // nanosleep
+
+#include "testutil.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "sched.h"
+
+#define NHOSTS 40
+
+static void sleep_ms(long ms) {
+	struct timespec ts = { ms / 1000, (ms % 1000) * 1000000L };
+	nanosleep(&ts, NULL);
+}
+
+static bool is_host(webpage_t *wp, const char *host) {
+	return wp != NULL && strstr(webpage_getURL(wp), host) != NULL;
+}
+
+int main(void) {
+	printf("Running scheduler test...\n");
+	long wait_ms;
+	sched_t *sp = schedopen(100);
+	scheddelay(sp, "fast.example.com", 0);
+
+	schedput(sp, webpage_new("http://a.example.com/1.html", 0, NULL));
+	schedput(sp, webpage_new("http://a.example.com/2.html", 0, NULL));
+	schedput(sp, webpage_new("http://FAST.example.com/1.html", 0, NULL));
+	schedput(sp, webpage_new("http://fast.example.com/2.html", 0, NULL));
+	printf("Queued %d pages on two hosts\n", schedsize(sp));
+	if (schedsize(sp) != 4) fail("Put: expected 4 pages");
+
+	webpage_t *a1 = schedget(sp, &wait_ms);
+	webpage_t *f1 = schedget(sp, &wait_ms);
+	if (!is_host(a1, "a.example.com") || f1 == NULL || is_host(f1, "a.example.com")) {
+		fail("Get: expected one page from each host");
+	}
+	printf("Got %s and %s\n", webpage_getURL(a1), webpage_getURL(f1));
+	if (schedget(sp, &wait_ms) != NULL || wait_ms != -1) fail("Get: a busy host handed out a page");
+	printf("Both hosts busy, nothing handed out\n");
+
+	scheddone(sp, f1, true);
+	webpage_t *f2 = schedget(sp, &wait_ms);
+	if (!is_host(f2, "fast.example.com")) fail("Get: host without delay was not ready at once");
+	printf("Got %s at once from the host without delay\n", webpage_getURL(f2));
+	scheddone(sp, f2, true);
+
+	scheddone(sp, a1, true);
+	if (schedget(sp, &wait_ms) != NULL || wait_ms <= 0 || wait_ms > 100) fail("Get: host did not cool down");
+	printf("a.example.com cools down for %ld ms\n", wait_ms);
+	sleep_ms(wait_ms + 5);
+	webpage_t *a2 = schedget(sp, &wait_ms);
+	if (!is_host(a2, "a.example.com")) fail("Get: host not ready after its delay");
+	printf("Got %s after the delay\n", webpage_getURL(a2));
+	scheddone(sp, a2, false);
+
+	schedput(sp, webpage_new("http://a.example.com/3.html", 0, NULL));
+	webpage_t *a3 = schedget(sp, &wait_ms);
+	if (!is_host(a3, "a.example.com")) fail("Get: host not ready at once when nothing was fetched");
+	printf("Got %s at once, nothing having been fetched\n", webpage_getURL(a3));
+	if (schedsize(sp) != 0) fail("Size: pages left queued");
+
+	webpage_delete(a1);
+	webpage_delete(a2);
+	webpage_delete(a3);
+	webpage_delete(f1);
+	webpage_delete(f2);
+	schedclose(sp);
+
+	// more hosts than the heap starts with room for; each accepted page must come out once
+	printf("Queueing two pages on each of %d hosts...\n", NHOSTS);
+	sp = schedopen(0);
+	char url[64];
+	for (int i = 0; i < 2 * NHOSTS; i++) {
+		sprintf(url, "http://host%d.example.com/%d.html", i % NHOSTS, i / NHOSTS);
+		webpage_t *wp = webpage_new(url, 0, NULL);
+		if (schedput(sp, wp) != 0) {
+			webpage_delete(wp);              // never queued, so still the caller's
+			fail("Put: page refused");
+		}
+	}
+	if (schedput(sp, NULL) == 0) fail("Put: accepted no page");
+	printf("Queued %d pages\n", schedsize(sp));
+
+	int seen[NHOSTS] = { 0 };
+	webpage_t *wp;
+	int got = 0;
+	while ((wp = schedget(sp, &wait_ms)) != NULL) {
+		int host;
+		if (sscanf(webpage_getURL(wp), "http://host%d.", &host) != 1 || host < 0 || host >= NHOSTS) {
+			fail("Get: page from an unknown host");
+		}
+		seen[host]++;
+		got++;
+		scheddone(sp, wp, true);
+		webpage_delete(wp);
+	}
+	for (int i = 0; i < NHOSTS; i++) {
+		if (seen[i] != 2) fail("Get: a host did not hand out both its pages");
+	}
+	printf("Got %d pages, two from each host\n", got);
+
+	schedput(sp, webpage_new("http://b.example.com/1.html", 0, NULL)); // freed by schedclose
+	schedclose(sp);
+
+	printf("Scheduler test complete.\n");
+	exit(EXIT_SUCCESS);
+}
@@ -0,0 +1,137 @@
+/*
+ * test_segments.c ---
+ *
+ * Author: Khaidar Kairbek
+ * Created: 10-18-2026
+ * Version: 1.0
+ *
+ * Description: verify a segment manifest survives a save and load,
+ * tombstones hide a page in the segment it was live in only, and the
+ * merge policy merges small segments, drops tombstoned postings and
+ * removes the merged files once the manifest is saved
+ *
+ */
+
+#include "testutil.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "indexio.h"
+#include "indexmap.h"
+#include "segments.h"
+
+// writes segment ssp->next_gen over ids, where page id holds "common" and "p<id>", and adds it
+static int32_t add_segment(segments_t *ssp, char *indexnm, uint64_t *ids, uint32_t nids) {
+	char *segnm = segments_file(indexnm, ssp->next_gen);
+	indexwriter_t *iwp = indexwriter_open(segnm);
+	free(segnm);
+	if (iwp == NULL) return -1;
+
+	document_t *docs = malloc(nids * sizeof(document_t));
+	for (uint32_t i = 0; i < nids; i++) docs[i] = (document_t) { ids[i], 1 };
+	indexwriter_add(iwp, "common", docs, nids);
+	char word[32];
+	for (uint32_t i = 0; i < nids; i++) {
+		sprintf(word, "p%03lu", (unsigned long) ids[i]);   // ascending ids keep the terms in order
+		indexwriter_add(iwp, word, &docs[i], 1);
+	}
+	free(docs);
+	if (indexwriter_close(iwp) != 0) return -1;
+	return segments_add(ssp, ids, nids);
+}
+
+int main(void) {
+	printf("Running segments test...\n");
+	char dir[] = "/tmp/test_segmentsXXXXXX";
+	make_temp_dir(dir);
+	char indexnm[64];
+	snprintf(indexnm, sizeof(indexnm), "%s/index", dir);
+
+	segments_t *ssp = segments_new();
+	if (ssp == NULL || ssp->nsegs != 0 || ssp->next_gen != 1) fail("New: a new index has segments");
+
+	printf("Adding a segment of pages 1 to 10, deleting 5 and 7, then adding 5, 11 and 12...\n");
+	uint64_t first_ids[10], second_ids[3] = { 5, 11, 12 };
+	for (int i = 0; i < 10; i++) first_ids[i] = i + 1;
+	if (add_segment(ssp, indexnm, first_ids, 10) != 0) fail("Add: the first segment was not added");
+	if (segments_delete(ssp, 5) != 0 || segments_delete(ssp, 7) != 0) fail("Delete: a tombstone was not added");
+	if (segments_delete(ssp, 5) == 0 || segments_delete(ssp, 500) == 0) fail("Delete: a page not live took a tombstone");
+	if (add_segment(ssp, indexnm, second_ids, 3) != 0 || ssp->nsegs != 2) fail("Add: the second segment was not added");
+	if (segments_find(ssp, 5) != 1 || segments_find(ssp, 6) != 0 || segments_find(ssp, 7) != -1) {
+		fail("Find: a page is not found in the segment it is live in");
+	}
+	if (!segment_deleted(&ssp->segs[0], 5) || segment_live(&ssp->segs[0], 5) || !segment_live(&ssp->segs[1], 5)) {
+		fail("Delete: a tombstone did not hide the older copy only");
+	}
+	printf("Page 5 is live in segment 1 only; page 7 in none\n");
+
+	ssp->store = true;
+	ssp->mark = 12345;
+	if (segments_save(ssp, indexnm) != 0 || !segments_exists(indexnm)) fail("Save: the manifest did not save");
+	segments_t *back = segments_load(indexnm);
+	if (back == NULL || back->nsegs != 2 || back->next_gen != 3 || !back->store || back->mark != 12345) {
+		fail("Load: the manifest did not load as saved");
+	}
+	for (int s = 0; s < 2; s++) {
+		segment_t *a = &ssp->segs[s], *b = &back->segs[s];
+		if (a->gen != b->gen || a->nids != b->nids || a->ndeleted != b->ndeleted ||
+				memcmp(a->ids, b->ids, a->nids * sizeof(uint64_t)) != 0 ||
+				memcmp(a->deleted, b->deleted, a->ndeleted * sizeof(uint64_t)) != 0) {
+			fail("Load: a segment did not load as saved");
+		}
+	}
+	segments_free(back);
+	printf("The manifest of %d segments loads as saved\n", ssp->nsegs);
+
+	// 8 live pages are fewer than 4 times 3: the segments merge
+	if (segments_compact(ssp, indexnm) != 1 || ssp->nsegs != 1 || ssp->segs[0].nids != 11 || ssp->segs[0].ndeleted != 0) {
+		fail("Compact: the small segments did not merge into one without tombstones");
+	}
+	char *merged = segments_file(indexnm, ssp->segs[0].gen);
+	indexmap_t *imp = indexmap_open(merged);
+	word_index_t *common = imp ? indexmap_record(imp, indexmap_find(imp, "common", 6)) : NULL;
+	if (common == NULL || common->ndocs != 11) fail("Compact: the merged segment lost postings");
+	for (uint32_t i = 1; i < common->ndocs; i++) {
+		if (common->docs[i - 1].id >= common->docs[i].id) fail("Compact: the merged postings are out of order");
+	}
+	if (postings_find(common, 7) != NULL || postings_find(common, 5) == NULL) fail("Compact: the deleted page was kept");
+	if (indexmap_find(imp, "p007", 4) >= 0 || indexmap_find(imp, "p005", 4) < 0) {
+		fail("Compact: a term left with no postings was kept");
+	}
+	word_index_free(common);
+	indexmap_close(imp);
+	printf("The segments merged into one of 11 pages, without page 7 or its term\n");
+
+	char *first = segments_file(indexnm, 1);
+	if (access(first, F_OK) != 0) fail("Compact: a merged segment was removed before the manifest was saved");
+	if (segments_save(ssp, indexnm) != 0 || access(first, F_OK) == 0 || access(merged, F_OK) != 0) {
+		fail("Save: the merged segments were not removed");
+	}
+	free(first);
+	printf("The merged segments are removed once the manifest is saved\n");
+
+	// a segment more than half tombstones is rewritten on its own
+	for (int i = 0; i < 6; i++) segments_delete(ssp, i + 1);
+	if (segments_compact(ssp, indexnm) != 1 || ssp->nsegs != 1 || ssp->segs[0].nids != 5) {
+		fail("Compact: a mostly deleted segment was not rewritten");
+	}
+	for (uint32_t i = 0; i < ssp->segs[0].nids; i++) segments_delete(ssp, ssp->segs[0].ids[i]);
+	if (segments_compact(ssp, indexnm) != 0 || ssp->nsegs != 0) fail("Compact: a segment with no live pages was kept");
+	if (segments_save(ssp, indexnm) != 0 || access(merged, F_OK) == 0) fail("Save: a dropped segment was not removed");
+	free(merged);
+	segments_free(ssp);
+	printf("A mostly deleted segment is rewritten; an empty one is dropped\n");
+
+	FILE *fp = fopen(indexnm, "w");
+	fprintf(fp, "%s %d\nnext 2 mark files 0\nsegment 1 3 0\n1-2\n\n", SEGMENTS_MAGIC, SEGMENTS_VERSION);
+	fclose(fp);
+	if (segments_load(indexnm) != NULL) fail("Load: a manifest with a wrong id count was taken");
+	printf("A manifest with a wrong id count is refused\n");
+
+	remove(indexnm);
+	remove(dir);
+
+	printf("Segments test complete.\n");
+	exit(EXIT_SUCCESS);
+}
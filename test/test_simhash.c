@@ -0,0 +1,157 @@
+/* 
+ * test_simhash.c --- 
+ * 
+ * Author: Khaidar Kairbek
+ * Created: 10-18-2026
+ * Version: 1.0
+ * 
+ * Description: verify SimHash keeps near pages near and far pages far,
+ * and that the banded index finds exactly the fingerprints within its
+ * distance, across growth and a save/load round trip
+ * 
+ */
+
+#include "testutil.h"
+#include <sys/resource.h>
+#include "webpage.h"
+#include "simhash.h"
+
+#define NWORDS 300
+#define N 5000
+#define HEADROOM (16L << 20)   // bytes the capped index may still take
+#define MAX_FPS 4000000
+
+static uint64_t state = 88172645463325252ULL;
+
+static uint64_t next_random(void) {
+	state ^= state << 13;
+	state ^= state >> 7;
+	state ^= state << 17;
+	return state;
+}
+
+// a page of NWORDS random words, with word edit replaced if edit >= 0
+static uint64_t page_hash(uint64_t seed, int edit, const char *tag) {
+	static const char *vocab[] = { "alpha", "bravo", "charlie", "delta", "echo", "foxtrot",
+		"golf", "hotel", "india", "juliet", "kilo", "lima", "mike", "november" };
+	char *html = calloc(NWORDS * 12 + 100, 1);
+	strcat(html, "<html><body><p>");
+	state = seed;
+	for (int i = 0; i < NWORDS; i++) {
+		strcat(html, i == edit ? "zulu" : vocab[next_random() % 14]);
+		strcat(html, " ");
+	}
+	strcat(html, tag);
+	strcat(html, "</p></body></html>");
+
+	webpage_t *page = webpage_new("http://a/x.html", 0, html);
+	uint64_t fp = simhash(page);
+	webpage_delete(page);
+	return fp;
+}
+
+// flips n distinct bits of fp
+static uint64_t flip(uint64_t fp, int n) {
+	uint64_t mask = 0;
+	while (simhash_distance(mask, 0) < n) mask |= 1ULL << (next_random() % 64);
+	return fp ^ mask;
+}
+
+int main(void) {
+	printf("Running SimHash test...\n");
+	uint64_t a = page_hash(1, -1, "");
+	if (a == 0 || a != page_hash(1, -1, "")) fail("Hash: the same text hashed differently");
+	if (simhash_distance(a, page_hash(1, -1, "")) != 0) fail("Distance: identical pages are apart");
+	printf("A page of %d words hashes to %016llx\n", NWORDS, (unsigned long long) a);
+	int d = simhash_distance(a, page_hash(1, 150, ""));
+	printf("One word changed: %d bits apart\n", d);
+	if (d > 6) fail("Distance: a page with one word changed is far");
+	d = simhash_distance(a, page_hash(1, -1, "print version"));
+	printf("Two words added: %d bits apart\n", d);
+	if (d > 6) fail("Distance: a page with two words added is far");
+	d = simhash_distance(a, page_hash(2, -1, ""));
+	printf("Different text: %d bits apart\n", d);
+	if (d <= 10) fail("Distance: a page of different text is near");
+
+	webpage_t *empty = webpage_new("http://a/y.html", 0, calloc(1, 1));
+	if (simhash(empty) != 0) fail("Hash: a page without words did not hash to 0");
+	webpage_delete(empty);
+	printf("A page without words hashes to 0\n");
+
+	if (simindex_open(-1) != NULL || simindex_open(SIMHASH_MAX_DISTANCE + 1) != NULL) {
+		fail("Open: an index with a distance out of range opened");
+	}
+
+	for (int k = 0; k <= SIMHASH_MAX_DISTANCE; k += 3) {
+		printf("Indexing %d fingerprints, matched within distance %d...\n", N, k);
+		simindex_t *sip = simindex_open(k);
+		uint64_t *fps = malloc(N * sizeof(uint64_t));
+		state = 12345 + k;
+		for (int i = 0; i < N; i++) {
+			fps[i] = next_random();
+			simindex_add(sip, fps[i], i + 1);
+		}
+		if (simindex_size(sip) != N) fail("Add: not every fingerprint was added");
+
+		for (int i = 0; i < N; i += 7) {
+			uint64_t query = flip(fps[i], k);
+			int id = simindex_find(sip, query);
+			if (id <= 0 || simhash_distance(fps[id - 1], query) > k) fail("Find: a fingerprint within distance was missed");
+			// random fingerprints are almost never within k of each other for small k
+			if (k <= 6 && simindex_find(sip, next_random()) != 0) fail("Find: a random fingerprint was found");
+		}
+		printf("Fingerprints %d bits off are found%s\n", k, k <= 6 ? "; random ones are not" : "");
+
+		FILE *fp = tmpfile();
+		simindex_save(sip, fp);
+		rewind(fp);
+		simindex_t *copy = simindex_open(k);
+		if (simindex_load(copy, fp) != 0 || simindex_size(copy) != N) fail("Load: the index did not load back");
+		for (int i = 0; i < N; i += 11) {
+			if (simindex_find(copy, fps[i]) != simindex_find(sip, fps[i])) fail("Load: the loaded index finds otherwise");
+		}
+		printf("The index survives a save/load round trip\n");
+		fclose(fp);
+
+		simindex_close(copy);
+		simindex_close(sip);
+		free(fps);
+	}
+
+	// with the address space capped, the index stops growing; a failed growth must leave it whole
+	printf("Adding fingerprints until the index cannot grow...\n");
+	simindex_t *sip = simindex_open(SIMHASH_MAX_DISTANCE);
+	uint64_t *fps = malloc(MAX_FPS * sizeof(uint64_t));
+	if (sip == NULL || fps == NULL) fail("Open: the capped index did not open");
+	struct rlimit old, cap;
+	getrlimit(RLIMIT_AS, &old);
+	cap = old;
+	cap.rlim_cur = vm_size() + HEADROOM;
+	if (setrlimit(RLIMIT_AS, &cap) != 0) fail("setrlimit failed");
+	state = 54321;
+	int n = 0;
+	for (; n < MAX_FPS; n++) {
+		fps[n] = next_random();
+		if (simindex_add(sip, fps[n], n + 1) != 0) break;
+	}
+	if (n == MAX_FPS) fail("Add: the index never stopped growing");
+	if (simindex_size(sip) != n) fail("Add: a refused fingerprint changed the size");
+	printf("The index stopped at %d fingerprints\n", n);
+	for (int i = 0; i < n; i++) {
+		int id = simindex_find(sip, fps[i]);
+		if (id <= 0 || id > n || simhash_distance(fps[id - 1], fps[i]) > SIMHASH_MAX_DISTANCE) {
+			fail("Find: a failed growth lost a fingerprint");
+		}
+	}
+	printf("A failed growth keeps every fingerprint findable\n");
+	setrlimit(RLIMIT_AS, &old);
+	if (simindex_add(sip, fps[n], n + 1) != 0 || simindex_find(sip, fps[n]) <= 0) {
+		fail("Add: the index did not grow once the cap was lifted");
+	}
+	printf("With the cap lifted, the index grows again\n");
+	simindex_close(sip);
+	free(fps);
+
+	printf("SimHash test complete.\n");
+	exit(EXIT_SUCCESS);
+}
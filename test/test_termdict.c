@@ -0,0 +1,97 @@
+/*
+ * test_termdict.c ---
+ *
+ * Author: Khaidar Kairbek
+ * Created: 10-18-2026
+ * Version: 1.0
+ *
+ * Description: verify the arena hands out aligned, disjoint memory,
+ * and the term dictionary finds terms by pointer and length, interns
+ * only new ones, and keeps them across growth
+ *
+ */
+
+#include "testutil.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+#include "arena.h"
+#include "termdict.h"
+
+static int applied = 0;
+static void count_value(void *value) {
+	if (value != NULL) applied++;
+}
+
+int main(void) {
+	printf("Running term dictionary test...\n");
+	arena_t *ap = arena_open(128);
+	if (ap == NULL) fail("Arena: did not open");
+
+	char *s = arena_strndup(ap, "abcdef", 3);
+	if (s == NULL || strcmp(s, "abc") != 0) fail("Arena: strndup did not copy len characters");
+	uint64_t *n = arena_alloc(ap, sizeof(uint64_t));
+	if (n == NULL || (uintptr_t) n % _Alignof(max_align_t) != 0) fail("Arena: an alloc after a string is not aligned");
+	*n = 42;
+
+	char *big = arena_alloc(ap, 1000);
+	if (big == NULL) fail("Arena: an alloc larger than a chunk failed");
+	memset(big, 'x', 1000);
+	char *after = arena_strndup(ap, "after", 5);
+	if (after == NULL || strcmp(s, "abc") != 0 || *n != 42 || strcmp(after, "after") != 0) {
+		fail("Arena: allocations overlap");
+	}
+	if (arena_used(ap) != 4 + sizeof(uint64_t) + 1000 + 6) fail("Arena: wrong count of bytes handed out");
+	printf("The arena handed out %lu aligned, disjoint bytes in chunks of 128\n", (unsigned long) arena_used(ap));
+	arena_close(ap);
+
+	termdict_t *tdp = termdict_open(2);
+	if (tdp == NULL || termdict_size(tdp) != 0) fail("Open: the dictionary did not open empty");
+
+	const char *text = "pages pagesXYZ page";
+	int value = 1;
+	if (termdict_find(tdp, text, 5) != NULL) fail("Find: an absent term was found");
+	const char *pages = termdict_add(tdp, text, 5, &value);
+	if (pages == NULL || strcmp(pages, "pages") != 0 || pages == text) fail("Add: the term was not interned as a copy");
+	if (termdict_find(tdp, text + 6, 5) != &value) fail("Find: no match by pointer and length");
+	if (termdict_find(tdp, text + 6, 8) != NULL) fail("Find: a longer term matched");
+	if (termdict_find(tdp, text + 15, 4) != NULL) fail("Find: a prefix matched");
+	if (termdict_add(tdp, text + 6, 5, &value) != NULL) fail("Add: a present term was added again");
+	printf("\"pages\" is interned once and found by pointer and length, not by prefix\n");
+
+	char *scratch = termdict_scratch(tdp, 1000);
+	if (scratch == NULL) fail("Scratch: did not grow for a long term");
+	memset(scratch, 'a', 1000);
+	scratch[1000] = '\0';
+
+	printf("Adding 500 more terms to a dictionary sized for 2...\n");
+	int values[500];
+	char word[16];
+	for (int i = 0; i < 500; i++) {
+		int len = sprintf(word, "word%d", i);
+		values[i] = i;
+		if (termdict_add(tdp, word, len, &values[i]) == NULL) fail("Add: a new term was refused");
+	}
+	if (termdict_size(tdp) != 501) fail("Add: the dictionary did not grow");
+
+	if (termdict_find(tdp, "pages", 5) != &value) fail("Find: a term was lost in growth");
+	for (int i = 0; i < 500; i++) {
+		int len = sprintf(word, "word%d", i);
+		if (termdict_find(tdp, word, len) != &values[i]) fail("Find: a term was lost in growth");
+	}
+	if (strcmp(pages, "pages") != 0) fail("Add: an interned term did not survive growth");
+	printf("All %lu terms are found after growth\n", (unsigned long) termdict_size(tdp));
+
+	termdict_apply(tdp, count_value);
+	if (applied != 501) fail("Apply: not every value was visited");
+
+	void *mem = termdict_alloc(tdp, 64);
+	if (mem == NULL) fail("Alloc: the dictionary arena did not allocate");
+	termdict_close(tdp);
+
+	printf("Term dictionary test complete.\n");
+	exit(EXIT_SUCCESS);
+}
@@ -0,0 +1,99 @@
+/* 
+ * test_tokenizer.c --- 
+ * 
+ * Author: Khaidar Kairbek
+ * Created: 10-18-2026
+ * Version: 1.0
+ * 
+ * Description: verify webpage_nextToken finds the words and links of a
+ * page in order, without changing the html
+ * 
+ */
+
+#include "testutil.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "webpage.h"
+
+static const char *html =
+	"<html><head><title>Two words</title></head>\n"
+	"<body>hello, world<br/>\n"
+	"<a href=\"page1.html\">one</a>\n"
+	"<A HREF = '/site/page2.html#frag' class=x>two</A>\n"
+	"<a class=\"y\" href=page3.html>three</a>\n"
+	"<a name=\"top\">no link</a><abbr title=\"href=no.html\">abbr</abbr>\n"
+	"<a href=\"#top\">self</a><a href=\"mailto:x@y.z\">mail</a>\n"
+	"<a href=\" http://Example.com/x.html \">ext</a>x9y\n"
+	"</body></html>";
+
+// expected tokens: W word, H href resolved to a url ("" for unresolvable)
+static const char *expected[][2] = {
+	{ "W", "Two" }, { "W", "words" }, { "W", "hello" }, { "W", "world" },
+	{ "H", "http://a.b/site/page1.html" }, { "W", "one" },
+	{ "H", "http://a.b/site/page2.html" }, { "W", "two" },
+	{ "H", "http://a.b/site/page3.html" }, { "W", "three" },
+	{ "W", "no" }, { "W", "link" }, { "W", "abbr" },
+	{ "H", "" }, { "W", "self" }, { "H", "" }, { "W", "mail" },
+	{ "H", "http://Example.com/x.html" }, { "W", "ext" }, { "W", "x" }, { "W", "y" },
+};
+
+int main(void) {
+	printf("Running tokenizer test...\n");
+	char *copy = malloc(strlen(html) + 1);
+	strcpy(copy, html);
+	webpage_t *page = webpage_new("http://a.b/site/index.html", 0, copy);
+
+	int n = 0, count = sizeof(expected) / sizeof(expected[0]);
+	webpage_token_t token;
+	for (int pos = 0; (pos = webpage_nextToken(page, pos, &token)) > 0; n++) {
+		if (n >= count) fail("Tokens: more tokens than the page has");
+
+		char got[200] = "";
+		if (token.kind == WEBPAGE_WORD) {
+			sprintf(got, "%.*s", token.length, html + token.offset);
+		} else {
+			char *url = webpage_resolveHREF(page, &token);
+			if (url != NULL) strcpy(got, url);
+			free(url);
+		}
+		printf("%s '%s'\n", token.kind == WEBPAGE_WORD ? "word" : "link", got);
+		if ((token.kind == WEBPAGE_WORD) != (expected[n][0][0] == 'W') || strcmp(got, expected[n][1]) != 0) {
+			printf("token %d: expected '%s'\n", n, expected[n][1]);
+			fail("Tokens: words and links are not found in order");
+		}
+	}
+	if (n != count) fail("Tokens: fewer tokens than the page has");
+	if (strcmp(webpage_getHTML(page), html) != 0) fail("Tokens: the html was changed");
+	printf("Found %d words and links in order, leaving the html unchanged\n", n);
+
+	char *word;
+	int pos = webpage_getNextWord(page, 0, &word);
+	if (pos <= 0 || strcmp(word, "Two") != 0) fail("GetNextWord: the first word was not copied");
+	free(word);
+
+	char *url;
+	int links = 0;
+	for (pos = 0; (pos = webpage_getNextURL(page, pos, &url)) > 0; links++) free(url);
+	if (links != 4) fail("GetNextURL: not just the followable links");
+	printf("getNextWord copies the first word; getNextURL returns the %d followable links\n", links);
+
+	webpage_t *empty = webpage_new("http://a.b/", 0, NULL);
+	if (webpage_nextToken(empty, 0, &token) >= 0) fail("Tokens: a page without html has tokens");
+	webpage_delete(empty);
+
+	char *cut = malloc(40);
+	strcpy(cut, "word <a href=\"x.html");
+	webpage_t *truncated = webpage_new("http://a.b/", 0, cut);
+	pos = webpage_nextToken(truncated, 0, &token);
+	if (pos <= 0 || token.kind != WEBPAGE_WORD || webpage_nextToken(truncated, pos, &token) >= 0) {
+		fail("Tokens: an unterminated tag did not end the scan");
+	}
+	webpage_delete(truncated);
+	printf("A page without html has no tokens; an unterminated tag ends the scan\n");
+
+	webpage_delete(page);
+
+	printf("Tokenizer test complete.\n");
+	exit(EXIT_SUCCESS);
+}
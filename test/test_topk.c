@@ -0,0 +1,208 @@
+/*
+ * test_topk.c ---
+ *
+ * Author: Khaidar Kairbek
+ * Created: 10-18-2026
+ * Version: 1.0
+ *
+ * Description: verify the querier's -k answers, which skip postings
+ * and blocks that cannot make the top k, name the same best pages as
+ * ranking every match and sorting them, with count and BM25 ranking,
+ * for single words, and sequences and unions of words
+ *
+ */
+
+#define _POSIX_C_SOURCE 200809L   // fork, execv
+
+#include "testutil.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include "webpage.h"
+#include "pageio.h"
+
+#define NPAGES 800
+#define NVOCAB 20
+#define MAX_RESULTS NPAGES
+
+static const char *vocab[NVOCAB] = { "alpha", "bravo", "charlie", "delta", "echo", "foxtrot", "golf",
+	"hotel", "india", "juliet", "kilo", "lima", "mike", "november", "oscar", "papa", "quebec",
+	"romeo", "sierra", "tango" };
+
+static const char *queries[] = { "alpha", "kilo", "tango", "zulu", "alpha bravo", "charlie delta echo",
+	"golf or hotel", "india juliet or kilo", "alpha or bravo or charlie or delta", "nosuchword" };
+#define NQUERIES (int) (sizeof(queries) / sizeof(queries[0]))
+
+static const int ks[] = { 1, 3, 10, 50 };
+#define NKS (int) (sizeof(ks) / sizeof(ks[0]))
+
+static uint64_t state = 88172645463325252ULL;
+
+static uint64_t next_random(void) {
+	state ^= state << 13;
+	state ^= state >> 7;
+	state ^= state << 17;
+	return state;
+}
+
+// a page of 20 to 220 words, the earlier words of vocab the likelier; a few pages have "zulu"
+static webpage_t *make_page(int id) {
+	int nwords = 20 + next_random() % 200;
+	char *html = calloc(nwords * 10 + 64, 1);
+	strcat(html, "<html><body><p>");
+	for (int i = 0; i < nwords; i++) {
+		int w = next_random() % NVOCAB;
+		w = next_random() % (w + 1);
+		strcat(html, vocab[w]);
+		strcat(html, " ");
+	}
+	if (id % 97 == 0) strcat(html, "zulu ");
+	strcat(html, "</p></body></html>");
+	char url[64];
+	sprintf(url, "https://thayer.github.io/engs50/page%d.html", id);
+	return webpage_new(url, id % 3, html);
+}
+
+// runs the program argv[0] with its output thrown away; returns its exit status, or -1
+static int run(char *const argv[]) {
+	pid_t pid = fork();
+	if (pid < 0) return -1;
+	if (pid == 0) {
+		int fd = open("/dev/null", O_WRONLY);
+		if (fd >= 0) {
+			dup2(fd, STDOUT_FILENO);
+			dup2(fd, STDERR_FILENO);
+		}
+		execv(argv[0], argv);
+		_exit(127);
+	}
+	int status;
+	if (waitpid(pid, &status, 0) != pid || !WIFEXITED(status)) return -1;
+	return WEXITSTATUS(status);
+}
+
+// result_t -- a line of an answer, and the rank and page it names
+typedef struct result {
+	char line[160];
+	double score;
+	long id;
+} result_t;
+
+/*
+ * answer -- runs query through the querier, ranking with BM25 if bm25,
+ * and keeping the best k pages if k > 0; returns the number of pages
+ * named, filling in results
+ */
+static int answer(char *querier, char *pagedir, char *indexnm, char *dir, const char *query,
+									bool bm25, int k, result_t *results) {
+	char qfile[128], outfile[128], kbuf[16];
+	snprintf(qfile, sizeof(qfile), "%s/query", dir);
+	snprintf(outfile, sizeof(outfile), "%s/answer", dir);
+	FILE *fp = fopen(qfile, "w");
+	if (fp == NULL || fprintf(fp, "%s\n", query) < 0 || fclose(fp) != 0) fail("Query: the query file was not written");
+
+	char *argv[10] = { querier, pagedir, indexnm, "-q", qfile, outfile };
+	int argc = 6;
+	if (bm25) argv[argc++] = "--bm25";
+	if (k > 0) {
+		sprintf(kbuf, "%d", k);
+		argv[argc++] = "-k";
+		argv[argc++] = kbuf;
+	}
+	argv[argc] = NULL;
+	if (run(argv) != 0) fail("Query: the querier failed");
+
+	if ((fp = fopen(outfile, "r")) == NULL) fail("Query: the querier wrote no answer");
+	int n = 0;
+	char line[160];
+	while (fgets(line, sizeof(line), fp) != NULL) {
+		if (strncmp(line, "rank: ", 6) != 0) continue;
+		if (n == MAX_RESULTS) fail("Query: more pages named than there are");
+		strcpy(results[n].line, line);
+		if (sscanf(line, "rank: %lf : doc: %ld :", &results[n].score, &results[n].id) != 2) {
+			fail("Query: a result line cannot be read");
+		}
+		n++;
+	}
+	fclose(fp);
+	remove(qfile);
+	remove(outfile);
+	return n;
+}
+
+// best first: by rank, then by id
+static int compare_results(const void *a, const void *b) {
+	const result_t *x = a, *y = b;
+	if (x->score != y->score) return x->score > y->score ? -1 : 1;
+	return x->id < y->id ? -1 : x->id > y->id;
+}
+
+static void check_top_k(char *querier, char *pagedir, char *indexnm, char *dir, bool bm25) {
+	static result_t all[MAX_RESULTS], top[MAX_RESULTS];
+	for (int q = 0; q < NQUERIES; q++) {
+		int nall = answer(querier, pagedir, indexnm, dir, queries[q], bm25, 0, all);
+		for (int i = 1; i < nall; i++) {
+			if (all[i].id <= all[i - 1].id) fail("Rank: every match is not named once, in id order");
+		}
+		qsort(all, nall, sizeof(result_t), compare_results);
+
+		for (int j = 0; j < NKS; j++) {
+			int k = ks[j];
+			int ntop = answer(querier, pagedir, indexnm, dir, queries[q], bm25, k, top);
+			if (ntop != (nall < k ? nall : k)) fail("Top k: the wrong number of pages was named");
+			for (int i = 0; i < ntop; i++) {
+				// BM25 ranks are printed rounded, so pages whose printed ranks tie may swap
+				if (top[i].score != all[i].score) fail("Top k: a page was ranked off the sorted matches");
+				if (!bm25 && strcmp(top[i].line, all[i].line) != 0) fail("Top k: a page differs from the sorted matches");
+				bool found = false;
+				for (int a = 0; a < nall && !found; a++) found = strcmp(top[i].line, all[a].line) == 0;
+				if (!found) fail("Top k: a page named is not among the matches");
+			}
+		}
+		printf("\"%s\": %d matches; the best 1, 3, 10 and 50 agree\n", queries[q], nall);
+	}
+}
+
+int main(int argc, char *argv[]) {
+	printf("Running top k test...\n");
+	// the querier is built next to the tests
+	char querier[256];
+	const char *slash = strrchr(argv[0], '/');
+	int len = slash != NULL ? slash - argv[0] + 1 : 0;
+	if (snprintf(querier, sizeof(querier), "%.*s../bin/querier", len, argv[0]) >= (int) sizeof(querier) ||
+			access(querier, X_OK) != 0) {
+		fail("Setup: the querier was not found in ../bin");
+	}
+	char indexer[256];
+	snprintf(indexer, sizeof(indexer), "%.*s../bin/indexer", len, argv[0]);
+	if (access(indexer, X_OK) != 0) fail("Setup: the indexer was not found in ../bin");
+
+	char dir[] = "/tmp/test_topkXXXXXX";
+	make_temp_dir(dir);
+	char pagedir[64], indexnm[64];
+	snprintf(pagedir, sizeof(pagedir), "%s/pages", dir);
+	snprintf(indexnm, sizeof(indexnm), "%s/index", dir);
+	if (mkdir(pagedir, 0755) != 0) fail("Setup: the page directory was not made");
+
+	printf("Indexing %d pages of %d words...\n", NPAGES, NVOCAB);
+	for (int id = 1; id <= NPAGES; id++) {
+		webpage_t *page = make_page(id);
+		if (pagesave(page, id, pagedir) != 0) fail("Setup: a page was not saved");
+		webpage_delete(page);
+	}
+	char *index_argv[] = { indexer, pagedir, indexnm, NULL };
+	if (run(index_argv) != 0) fail("Setup: the indexer failed");
+
+	printf("Ranking by count...\n");
+	check_top_k(querier, pagedir, indexnm, dir, false);
+	printf("Ranking by BM25...\n");
+	check_top_k(querier, pagedir, indexnm, dir, true);
+
+	if (remove_dir(pagedir) != 0 || remove_dir(dir) != 0) fail("Cleanup: the test directory was not removed");
+	printf("Top k test complete.\n");
+	exit(EXIT_SUCCESS);
+}
@@ -0,0 +1,106 @@
+/*
+ * test_urlset.c ---
+ *
+ * Author: Khaidar Kairbek
+ * Created: 10-18-2026
+ * Version: 1.0
+ *
+ * Description: verify the url fingerprint set finds repeats, grows,
+ * survives a save/load round trip, and turns urls away once it can no
+ * longer grow, with and without a Bloom filter
+ *
+ */
+
+#define _POSIX_C_SOURCE 200809L   // setrlimit
+
+#include "testutil.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/resource.h>
+#include "urlset.h"
+
+#define N 50000
+#define HEADROOM (24L << 20)   // bytes the full set may still take
+#define MAX_URLS 16000000
+
+static void url(int i, char *buf) {
+	sprintf(buf, "https://thayer.github.io/engs50/page%d.html", i);
+}
+
+static void run(int bloom_bits) {
+	char buf[100];
+	printf("Bloom bits per url: %d\n", bloom_bits);
+	urlset_t *us = urlset_open(bloom_bits);
+
+	printf("Adding %d distinct urls...\n", N);
+	for (int i = 0; i < N; i++) {
+		url(i, buf);
+		if (!urlset_add(us, buf)) fail("Add: a distinct url was taken for a repeat");
+	}
+	if (urlset_size(us) != N) fail("Size: not every url was kept");
+
+	printf("Adding them again...\n");
+	for (int i = 0; i < N; i++) {
+		url(i, buf);
+		if (urlset_add(us, buf) || !urlset_contains(us, buf)) fail("Add: a repeat was taken for a new url");
+	}
+	if (urlset_size(us) != N) fail("Size: a repeat was kept");
+
+	int false_hits = 0;
+	for (int i = N; i < 2 * N; i++) {
+		url(i, buf);
+		if (urlset_contains(us, buf)) false_hits++;
+	}
+	printf("Looked up %d urls never added, found %d\n", N, false_hits);
+	if (false_hits > 0) fail("Contains: found a url never added");
+
+	FILE *fp = tmpfile();
+	urlset_t *copy = urlset_open(bloom_bits);
+	if (urlset_save(us, fp) != 0) fail("Save: failed");
+	rewind(fp);
+	if (urlset_load(copy, fp) != 0 || urlset_size(copy) != N) fail("Load: failed");
+	url(N / 2, buf);
+	if (!urlset_contains(copy, buf)) fail("Load: the loaded set lacks a url");
+	printf("Saved and loaded %lu urls\n", (unsigned long) urlset_size(copy));
+	fclose(fp);
+	urlset_close(copy);
+
+	// with the address space capped, the table stops growing; it must then refuse urls, not fill up
+	struct rlimit old, cap;
+	getrlimit(RLIMIT_AS, &old);
+	cap = old;
+	cap.rlim_cur = vm_size() + HEADROOM;
+	if (setrlimit(RLIMIT_AS, &cap) != 0) fail("setrlimit failed");
+	printf("Adding urls until the set cannot grow...\n");
+	int i = 2 * N;
+	for (; i < MAX_URLS; i++) {
+		url(i, buf);
+		if (!urlset_add(us, buf)) break;
+	}
+	uint64_t size = urlset_size(us);
+	if (i == MAX_URLS) fail("Add: the set never stopped growing");
+	printf("The set stopped at %lu urls\n", (unsigned long) size);
+
+	url(i, buf);
+	if (urlset_contains(us, buf)) fail("Add: a refused url was kept");
+	for (int j = i + 1; j < i + 10; j++) {
+		url(j, buf);
+		if (urlset_add(us, buf)) fail("Add: a full set took a url");
+	}
+	url(0, buf);
+	if (urlset_add(us, buf) || !urlset_contains(us, buf) || urlset_size(us) != size) {
+		fail("Add: a full set lost track of its urls");
+	}
+	printf("A full set refuses new urls and still finds its own\n");
+	setrlimit(RLIMIT_AS, &old);
+
+	urlset_close(us);
+}
+
+int main(void) {
+	printf("Running url set test...\n");
+	run(0);
+	run(10);
+	printf("Url set test complete.\n");
+	exit(EXIT_SUCCESS);
+}
@@ -0,0 +1,79 @@
+/* 
+ * test_validators.c --- 
+ * 
+ * Author: Khaidar Kairbek
+ * Created: 10-18-2026
+ * Version: 1.0
+ * 
+ * Description: verify the validators saved with a crawl load back by
+ * url, with later lines replacing earlier ones
+ * 
+ */
+
+#include "testutil.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "webpage.h"
+#include "validators.h"
+
+static bool same(const char *a, const char *b) {
+	return (a == NULL && b == NULL) || (a != NULL && b != NULL && strcmp(a, b) == 0);
+}
+
+static void append(FILE *fp, char *url, const char *etag, const char *last_modified, int id) {
+	webpage_t *page = webpage_new(url, 0, NULL);
+	webpage_setValidators(page, etag, last_modified);
+	validators_append(fp, page, id);
+	webpage_delete(page);
+}
+
+int main(void) {
+	printf("Running validators test...\n");
+	char dir[] = "/tmp/test_validatorsXXXXXX";
+	make_temp_dir(dir);
+
+	validators_t *vp = validators_load(dir);
+	if (vp == NULL || validators_size(vp) != 0) fail("Load: a directory without validators did not load empty");
+	printf("A directory without validators loads empty\n");
+	validators_close(vp);
+
+	char path[300];
+	sprintf(path, "%s/%s", dir, VALIDATORS_FILE);
+	FILE *fp = fopen(path, "w");
+	append(fp, "http://a/1.html", "\"abc\"", "Sun, 18 Oct 2026 00:00:00 GMT", 1);
+	append(fp, "http://a/2.html", NULL, "Sun, 18 Oct 2026 00:00:00 GMT", 2);
+	append(fp, "http://a/3.html", "W/\"x\"", NULL, 3);
+	append(fp, "http://a/4.html", NULL, NULL, 4);        // skipped
+	append(fp, "http://a/1.html", "\"def\"", NULL, 5);   // replaces id 1
+	fclose(fp);
+	printf("Saved validators for 5 pages, one without any and one url twice\n");
+
+	vp = validators_load(dir);
+	const char *etag, *last_modified;
+	if (vp == NULL || validators_size(vp) != 3) fail("Load: a page without validators was saved");
+	printf("Loaded validators for %d urls\n", validators_size(vp));
+	if (validators_find(vp, "http://a/1.html", &etag, &last_modified) != 5 ||
+			!same(etag, "\"def\"") || !same(last_modified, NULL)) {
+		fail("Find: a later line did not replace an earlier one");
+	}
+	printf("http://a/1.html is page 5, with etag %s\n", etag);
+	if (validators_find(vp, "http://a/2.html", &etag, &last_modified) != 2 ||
+			!same(etag, NULL) || !same(last_modified, "Sun, 18 Oct 2026 00:00:00 GMT")) {
+		fail("Find: wrong validators for a page with a last-modified date only");
+	}
+	if (validators_find(vp, "http://a/3.html", &etag, &last_modified) != 3 ||
+			!same(etag, "W/\"x\"") || !same(last_modified, NULL)) {
+		fail("Find: wrong validators for a page with an etag only");
+	}
+	printf("Pages with only an etag or only a last-modified date keep just that\n");
+	if (validators_find(vp, "http://a/4.html", &etag, &last_modified) != 0) fail("Find: an unknown url was found");
+	printf("An unknown url is not found\n");
+	validators_close(vp);
+
+	remove(path);
+	remove(dir);
+
+	printf("Validators test complete.\n");
+	exit(EXIT_SUCCESS);
+}
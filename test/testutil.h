@@ -0,0 +1,61 @@
+#pragma once
+/*
+ * testutil.h -- checks and fixtures shared by the tests
+ *
+ * Author: Khaidar Kairbek
+ * Created: 10-18-2026
+ * Version: 1.0
+ *
+ * Description: a test stops at its first failed check, printing what
+ * went wrong. Tests that write files work in a fresh directory under
+ * /tmp. Include this before any system header, so that the POSIX
+ * calls below are declared.
+ */
+#ifndef _POSIX_C_SOURCE
+#define _POSIX_C_SOURCE 200809L   // mkdtemp
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <dirent.h>
+#include <unistd.h>
+
+/* print what went wrong and end the test */
+static inline void fail(const char *what) {
+	printf("%s\n", what);
+	exit(EXIT_FAILURE);
+}
+
+/* turn a template ending in XXXXXX into a fresh directory, or fail */
+static inline void make_temp_dir(char *dir) {
+	if (mkdtemp(dir) == NULL) fail("mkdtemp failed");
+}
+
+/* remove dir and the files in it; returns 0 for success */
+static inline int remove_dir(const char *dir) {
+	DIR *dp = opendir(dir);
+	if (dp == NULL) return -1;
+	int res = 0;
+	struct dirent *entry;
+	char path[512];
+	while ((entry = readdir(dp)) != NULL) {
+		if (strcmp(entry->d_name, ".") == 0 || strcmp(entry->d_name, "..") == 0) continue;
+		if (snprintf(path, sizeof(path), "%s/%s", dir, entry->d_name) >= (int) sizeof(path) ||
+				remove(path) != 0) {
+			res = -1;
+		}
+	}
+	closedir(dp);
+	return rmdir(dir) == 0 ? res : -1;
+}
+
+/* the virtual size of this process in bytes, or -1 */
+static inline long vm_size(void) {
+	FILE *fp = fopen("/proc/self/statm", "r");
+	if (fp == NULL) return -1;
+	long pages = -1;
+	if (fscanf(fp, "%ld", &pages) != 1) pages = -1;
+	fclose(fp);
+	return pages < 0 ? -1 : pages * sysconf(_SC_PAGESIZE);
+}
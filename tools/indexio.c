@@ -0,0 +1,46 @@
+/* 
+ * indexio.c --- 
+ * 
+ * Author: Khaidar Kairbek, Ava D. Rosenbaum
+ * Created: 10-18-2026
+ * Version: 1.0
+ * 
+ * Description: converts an index file between the binary format and
+ * the older text format.
+ * 
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "hash.h"
+#include "indexio.h"
+
+static char *usage = "usage: indexio totext|tobinary <from indexnm> <to indexnm>\n";
+
+static void free_record(void *ep) {
+	word_index_free((word_index_t *) ep);
+}
+
+int main(int argc, char *argv[]) {
+	if (argc != 4 || (strcmp(argv[1], "totext") != 0 && strcmp(argv[1], "tobinary") != 0)) {
+		printf("%s", usage);
+		exit(EXIT_FAILURE);
+	}
+	bool binary = strcmp(argv[1], "tobinary") == 0;
+	char *from = argv[2];
+	char *to = argv[3];
+
+	hashtable_t *htp = indexload(from);
+	if (htp == NULL) {
+		printf("Error: could not load index %s\n", from);
+		exit(EXIT_FAILURE);
+	}
+
+	int32_t result = binary ? indexsave(htp, to) : indexsave_text(htp, to);
+	if (result == 0) printf("Wrote the %s index %s\n", binary ? "binary" : "text", to);
+
+	happly(htp, free_record);
+	hclose(htp);
+	exit(result == 0 ? EXIT_SUCCESS : EXIT_FAILURE);
+}
@@ -0,0 +1,44 @@
+/* 
+ * pagestore.c --- 
+ * 
+ * Author: Khaidar Kairbek, Ava D. Rosenbaum
+ * Created: 10-18-2026
+ * Version: 1.0
+ * 
+ * Description: converts a page directory between one file per page
+ * and a packed page store.
+ * 
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "pagestore.h"
+
+static char *usage = "usage: pagestore import|export <pagedir>\n";
+
+int main(int argc, char *argv[]) {
+	if (argc != 3) {
+		printf("%s", usage);
+		exit(EXIT_FAILURE);
+	}
+	char *pagedir = argv[2];
+
+	int count;
+	if (strcmp(argv[1], "import") == 0) {
+		count = pagestore_import(pagedir);
+		if (count >= 0) printf("Packed %d pages into the page store in %s\n", count, pagedir);
+	} else if (strcmp(argv[1], "export") == 0) {
+		if (!pagestore_exists(pagedir)) {
+			printf("Error: no page store in %s\n", pagedir);
+			exit(EXIT_FAILURE);
+		}
+		count = pagestore_export(pagedir);
+		if (count >= 0) printf("Wrote %d page files into %s\n", count, pagedir);
+	} else {
+		printf("%s", usage);
+		exit(EXIT_FAILURE);
+	}
+
+	exit(count < 0 ? EXIT_FAILURE : EXIT_SUCCESS);
+}
@@ -0,0 +1,104 @@
+/* 
+ * arena.c --- 
+ * 
+ * Author: Khaidar Kairbek, Ava D. Rosenbaum
+ * Created: 10-18-2026
+ * Version: 1.0
+ * 
+ * Description: Implementation of the arena. Chunks are kept on a list,
+ * newest first; only the newest one is allocated from, so the space
+ * left in a chunk when a request does not fit is abandoned.
+ * 
+ */
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include "arena.h"
+
+#define ARENA_ALIGN (_Alignof(max_align_t))
+
+typedef struct chunk {
+	struct chunk *next;
+	size_t size;
+	size_t used;
+	max_align_t data[];
+} chunk_t;
+
+struct arena {
+	chunk_t *chunks;
+	size_t chunk_size;
+	size_t used;
+};
+
+arena_t *arena_open(size_t chunk_size) {
+	arena_t *ap = malloc(sizeof(arena_t));
+	if (ap == NULL) return NULL;
+	ap->chunks = NULL;
+	ap->chunk_size = chunk_size > 0 ? chunk_size : ARENA_CHUNK_SIZE;
+	ap->used = 0;
+	return ap;
+}
+
+void arena_close(arena_t *ap) {
+	if (ap == NULL) return;
+	chunk_t *cp = ap->chunks;
+	while (cp != NULL) {
+		chunk_t *next = cp->next;
+		free(cp);
+		cp = next;
+	}
+	free(ap);
+}
+
+// links in a chunk of at least size bytes
+static chunk_t *new_chunk(arena_t *ap, size_t size) {
+	if (size < ap->chunk_size) size = ap->chunk_size;
+	chunk_t *cp = malloc(sizeof(chunk_t) + size);
+	if (cp == NULL) return NULL;
+	cp->size = size;
+	cp->used = 0;
+
+	if (ap->chunks != NULL && size > ap->chunk_size) {
+		// an oversized chunk is full at once; keep allocating from the current one
+		cp->next = ap->chunks->next;
+		ap->chunks->next = cp;
+	} else {
+		cp->next = ap->chunks;
+		ap->chunks = cp;
+	}
+	return cp;
+}
+
+// size bytes starting at a multiple of align within the newest chunk
+static void *take(arena_t *ap, size_t size, size_t align) {
+	if (ap == NULL || size > SIZE_MAX - ARENA_ALIGN) return NULL;
+
+	chunk_t *cp = ap->chunks;
+	size_t start = cp == NULL ? 0 : (cp->used + align - 1) / align * align;
+	if (cp == NULL || start > cp->size || cp->size - start < size) {
+		if ((cp = new_chunk(ap, size)) == NULL) return NULL;
+		start = cp->used;
+	}
+	cp->used = start + size;
+	ap->used += size;
+	return (char *) cp->data + start;
+}
+
+void *arena_alloc(arena_t *ap, size_t size) {
+	return take(ap, size, ARENA_ALIGN);
+}
+
+char *arena_strndup(arena_t *ap, const char *s, size_t len) {
+	if (s == NULL) return NULL;
+	char *copy = take(ap, len + 1, 1);   // strings need no alignment
+	if (copy == NULL) return NULL;
+	memcpy(copy, s, len);
+	copy[len] = '\0';
+	return copy;
+}
+
+size_t arena_used(arena_t *ap) {
+	return ap == NULL ? 0 : ap->used;
+}
@@ -0,0 +1,44 @@
+#pragma once
+/* 
+ * arena.h --- a bump-pointer allocator
+ * 
+ * Author: Khaidar Kairbek, Ava D. Rosenbaum
+ * Created: 10-18-2026
+ * Version: 1.0
+ * 
+ * Description: an arena hands out memory by advancing a pointer
+ * through large chunks, and frees it all at once when it is closed.
+ * It suits many small objects that live exactly as long as one
+ * structure, such as the terms of an index. An arena is not locked.
+ */
+#include <stddef.h>
+
+#define ARENA_CHUNK_SIZE (64 * 1024)
+
+typedef struct arena arena_t;
+
+/* 
+ * arena_open -- create an empty arena that allocates chunk_size bytes
+ * at a time (ARENA_CHUNK_SIZE if 0)
+ * returns NULL on failure
+ */
+arena_t *arena_open(size_t chunk_size);
+
+/* arena_close -- free every allocation made from the arena, and it */
+void arena_close(arena_t *ap);
+
+/* 
+ * arena_alloc -- size bytes, suitably aligned for any type; requests
+ * larger than a chunk get a chunk of their own
+ * returns NULL on failure
+ */
+void *arena_alloc(arena_t *ap, size_t size);
+
+/* 
+ * arena_strndup -- a NUL-terminated copy of the len characters at s
+ * returns NULL on failure
+ */
+char *arena_strndup(arena_t *ap, const char *s, size_t len);
+
+/* arena_used -- bytes handed out by the arena so far */
+size_t arena_used(arena_t *ap);
@@ -0,0 +1,109 @@
+/* 
+ * bqueue.c --- 
+ * 
+ * Author: Khaidar Kairbek, Ava D. Rosenbaum
+ * Created: 10-18-2026
+ * Version: 1.0
+ * 
+ * Description: Implementation of a bounded blocking queue
+ * 
+ */
+
+#include "bqueue.h"
+#include "queue.h"
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+struct bqueue {
+	queue_t *q;
+	int size;
+	int capacity;
+	bool shutdown;
+	pthread_mutex_t lock;
+	pthread_cond_t not_empty;
+	pthread_cond_t not_full;
+};
+
+// create an empty queue
+bqueue_t* bqopen(int capacity){
+	if (capacity < 1) return NULL;
+
+	bqueue_t *bqp = malloc(sizeof(bqueue_t));
+	if (!bqp) {
+		return NULL;
+	}
+	bqp->q = qopen();
+	if (bqp->q == NULL){
+		free(bqp);
+		return NULL;
+	}
+	bqp->size = 0;
+	bqp->capacity = capacity;
+	bqp->shutdown = false;
+	pthread_mutex_init(&(bqp->lock), NULL);
+	pthread_cond_init(&(bqp->not_empty), NULL);
+	pthread_cond_init(&(bqp->not_full), NULL);
+
+	return bqp;
+}
+
+// deallocate a queue
+void bqclose(bqueue_t *bqp){
+	if (bqp == NULL) return;
+	pthread_cond_destroy(&(bqp->not_full));
+	pthread_cond_destroy(&(bqp->not_empty));
+	pthread_mutex_destroy(&(bqp->lock));
+	qclose(bqp->q);
+	free(bqp);
+}
+
+// put element at end of queue, waiting for room
+int32_t bqput(bqueue_t *bqp, void *elementp){
+	if (bqp == NULL) return 1;
+
+	pthread_mutex_lock(&(bqp->lock));
+	while (bqp->size == bqp->capacity && !bqp->shutdown) {
+		pthread_cond_wait(&(bqp->not_full), &(bqp->lock));
+	}
+
+	int32_t put_status = 1;
+	if (!bqp->shutdown && (put_status = qput(bqp->q, elementp)) == 0) {
+		bqp->size++;
+		pthread_cond_signal(&(bqp->not_empty));
+	}
+	pthread_mutex_unlock(&(bqp->lock));
+
+	return put_status;
+}
+
+// get the first element from queue, waiting for one
+void* bqget(bqueue_t *bqp){
+	if (bqp == NULL) return NULL;
+
+	pthread_mutex_lock(&(bqp->lock));
+	while (bqp->size == 0 && !bqp->shutdown) {
+		pthread_cond_wait(&(bqp->not_empty), &(bqp->lock));
+	}
+
+	void *result = qget(bqp->q);
+	if (result != NULL) {
+		bqp->size--;
+		pthread_cond_signal(&(bqp->not_full));
+	}
+	pthread_mutex_unlock(&(bqp->lock));
+
+	return result;
+}
+
+// refuse further puts and release every waiter
+void bqshutdown(bqueue_t *bqp){
+	if (bqp == NULL) return;
+
+	pthread_mutex_lock(&(bqp->lock));
+	bqp->shutdown = true;
+	pthread_cond_broadcast(&(bqp->not_empty));
+	pthread_cond_broadcast(&(bqp->not_full));
+	pthread_mutex_unlock(&(bqp->lock));
+}
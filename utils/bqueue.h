@@ -0,0 +1,38 @@
+#pragma once
+/* 
+ * bqueue.h -- bounded, blocking queue for handing work between threads
+ *
+ * Author: Khaidar Kairbek, Ava D. Rosenbaum
+ * Created: 10-18-2026
+ * Version: 1.0
+ *
+ * Description: like lqueue, but bqput waits while the queue is full
+ * and bqget waits while it is empty, so a fast producer cannot run
+ * ahead of its consumers by more than capacity elements.
+ */
+#include <stdint.h>
+#include <queue.h>
+
+/* the queue representation is hidden from users of the module */
+typedef struct bqueue bqueue_t;
+
+/* create an empty queue holding at most capacity elements */
+bqueue_t* bqopen(int capacity);
+
+/* deallocate a queue; elements still in it are not freed */
+void bqclose(bqueue_t *bqp);
+
+/* put element at the end of the queue, waiting while it is full
+ * returns 0 if successful; nonzero if the queue has been shut down
+ */
+int32_t bqput(bqueue_t *bqp, void *elementp);
+
+/* get the first element, waiting while the queue is empty
+ * returns NULL once the queue has been shut down and drained
+ */
+void* bqget(bqueue_t *bqp);
+
+/* stop accepting elements and wake every waiting thread; elements
+ * already queued can still be taken with bqget
+ */
+void bqshutdown(bqueue_t *bqp);
@@ -0,0 +1,161 @@
+/* 
+ * checkpoint.c --- 
+ * 
+ * Author: Khaidar Kairbek, Ava D. Rosenbaum
+ * Created: 10-18-2026
+ * Version: 1.0
+ * 
+ * Description: Implementation of crawl checkpoints.
+ * 
+ */
+
+#define _POSIX_C_SOURCE 200809L   // fileno, fsync
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+#include "webpage.h"
+#include "urlset.h"
+#include "sched.h"
+#include "simhash.h"
+#include "checkpoint.h"
+
+#define CHECKPOINT_MAGIC "TSECKPT"
+#define CHECKPOINT_VERSION 3
+#define MAX_URL_LEN UINT16_MAX
+
+static FILE *ckpt_fp;
+static int ckpt_errors;
+
+static void write_str(const char *str) {
+	size_t len = strlen(str);
+	if (len > MAX_URL_LEN) {
+		ckpt_errors++;
+		return;
+	}
+	uint16_t len16 = (uint16_t) len;
+	if (fwrite(&len16, sizeof(len16), 1, ckpt_fp) != 1 ||
+			fwrite(str, 1, len, ckpt_fp) != len) {
+		ckpt_errors++;
+	}
+}
+
+static void save_page(void *ep) {
+	webpage_t *page = (webpage_t *) ep;
+	uint32_t depth = webpage_getDepth(page);
+	if (fwrite(&depth, sizeof(depth), 1, ckpt_fp) != 1) ckpt_errors++;
+	write_str(webpage_getURL(page));
+}
+
+int32_t checkpoint_save(char *path, sched_t *frontier, urlset_t *seen, simindex_t *near, int next_id) {
+	if (path == NULL || frontier == NULL || seen == NULL) return 1;
+
+	char tmp[300];
+	if (snprintf(tmp, sizeof(tmp), "%s.tmp", path) >= (int) sizeof(tmp)) {
+		printf("Error: checkpoint path too long: %s\n", path);
+		return 1;
+	}
+	ckpt_fp = fopen(tmp, "wb");
+	if (ckpt_fp == NULL) {
+		printf("Error: cannot open checkpoint %s\n", tmp);
+		return 2;
+	}
+
+	uint32_t header[3] = { CHECKPOINT_VERSION, next_id, schedsize(frontier) };
+
+	ckpt_errors = 0;
+	if (fwrite(CHECKPOINT_MAGIC, 1, sizeof(CHECKPOINT_MAGIC), ckpt_fp) != sizeof(CHECKPOINT_MAGIC) ||
+			fwrite(header, sizeof(header), 1, ckpt_fp) != 1) {
+		ckpt_errors++;
+	}
+	if (urlset_save(seen, ckpt_fp) != 0) ckpt_errors++;
+	schedapply(frontier, save_page);
+	uint64_t none = 0;
+	if (near != NULL ? simindex_save(near, ckpt_fp) != 0 : fwrite(&none, sizeof(none), 1, ckpt_fp) != 1) {
+		ckpt_errors++;
+	}
+
+	// the rename must not land before the data does
+	if (fflush(ckpt_fp) != 0 || fsync(fileno(ckpt_fp)) != 0) ckpt_errors++;
+	if (fclose(ckpt_fp) != 0) ckpt_errors++;
+
+	if (ckpt_errors > 0 || rename(tmp, path) != 0) {
+		printf("Error: failed writing checkpoint %s\n", path);
+		unlink(tmp);
+		return 3;
+	}
+	return 0;
+}
+
+// reads a string written by write_str into a new buffer
+static char *read_str(FILE *fp) {
+	uint16_t len;
+	if (fread(&len, sizeof(len), 1, fp) != 1) return NULL;
+
+	char *str = malloc(len + 1);
+	if (str == NULL) return NULL;
+	if (fread(str, 1, len, fp) != len) {
+		free(str);
+		return NULL;
+	}
+	str[len] = '\0';
+	return str;
+}
+
+int32_t checkpoint_load(char *path, sched_t *frontier, urlset_t *seen, simindex_t *near, int *next_id) {
+	if (path == NULL || frontier == NULL || seen == NULL || next_id == NULL) return 1;
+
+	FILE *fp = fopen(path, "rb");
+	if (fp == NULL) {
+		printf("Error: cannot open checkpoint %s\n", path);
+		return 2;
+	}
+
+	char magic[sizeof(CHECKPOINT_MAGIC)];
+	uint32_t header[3];
+	if (fread(magic, 1, sizeof(magic), fp) != sizeof(magic) ||
+			memcmp(magic, CHECKPOINT_MAGIC, sizeof(magic)) != 0 ||
+			fread(header, sizeof(header), 1, fp) != 1 ||
+			header[0] != CHECKPOINT_VERSION) {
+		printf("Error: %s is not a checkpoint\n", path);
+		fclose(fp);
+		return 3;
+	}
+
+	*next_id = header[1];
+
+	if (urlset_load(seen, fp) != 0) {
+		printf("Error: checkpoint %s is truncated\n", path);
+		fclose(fp);
+		return 4;
+	}
+
+	for (uint32_t i = 0; i < header[2]; i++) {
+		uint32_t depth;
+		char *url = NULL;
+		webpage_t *page = NULL;
+		if (fread(&depth, sizeof(depth), 1, fp) != 1 ||
+				(url = read_str(fp)) == NULL ||
+				(page = webpage_new(url, depth, NULL)) == NULL ||
+				schedput(frontier, page) != 0) {
+			printf("Error: checkpoint %s is truncated\n", path);
+			webpage_delete(page);
+			free(url);
+			fclose(fp);
+			return 4;
+		}
+		free(url);
+	}
+
+	// a crawl not keeping SimHashes now leaves the saved ones behind
+	if (near != NULL && simindex_load(near, fp) != 0) {
+		printf("Error: checkpoint %s is truncated\n", path);
+		fclose(fp);
+		return 4;
+	}
+
+	fclose(fp);
+	return 0;
+}
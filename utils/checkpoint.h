@@ -0,0 +1,39 @@
+#pragma once
+/* 
+ * checkpoint.h --- saving and restoring the state of a crawl
+ * 
+ * Author: Khaidar Kairbek, Ava D. Rosenbaum
+ * Created: 10-18-2026
+ * Version: 1.0
+ * 
+ * Description: a checkpoint holds the id the next saved page will get,
+ * the fingerprints of every url seen, every page still in the
+ * frontier and the SimHashes of the pages saved, if the crawl keeps
+ * them. Together with the pages already saved that is all a crawl
+ * needs to carry on where it stopped.
+ *
+ * The file is binary (native byte order), starting with:
+ *   "TSECKPT" '\0' <version:u32> <next id:u32> <#frontier:u32>
+ * followed by the seen-set as written by urlset_save, the frontier
+ * pages as <depth:u32><len:u16><url bytes>, and the SimHash index as
+ * written by simindex_save (a count of 0 when there is none).
+ */
+#include <stdint.h>
+#include <urlset.h>
+#include <sched.h>
+#include <simhash.h>
+
+/* 
+ * checkpoint_save -- write the crawl state to path; near may be NULL
+ * when the crawl keeps no SimHashes. The old checkpoint is only
+ * replaced once the new one is safely on disk
+ * returns 0 for success; nonzero otherwise
+ */
+int32_t checkpoint_save(char *path, sched_t *frontier, urlset_t *seen, simindex_t *near, int next_id);
+
+/* 
+ * checkpoint_load -- read the crawl state in path into an empty
+ * frontier, seen-set and, unless it is NULL, SimHash index
+ * returns 0 for success; nonzero otherwise
+ */
+int32_t checkpoint_load(char *path, sched_t *frontier, urlset_t *seen, simindex_t *near, int *next_id);
@@ -0,0 +1,198 @@
+/*
+ * docstore.c ---
+ *
+ * Author: Khaidar Kairbek, Ava D. Rosenbaum
+ * Created: 10-18-2026
+ * Version: 1.0
+ *
+ * Description: Implementation of the docstore. The writer streams the
+ * urls to the file and keeps only the table in memory; the reader
+ * checks an entry against the size of the map before following it.
+ *
+ */
+
+#define _POSIX_C_SOURCE 200809L   // mmap
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "docstore.h"
+
+struct docstore_writer {
+	FILE *fp;
+	uint64_t offset;            // where the next url goes
+	docstore_entry_t *table;    // table[id - 1]
+	uint64_t maxid;
+	uint64_t capacity;
+	uint64_t ndocs;
+	uint64_t total_terms;
+	bool failed;
+};
+
+struct docstore {
+	const uint8_t *base;
+	size_t len;
+	docstore_header_t header;
+	const docstore_entry_t *table;
+};
+
+char *docstore_file(char *indexnm) {
+	char *name = malloc(strlen(indexnm) + 8);
+	if (name != NULL) sprintf(name, "%s.docs", indexnm);
+	return name;
+}
+
+docstore_writer_t *docstore_writer_open(char *docsnm) {
+	if (docsnm == NULL) return NULL;
+	docstore_writer_t *dwp = calloc(1, sizeof(docstore_writer_t));
+	if (dwp == NULL) return NULL;
+
+	dwp->fp = fopen(docsnm, "w");
+	if (dwp->fp == NULL) {
+		printf("Error: could not create docstore %s\n", docsnm);
+		free(dwp);
+		return NULL;
+	}
+
+	// the header is written last, once the table is placed
+	docstore_header_t header = { 0 };
+	if (fwrite(&header, sizeof(header), 1, dwp->fp) != 1) dwp->failed = true;
+	dwp->offset = sizeof(header);
+	return dwp;
+}
+
+int32_t docstore_writer_add(docstore_writer_t *dwp, uint64_t id, const docstore_doc_t *doc) {
+	if (dwp == NULL || doc == NULL || doc->url == NULL) return -1;
+	size_t url_len = strlen(doc->url);
+	if (dwp->failed || id <= dwp->maxid || url_len == 0 || url_len > UINT32_MAX) {
+		dwp->failed = true;
+		return -1;
+	}
+
+	if (id > dwp->capacity) {
+		uint64_t capacity = dwp->capacity ? dwp->capacity : 1024;
+		while (capacity < id) capacity *= 2;
+		docstore_entry_t *table = realloc(dwp->table, capacity * sizeof(docstore_entry_t));
+		if (table == NULL) {
+			dwp->failed = true;
+			return -1;
+		}
+		dwp->table = table;
+		dwp->capacity = capacity;
+	}
+	memset(dwp->table + dwp->maxid, 0, (id - dwp->maxid) * sizeof(docstore_entry_t));
+	dwp->table[id - 1] = (docstore_entry_t) { .url = dwp->offset, .url_len = url_len, .depth = doc->depth,
+																						 .length = doc->length, .terms = doc->terms };
+	dwp->maxid = id;
+	dwp->ndocs++;
+	dwp->total_terms += doc->terms;
+
+	if (fwrite(doc->url, url_len + 1, 1, dwp->fp) != 1) {
+		dwp->failed = true;
+		return -1;
+	}
+	dwp->offset += url_len + 1;
+	return 0;
+}
+
+int32_t docstore_writer_close(docstore_writer_t *dwp) {
+	if (dwp == NULL) return -1;
+	bool ok = !dwp->failed;
+
+	// the table is aligned so that a mapped docstore can use it in place
+	while (ok && dwp->offset % sizeof(uint64_t) != 0) {
+		ok = fputc('\0', dwp->fp) != EOF;
+		dwp->offset++;
+	}
+	docstore_header_t header = { .version = DOCSTORE_VERSION, .maxid = dwp->maxid, .table_offset = dwp->offset,
+															 .ndocs = dwp->ndocs, .total_terms = dwp->total_terms };
+	memcpy(header.magic, DOCSTORE_MAGIC, sizeof(DOCSTORE_MAGIC));
+	if (ok && dwp->maxid > 0 && fwrite(dwp->table, sizeof(docstore_entry_t), dwp->maxid, dwp->fp) != dwp->maxid) ok = false;
+	if (ok && (fseek(dwp->fp, 0, SEEK_SET) != 0 || fwrite(&header, sizeof(header), 1, dwp->fp) != 1)) ok = false;
+	if (fclose(dwp->fp) != 0) ok = false;
+	if (!ok) printf("Error: could not write docstore\n");
+
+	free(dwp->table);
+	free(dwp);
+	return ok ? 0 : -1;
+}
+
+docstore_t *docstore_open(char *docsnm) {
+	if (docsnm == NULL) return NULL;
+	int fd = open(docsnm, O_RDONLY);
+	if (fd < 0) return NULL;
+	struct stat st;
+	if (fstat(fd, &st) != 0 || (size_t) st.st_size < sizeof(DOCSTORE_MAGIC) + sizeof(uint32_t)) {
+		printf("Error: docstore %s is corrupt\n", docsnm);
+		close(fd);
+		return NULL;
+	}
+
+	void *base = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+	close(fd);                 // the mapping keeps the file
+	if (base == MAP_FAILED) {
+		printf("Error: could not map docstore %s\n", docsnm);
+		return NULL;
+	}
+
+	docstore_t *dsp = malloc(sizeof(docstore_t));
+	if (dsp == NULL) {
+		munmap(base, st.st_size);
+		return NULL;
+	}
+	dsp->base = base;
+	dsp->len = st.st_size;
+
+	// a version 1 header is shorter; only its magic and version are looked at
+	docstore_header_t *hp = &dsp->header;
+	memcpy(hp, base, dsp->len < sizeof(docstore_header_t) ? dsp->len : sizeof(docstore_header_t));
+	if (memcmp(hp->magic, DOCSTORE_MAGIC, sizeof(DOCSTORE_MAGIC)) != 0 || hp->version != DOCSTORE_VERSION) {
+		docstore_close(dsp);
+		return NULL;
+	}
+	if (dsp->len < sizeof(docstore_header_t) || hp->table_offset < sizeof(docstore_header_t) ||
+			hp->table_offset > dsp->len || hp->table_offset % sizeof(uint64_t) != 0 ||
+			hp->maxid > (dsp->len - hp->table_offset) / sizeof(docstore_entry_t) || hp->ndocs > hp->maxid) {
+		printf("Error: docstore %s is corrupt\n", docsnm);
+		docstore_close(dsp);
+		return NULL;
+	}
+	dsp->table = (const docstore_entry_t *) (dsp->base + hp->table_offset);
+	return dsp;
+}
+
+void docstore_close(docstore_t *dsp) {
+	if (dsp == NULL) return;
+	munmap((void *) dsp->base, dsp->len);
+	free(dsp);
+}
+
+uint64_t docstore_maxid(docstore_t *dsp) {
+	return dsp == NULL ? 0 : dsp->header.maxid;
+}
+
+uint64_t docstore_ndocs(docstore_t *dsp) {
+	return dsp == NULL ? 0 : dsp->header.ndocs;
+}
+
+uint64_t docstore_total_terms(docstore_t *dsp) {
+	return dsp == NULL ? 0 : dsp->header.total_terms;
+}
+
+bool docstore_get(docstore_t *dsp, uint64_t id, docstore_doc_t *doc) {
+	if (dsp == NULL || doc == NULL || id < 1 || id > dsp->header.maxid) return false;
+
+	const docstore_entry_t *entry = &dsp->table[id - 1];
+	if (entry->url_len == 0 || entry->url < sizeof(docstore_header_t) || entry->url >= dsp->len ||
+			entry->url_len >= dsp->len - entry->url || dsp->base[entry->url + entry->url_len] != '\0') {
+		return false;
+	}
+	*doc = (docstore_doc_t) { .url = (const char *) dsp->base + entry->url, .depth = entry->depth,
+														.length = entry->length, .terms = entry->terms };
+	return true;
+}
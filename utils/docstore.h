@@ -0,0 +1,108 @@
+#pragma once
+/*
+ * docstore.h --- what the querier needs of each page, next to the index
+ *
+ * Author: Khaidar Kairbek, Ava D. Rosenbaum
+ * Created: 10-18-2026
+ * Version: 1.0
+ *
+ * Description: a docstore holds the url, depth and length of every
+ * indexed page, so that the querier can name its results without
+ * opening a page, and the statistics a relevance model needs: the
+ * number of terms indexed on each page, and the totals over all of
+ * them. The indexer writes it as <indexnm>.docs:
+ *
+ *   header   a docstore_header_t
+ *   heap     the urls, each NUL-terminated
+ *   table    from table_offset, aligned, a docstore_entry_t for each
+ *            id from 1 to maxid, at position id - 1; an entry with no
+ *            url marks an id with no page
+ *
+ * A reader maps the file and finds the entry of an id by its position,
+ * so a lookup costs the same for any number of pages, and opening one
+ * reads nothing but the header. Lookups do not change the map, so
+ * threads may share one. Version 1 docstores, without the statistics,
+ * are not mapped; the index has to be built again.
+ */
+#include <stdint.h>
+#include <stdbool.h>
+
+#define DOCSTORE_MAGIC "TSEDOCS"
+#define DOCSTORE_VERSION 2
+
+typedef struct docstore_header {
+	char magic[8];
+	uint32_t version;
+	uint32_t reserved;
+	uint64_t maxid;
+	uint64_t table_offset;
+	uint64_t ndocs;         // pages in the table
+	uint64_t total_terms;   // terms indexed over all of them
+} docstore_header_t;
+
+typedef struct docstore_entry {
+	uint64_t url;           // where the url starts, from the start of the file
+	uint32_t url_len;       // 0 for an id with no page
+	uint32_t depth;
+	uint32_t length;        // of the html, in bytes
+	uint32_t terms;         // words indexed on the page, repeats included
+} docstore_entry_t;
+
+/* docstore_doc_t -- a page as the docstore has it; url points into the map */
+typedef struct docstore_doc {
+	const char *url;
+	uint32_t depth;
+	uint32_t length;
+	uint32_t terms;
+} docstore_doc_t;
+
+typedef struct docstore docstore_t;
+typedef struct docstore_writer docstore_writer_t;
+
+/*
+ * docstore_writer_open -- start writing the docstore docsnm
+ * returns NULL on failure
+ */
+docstore_writer_t *docstore_writer_open(char *docsnm);
+
+/*
+ * docstore_writer_add -- add page id, with ids ascending
+ * returns 0 for success; -1 otherwise, and the close fails too
+ */
+int32_t docstore_writer_add(docstore_writer_t *dwp, uint64_t id, const docstore_doc_t *doc);
+
+/*
+ * docstore_writer_close -- write the table and close the docstore
+ * returns 0 for success; -1 if any step of the writing failed
+ */
+int32_t docstore_writer_close(docstore_writer_t *dwp);
+
+/*
+ * docstore_open -- map the docstore docsnm
+ * returns NULL if it is missing or corrupt
+ */
+docstore_t *docstore_open(char *docsnm);
+
+/* docstore_close -- unmap the docstore */
+void docstore_close(docstore_t *dsp);
+
+/* docstore_maxid -- the highest id the table covers */
+uint64_t docstore_maxid(docstore_t *dsp);
+
+/* docstore_ndocs -- the number of pages */
+uint64_t docstore_ndocs(docstore_t *dsp);
+
+/* docstore_total_terms -- the number of terms indexed over every page */
+uint64_t docstore_total_terms(docstore_t *dsp);
+
+/*
+ * docstore_get -- the page saved under id
+ * returns false if there is none, or its entry is corrupt
+ */
+bool docstore_get(docstore_t *dsp, uint64_t id, docstore_doc_t *doc);
+
+/*
+ * docstore_file -- the name of the docstore of the index indexnm, in a
+ * new buffer the caller must free
+ */
+char *docstore_file(char *indexnm);
@@ -0,0 +1,166 @@
+/* 
+ * fetch.c --- 
+ * 
+ * Author: Khaidar Kairbek, Ava D. Rosenbaum
+ * Created: 10-18-2026
+ * Version: 1.0
+ * 
+ * Description: Implementation of the curl_multi fetch engine. Every
+ * slot owns one easy handle for the lifetime of the fetcher, so handles
+ * are set up once and the multi handle's connection cache is shared by
+ * all transfers.
+ * 
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <curl/curl.h>
+#include "webpage.h"
+#include "fetch.h"
+
+#define FETCH_MAX_TRY 3
+#define FETCH_CONNECT_TIMEOUT_MS 10000L
+
+typedef struct transfer {
+	CURL *handle;
+	webpage_t *page;                  // NULL while the slot is free
+	int tries;
+	char errbuf[CURL_ERROR_SIZE];
+} transfer_t;
+
+struct fetcher {
+	CURLM *multi;
+	transfer_t *slots;
+	transfer_t **free_slots;          // stack of unused slots
+	int nslots;
+	int nfree;
+	long timeout_ms;
+	fetch_done_fn done;
+	void *arg;
+};
+
+fetcher_t *fetcher_open(int max_inflight, long timeout_ms, fetch_done_fn done, void *arg) {
+	if (max_inflight < 1 || done == NULL) return NULL;
+
+	fetcher_t *fp = calloc(1, sizeof(fetcher_t));
+	if (fp == NULL) return NULL;
+
+	fp->slots = calloc(max_inflight, sizeof(transfer_t));
+	fp->free_slots = calloc(max_inflight, sizeof(transfer_t *));
+	fp->multi = curl_multi_init();
+	if (fp->slots == NULL || fp->free_slots == NULL || fp->multi == NULL) {
+		fetcher_close(fp);
+		return NULL;
+	}
+
+	fp->nslots = max_inflight;
+	fp->timeout_ms = timeout_ms;
+	fp->done = done;
+	fp->arg = arg;
+
+	for (int i = 0; i < max_inflight; i++) {
+		fp->slots[i].handle = curl_easy_init();
+		if (fp->slots[i].handle == NULL) {
+			fetcher_close(fp);
+			return NULL;
+		}
+		curl_easy_setopt(fp->slots[i].handle, CURLOPT_PRIVATE, &fp->slots[i]);
+		fp->free_slots[fp->nfree++] = &fp->slots[i];
+	}
+
+	// keep one idle connection around per slot for reuse
+	curl_multi_setopt(fp->multi, CURLMOPT_MAXCONNECTS, (long) max_inflight);
+
+	return fp;
+}
+
+// (re)starts the transfer held by slot t
+static int32_t start_transfer(fetcher_t *fp, transfer_t *t) {
+	webpage_prepare(t->page, t->handle, t->errbuf);
+	curl_easy_setopt(t->handle, CURLOPT_TIMEOUT_MS, fp->timeout_ms);
+	curl_easy_setopt(t->handle, CURLOPT_CONNECTTIMEOUT_MS, FETCH_CONNECT_TIMEOUT_MS);
+
+	return curl_multi_add_handle(fp->multi, t->handle) == CURLM_OK ? 0 : 2;
+}
+
+int32_t fetcher_add(fetcher_t *fp, webpage_t *page) {
+	if (fp == NULL || page == NULL) return 2;
+	if (fp->nfree == 0) return 1;
+
+	transfer_t *t = fp->free_slots[--fp->nfree];
+	t->page = page;
+	t->tries = 0;
+
+	if (start_transfer(fp, t) != 0) {
+		t->page = NULL;
+		fp->free_slots[fp->nfree++] = t;
+		return 2;
+	}
+
+	return 0;
+}
+
+int fetcher_inflight(fetcher_t *fp) {
+	return fp ? fp->nslots - fp->nfree : 0;
+}
+
+int fetcher_perform(fetcher_t *fp, int wait_ms) {
+	if (fp == NULL) return -1;
+
+	int running;
+	if (curl_multi_poll(fp->multi, NULL, 0, wait_ms, NULL) != CURLM_OK ||
+			curl_multi_perform(fp->multi, &running) != CURLM_OK) {
+		return -1;
+	}
+
+	int completed = 0;
+	int left;
+	CURLMsg *msg;
+	while ((msg = curl_multi_info_read(fp->multi, &left)) != NULL) {
+		if (msg->msg != CURLMSG_DONE) continue;
+
+		transfer_t *t;
+		CURLcode res = msg->data.result;
+		curl_easy_getinfo(msg->easy_handle, CURLINFO_PRIVATE, (char **) &t);
+		curl_multi_remove_handle(fp->multi, t->handle);
+
+		if (res != CURLE_OK && ++t->tries < FETCH_MAX_TRY && start_transfer(fp, t) == 0) {
+			continue;
+		}
+
+		webpage_t *page = t->page;
+		bool ok = webpage_complete(page, res, t->errbuf);
+
+		// free the slot first so that done can add another page
+		curl_easy_reset(t->handle);
+		curl_easy_setopt(t->handle, CURLOPT_PRIVATE, t);
+		t->page = NULL;
+		fp->free_slots[fp->nfree++] = t;
+
+		fp->done(page, ok, fp->arg);
+		completed++;
+	}
+
+	return completed;
+}
+
+void fetcher_close(fetcher_t *fp) {
+	if (fp == NULL) return;
+
+	for (int i = 0; fp->slots != NULL && i < fp->nslots; i++) {
+		transfer_t *t = &fp->slots[i];
+		if (t->handle == NULL) continue;
+		if (t->page != NULL) {
+			curl_multi_remove_handle(fp->multi, t->handle);
+			webpage_delete(t->page);
+		}
+		curl_easy_cleanup(t->handle);
+	}
+
+	if (fp->multi) curl_multi_cleanup(fp->multi);
+	free(fp->free_slots);
+	free(fp->slots);
+	free(fp);
+}
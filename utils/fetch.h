@@ -0,0 +1,50 @@
+#pragma once
+/* 
+ * fetch.h --- asynchronous page fetching on libcurl's multi interface
+ * 
+ * Author: Khaidar Kairbek, Ava D. Rosenbaum
+ * Created: 10-18-2026
+ * Version: 1.0
+ * 
+ * Description: a fetcher keeps up to max_inflight transfers running at
+ * once on the calling thread. Connections are kept alive and reused
+ * between transfers to the same host. Every finished page is handed to
+ * the done callback, which owns it from then on and may add more pages.
+ * 
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <webpage.h>
+
+typedef struct fetcher fetcher_t;
+
+/* called once per page added; ok is as webpage_fetch would return */
+typedef void (*fetch_done_fn)(webpage_t *page, bool ok, void *arg);
+
+/* 
+ * fetcher_open -- create a fetcher for at most max_inflight transfers,
+ * each limited to timeout_ms (0 for no limit)
+ * returns NULL on failure
+ */
+fetcher_t *fetcher_open(int max_inflight, long timeout_ms, fetch_done_fn done, void *arg);
+
+/* 
+ * fetcher_add -- start fetching page; its html must not be set yet
+ * returns 0 on success; 1 if max_inflight transfers are running;
+ * 2 on failure
+ */
+int32_t fetcher_add(fetcher_t *fp, webpage_t *page);
+
+/* fetcher_inflight -- number of transfers added but not yet done */
+int fetcher_inflight(fetcher_t *fp);
+
+/* 
+ * fetcher_perform -- waits up to wait_ms for network activity, moves
+ * every transfer forward and calls done for each one that finished
+ * returns the number of pages handed to done; -1 on failure
+ */
+int fetcher_perform(fetcher_t *fp, int wait_ms);
+
+/* fetcher_close -- abort any running transfers (their pages are deleted) */
+void fetcher_close(fetcher_t *fp);
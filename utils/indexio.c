@@ -15,25 +15,430 @@
 #include <string.h>
 #include "hash.h"
 #include "queue.h"
+#include "varint.h"
 #include "indexio.h"
+#include "posindex.h"
+
+#define HEADER_LEN_V1 32
+#define HEADER_LEN ((int) sizeof(index_header_t))
+
+#define WRITER_BUFFER_LEN 65536
+
+/*
+ * buffer_t -- bytes built up in memory
+ */
+typedef struct buffer {
+	uint8_t *data;
+	size_t len;
+	size_t capacity;
+} buffer_t;
+
+struct indexwriter {
+	FILE *fp;
+	FILE *lexicon;        // the lexicon, spilled until close
+	FILE *blocks;         // the block table, spilled until close
+	char *lexiconnm;
+	char *blocksnm;
+	index_header_t header;
+	uint64_t offset;      // where the next postings go
+	uint64_t lexicon_len;
+	uint8_t out[WRITER_BUFFER_LEN];    // postings not yet written to fp
+	size_t outlen;
+	char *last;           // the term being written, then the one before the next
+	size_t shared;        // characters it shares with the term before it
+	uint64_t term_offset; // where its postings start
+	uint64_t ndocs;       // its postings so far
+	uint64_t previous;    // the id of its last posting
+	bool in_term;
+	bool failed;
+};
 
 static FILE *index_fp;
 static uint64_t INDEXER_HASH_TABLE_SIZE = 100;
 
-void print_doc(void *ep_doc){
-	document_t *doc = (document_t *) ep_doc;
-	fprintf(index_fp, " %lu %lu", doc->id, doc->count);
+word_index_t *word_index_new(const char *word, int len){
+	if (word == NULL || len < 0) return NULL;
+	word_index_t *record = malloc(sizeof(word_index_t));
+	if (record == NULL) return NULL;
+
+	record->word = malloc(len + 1);
+	if (record->word == NULL) {
+		free(record);
+		return NULL;
+	}
+	memcpy(record->word, word, len);
+	record->word[len] = '\0';
+	record->docs = NULL;
+	record->ndocs = 0;
+	record->capacity = 0;
+	record->positions = NULL;
+	record->positions_len = 0;
+	record->positions_capacity = 0;
+	record->last_position = 0;
+	return record;
+}
+
+void word_index_free(word_index_t *record){
+	if (record == NULL) return;
+	free(record->docs);
+	free(record->positions);
+	free(record->word);
+	free(record);
+}
+
+// makes room for at least need postings, doubling the array
+static bool postings_reserve(word_index_t *record, uint64_t need){
+	if (need <= record->capacity) return true;
+	if (need > UINT32_MAX) return false;
+
+	uint64_t capacity = record->capacity > 0 ? record->capacity : 4;
+	while (capacity < need) capacity *= 2;
+	if (capacity > UINT32_MAX) capacity = UINT32_MAX;
+
+	document_t *docs = realloc(record->docs, capacity * sizeof(document_t));
+	if (docs == NULL) return false;
+	record->docs = docs;
+	record->capacity = (uint32_t) capacity;
+	return true;
+}
+
+bool postings_add(word_index_t *record, uint64_t id){
+	if (record == NULL) return false;
+	if (record->ndocs > 0 && record->docs[record->ndocs - 1].id == id) {
+		record->docs[record->ndocs - 1].count += 1;
+		return true;
+	}
+	return postings_append(record, id, 1);
+}
+
+bool postings_append(word_index_t *record, uint64_t id, uint64_t count){
+	if (record == NULL) return false;
+	if (!postings_reserve(record, (uint64_t) record->ndocs + 1)) return false;
+	record->docs[record->ndocs].id = id;
+	record->docs[record->ndocs].count = count;
+	record->ndocs++;
+	return true;
+}
+
+// makes room for len more bytes of positions, doubling the buffer
+static bool positions_reserve(word_index_t *record, uint64_t len){
+	if (record->positions_capacity - record->positions_len >= len) return true;
+	uint64_t capacity = record->positions_capacity > 0 ? record->positions_capacity : 16;
+	while (capacity - record->positions_len < len) capacity *= 2;
+	uint8_t *positions = realloc(record->positions, capacity);
+	if (positions == NULL) return false;
+	record->positions = positions;
+	record->positions_capacity = capacity;
+	return true;
+}
+
+bool positions_add(word_index_t *record, uint32_t position){
+	if (record == NULL || record->ndocs == 0) return false;
+	if (!positions_reserve(record, VARINT_MAX_LEN)) return false;
+
+	// the first position of a posting is stored whole, the others as gaps
+	uint32_t gap = record->docs[record->ndocs - 1].count > 1 ? position - record->last_position : position;
+	record->positions_len += varint_put(record->positions + record->positions_len, gap);
+	record->last_position = position;
+	return true;
+}
+
+bool postings_concat(word_index_t *dst, const word_index_t *src){
+	if (dst == NULL || src == NULL) return false;
+	if (src->ndocs == 0) return true;
+	if (!postings_reserve(dst, (uint64_t) dst->ndocs + src->ndocs)) return false;
+	if (src->positions_len > 0 && !positions_reserve(dst, src->positions_len)) return false;
+	memcpy(dst->docs + dst->ndocs, src->docs, src->ndocs * sizeof(document_t));
+	dst->ndocs += src->ndocs;
+	if (src->positions_len > 0) {
+		memcpy(dst->positions + dst->positions_len, src->positions, src->positions_len);
+		dst->positions_len += src->positions_len;
+		dst->last_position = src->last_position;
+	}
+	return true;
+}
+
+document_t *postings_find(const word_index_t *record, uint64_t id){
+	if (record == NULL) return NULL;
+	uint32_t lo = 0, hi = record->ndocs;
+	while (lo < hi) {
+		uint32_t mid = lo + (hi - lo) / 2;
+		if (record->docs[mid].id < id) lo = mid + 1;
+		else hi = mid;
+	}
+	if (lo < record->ndocs && record->docs[lo].id == id) return &record->docs[lo];
+	return NULL;
+}
+
+// makes room for len more bytes
+static bool buffer_reserve(buffer_t *bp, size_t len){
+	if (bp->capacity - bp->len >= len) return true;
+	size_t capacity = bp->capacity > 0 ? bp->capacity : 256;
+	while (capacity - bp->len < len) capacity *= 2;
+	uint8_t *data = realloc(bp->data, capacity);
+	if (data == NULL) return false;
+	bp->data = data;
+	bp->capacity = capacity;
+	return true;
+}
+
+static bool buffer_bytes(buffer_t *bp, const void *p, size_t len){
+	if (!buffer_reserve(bp, len)) return false;
+	memcpy(bp->data + bp->len, p, len);
+	bp->len += len;
+	return true;
+}
+
+// a temporary file next to the index, removed once closed
+static FILE *spill_open(char *indexnm, const char *suffix, char **name){
+	*name = malloc(strlen(indexnm) + strlen(suffix) + 1);
+	if (*name == NULL) return NULL;
+	sprintf(*name, "%s%s", indexnm, suffix);
+	FILE *fp = fopen(*name, "w+");
+	if (fp == NULL) printf("Error: could not create %s\n", *name);
+	return fp;
+}
+
+static void spill_close(FILE *fp, char *name){
+	if (fp != NULL) {
+		fclose(fp);
+		remove(name);
+	}
+	free(name);
+}
+
+// appends what was spilled to src to the index
+static bool spill_copy(indexwriter_t *iwp, FILE *src){
+	if (fflush(src) != 0 || fseek(src, 0, SEEK_SET) != 0) return false;
+	size_t n;
+	while ((n = fread(iwp->out, 1, WRITER_BUFFER_LEN, src)) > 0) {
+		if (fwrite(iwp->out, n, 1, iwp->fp) != 1) return false;
+	}
+	return !ferror(src);
+}
+
+static bool flush_postings(indexwriter_t *iwp){
+	if (iwp->outlen > 0 && fwrite(iwp->out, iwp->outlen, 1, iwp->fp) != 1) {
+		printf("Error: could not write index\n");
+		return false;
+	}
+	iwp->outlen = 0;
+	return true;
+}
+
+static int32_t writer_failed(indexwriter_t *iwp){
+	iwp->failed = true;
+	return -1;
+}
+
+indexwriter_t *indexwriter_open(char *indexnm){
+	if (indexnm == NULL) return NULL;
+	indexwriter_t *iwp = calloc(1, sizeof(indexwriter_t));
+	if (iwp == NULL) return NULL;
+
+	iwp->fp = fopen(indexnm, "w");
+	if (iwp->fp == NULL) {
+		printf("Error: fopen failed\n");
+		free(iwp);
+		return NULL;
+	}
+	iwp->lexicon = spill_open(indexnm, ".lexicon.tmp", &iwp->lexiconnm);
+	iwp->blocks = spill_open(indexnm, ".blocks.tmp", &iwp->blocksnm);
+	if (iwp->lexicon == NULL || iwp->blocks == NULL) iwp->failed = true;
+	memcpy(iwp->header.magic, INDEX_MAGIC, sizeof(INDEX_MAGIC));
+	iwp->header.version = INDEX_VERSION;
+	iwp->header.block_terms = INDEX_BLOCK_TERMS;
+	iwp->offset = HEADER_LEN;
+
+	// the header is written last, once the counts are known
+	uint8_t zeros[HEADER_LEN] = { 0 };
+	if (fwrite(zeros, HEADER_LEN, 1, iwp->fp) != 1) iwp->failed = true;
+	return iwp;
+}
+
+int32_t indexwriter_begin(indexwriter_t *iwp, const char *word){
+	if (iwp == NULL || word == NULL || iwp->failed || iwp->in_term) return -1;
+	if (iwp->header.nterms > 0 && strcmp(iwp->last, word) >= 0) {
+		printf("Error: index term '%s' out of order\n", word);
+		return writer_failed(iwp);
+	}
+
+	// the first term of a block shares nothing, so it can be read on its own
+	size_t len = strlen(word);
+	iwp->shared = 0;
+	if (iwp->header.nterms % INDEX_BLOCK_TERMS != 0) {
+		while (iwp->shared < len && iwp->last[iwp->shared] == word[iwp->shared]) iwp->shared++;
+	}
+	char *last = realloc(iwp->last, len + 1);
+	if (last == NULL) return writer_failed(iwp);
+	memcpy(last, word, len + 1);
+	iwp->last = last;
+
+	iwp->term_offset = iwp->offset;
+	iwp->ndocs = 0;
+	iwp->previous = 0;
+	iwp->in_term = true;
+	return 0;
+}
+
+int32_t indexwriter_posting(indexwriter_t *iwp, uint64_t id, uint64_t count){
+	if (iwp == NULL || iwp->failed || !iwp->in_term) return -1;
+	if (iwp->ndocs > 0 && id <= iwp->previous) {
+		printf("Error: postings of '%s' out of order\n", iwp->last);
+		return writer_failed(iwp);
+	}
+	if (iwp->ndocs == UINT32_MAX) return writer_failed(iwp);
+
+	if (WRITER_BUFFER_LEN - iwp->outlen < 2 * VARINT_MAX_LEN && !flush_postings(iwp)) return writer_failed(iwp);
+	size_t n = varint_put(iwp->out + iwp->outlen, id - iwp->previous);
+	n += varint_put(iwp->out + iwp->outlen + n, count);
+	iwp->outlen += n;
+	iwp->offset += n;
+	iwp->previous = id;
+	iwp->ndocs++;
+	return 0;
+}
+
+int32_t indexwriter_end(indexwriter_t *iwp){
+	if (iwp == NULL || iwp->failed || !iwp->in_term) return -1;
+	iwp->in_term = false;
+
+	if (iwp->header.nterms % INDEX_BLOCK_TERMS == 0) {
+		index_block_t block = { .entry = iwp->lexicon_len, .postings = iwp->term_offset };
+		if (fwrite(&block, sizeof(block), 1, iwp->blocks) != 1) return writer_failed(iwp);
+	}
+
+	size_t len = strlen(iwp->last);
+	uint8_t head[3 * VARINT_MAX_LEN], tail[2 * VARINT_MAX_LEN];
+	size_t nhead = varint_put(head, iwp->shared);
+	nhead += varint_put(head + nhead, len - iwp->shared);
+	size_t ntail = varint_put(tail, iwp->ndocs);
+	ntail += varint_put(tail + ntail, iwp->offset - iwp->term_offset);
+	if (fwrite(head, nhead, 1, iwp->lexicon) != 1 ||
+			(len > iwp->shared && fwrite(iwp->last + iwp->shared, len - iwp->shared, 1, iwp->lexicon) != 1) ||
+			fwrite(tail, ntail, 1, iwp->lexicon) != 1) {
+		printf("Error: could not write index lexicon\n");
+		return writer_failed(iwp);
+	}
+	iwp->lexicon_len += nhead + (len - iwp->shared) + ntail;
+	iwp->header.nterms++;
+	return 0;
+}
+
+int32_t indexwriter_add(indexwriter_t *iwp, const char *word, const document_t *docs, uint32_t ndocs){
+	if (iwp == NULL || word == NULL || (docs == NULL && ndocs > 0)) return -1;
+	if (indexwriter_begin(iwp, word) != 0) return -1;
+	for (uint32_t i = 0; i < ndocs; i++) {
+		if (indexwriter_posting(iwp, docs[i].id, docs[i].count) != 0) return -1;
+	}
+	return indexwriter_end(iwp);
+}
+
+int32_t indexwriter_close(indexwriter_t *iwp){
+	if (iwp == NULL) return -1;
+	bool ok = !iwp->failed && !iwp->in_term && flush_postings(iwp);
+
+	// the lexicon and the table follow the postings; the table is
+	// aligned so that a mapped index can use it in place
+	iwp->header.dict_offset = iwp->offset;
+	if (ok) ok = spill_copy(iwp, iwp->lexicon);
+	uint64_t end = iwp->offset + iwp->lexicon_len;
+	while (ok && end % sizeof(uint64_t) != 0) {
+		ok = fputc('\0', iwp->fp) != EOF;
+		end++;
+	}
+	iwp->header.table_offset = end;
+	if (ok) ok = spill_copy(iwp, iwp->blocks);
+	if (ok && (fseek(iwp->fp, 0, SEEK_SET) != 0 || fwrite(&iwp->header, HEADER_LEN, 1, iwp->fp) != 1)) ok = false;
+	if (fclose(iwp->fp) != 0) ok = false;
+	if (!ok) printf("Error: could not write index\n");
+
+	spill_close(iwp->lexicon, iwp->lexiconnm);
+	spill_close(iwp->blocks, iwp->blocksnm);
+	free(iwp->last);
+	free(iwp);
+	return ok ? 0 : -1;
+}
+
+// the records of the tables being saved, to sort by word
+static word_index_t **collected;
+static size_t ncollected;
+
+static void collect_record(void *ep) {
+	collected[ncollected++] = (word_index_t *) ep;
+}
+
+static void count_record(void *ep) {
+	(void) ep;
+	ncollected++;
+}
+
+static int compare_records(const void *a, const void *b) {
+	const word_index_t *ra = *(word_index_t * const *) a;
+	const word_index_t *rb = *(word_index_t * const *) b;
+	return strcmp(ra->word, rb->word);
+}
+
+int32_t indexsave(hashtable_t *htp, char *indexnm){
+	return indexsave_parts(&htp, 1, indexnm);
+}
+
+int32_t indexsave_parts(hashtable_t *htps[], int ntables, char *indexnm){
+	return indexsave_positional(htps, ntables, indexnm, NULL);
+}
+
+// with posnm NULL, only the index is written
+int32_t indexsave_positional(hashtable_t *htps[], int ntables, char *indexnm, char *posnm){
+	if (htps == NULL || indexnm == NULL) return -1;
+	for (int i = 0; i < ntables; i++) {
+		if (htps[i] == NULL) return -1;
+	}
+
+	ncollected = 0;
+	for (int i = 0; i < ntables; i++) {
+		happly(htps[i], count_record);
+	}
+	collected = malloc((ncollected > 0 ? ncollected : 1) * sizeof(word_index_t *));
+	if (collected == NULL) {
+		printf("Error: failed malloc call\n");
+		return -1;
+	}
+	ncollected = 0;
+	for (int i = 0; i < ntables; i++) {
+		happly(htps[i], collect_record);
+	}
+	qsort(collected, ncollected, sizeof(word_index_t *), compare_records);
+
+	indexwriter_t *iwp = indexwriter_open(indexnm);
+	posindex_writer_t *pwp = posnm != NULL ? posindex_writer_open(posnm) : NULL;
+	if (iwp == NULL || (posnm != NULL && pwp == NULL)) {
+		if (iwp != NULL) indexwriter_close(iwp);
+		free(collected);
+		return -1;
+	}
+	for (size_t i = 0; i < ncollected; i++) {
+		word_index_t *record = collected[i];
+		if (indexwriter_add(iwp, record->word, record->docs, record->ndocs) != 0) break;
+		if (pwp != NULL && posindex_writer_add(pwp, record->positions, record->positions_len) != 0) break;
+	}
+	free(collected);
+	collected = NULL;
+	int32_t result = indexwriter_close(iwp);
+	if (pwp != NULL && posindex_writer_close(pwp) != 0) result = -1;
+	return result;
 }
 
 void save_word(void *ep) {
 	word_index_t *record = (word_index_t *) ep;
 	fprintf(index_fp, "%s", record->word);
 
-	qapply(record->docs, print_doc);
+	for (uint32_t i = 0; i < record->ndocs; i++) {
+		fprintf(index_fp, " %lu %lu", record->docs[i].id, record->docs[i].count);
+	}
 	fprintf(index_fp, "\n");
 }
 
-int32_t indexsave(hashtable_t *htp, char *indexnm){
+int32_t indexsave_text(hashtable_t *htp, char *indexnm){
 	if (htp == NULL || indexnm == NULL) return -1;
 
 	index_fp = fopen(indexnm, "w");
@@ -55,21 +460,109 @@ bool word_match(void *ep, const void *keyp){
 	return strcmp(record->word, word) == 0;
 }
 
-hashtable_t *indexload(char *indexnm){
-	if ( indexnm == NULL ) return NULL;
+static void free_record(void *ep) {
+	word_index_free((word_index_t *) ep);
+}
 
-	FILE *fp = fopen(indexnm, "r");
-	if (fp == NULL) {
-		printf("Error: fopen failed\n");
+// closes a partly loaded table, and frees the loader's scratch buffer
+static hashtable_t *load_failed(hashtable_t *htp, const char *indexnm, void *scratch) {
+	printf("Error: index %s is corrupt\n", indexnm);
+	free(scratch);
+	happly(htp, free_record);
+	hclose(htp);
+	return NULL;
+}
+
+// decodes the binary index in buf[0..len)
+static hashtable_t *load_binary(const uint8_t *buf, size_t len, const char *indexnm){
+	index_header_t header = { .table_offset = len };
+	memcpy(&header, buf, HEADER_LEN_V1);
+	if (header.version < 1 || header.version > INDEX_VERSION) {
+		printf("Error: index %s has version %u, expected %d\n", indexnm, header.version, INDEX_VERSION);
+		return NULL;
+	}
+	int header_len = header.version == 1 ? HEADER_LEN_V1 : HEADER_LEN;
+	if (len < (size_t) header_len) {
+		printf("Error: index %s is corrupt\n", indexnm);
 		return NULL;
 	}
+	if (header.version > 1) memcpy(&header, buf, HEADER_LEN);
 
-	hashtable_t *htp = hopen(INDEXER_HASH_TABLE_SIZE);
-	if (htp == NULL) {
-		fclose(fp);
+	// version 1 has no table; version 2 has an entry per term
+	uint64_t ntable = header.version == 1 ? 0 : header.version == 2 ? header.nterms :
+		(header.block_terms == 0 ? header.nterms + 1 : (header.nterms + header.block_terms - 1) / header.block_terms);
+	if (header.dict_offset < (uint64_t) header_len || header.dict_offset > header.table_offset ||
+			header.table_offset > len || ntable > len || ntable * sizeof(index_block_t) > len - header.table_offset) {
+		printf("Error: index %s is corrupt\n", indexnm);
 		return NULL;
 	}
 
+	uint32_t size = header.nterms > INDEXER_HASH_TABLE_SIZE ? header.nterms : INDEXER_HASH_TABLE_SIZE;
+	hashtable_t *htp = hopen(size);
+	if (htp == NULL) return NULL;
+
+	const uint8_t *end = buf + header.table_offset;
+	const uint8_t *dp = buf + header.dict_offset;
+	const uint8_t *pp = buf + header_len;
+	const uint8_t *postings_end = buf + header.dict_offset;
+	buffer_t word = { 0 };     // the previous term, which the next one may share a prefix with
+	for (uint64_t t = 0; t < header.nterms; t++) {
+		uint64_t shared = 0, suffixlen, ndocs, nbytes, gap, count;
+		int n;
+		if (header.version >= 3) {
+			if ((n = varint_get(dp, end, &shared)) == 0 || shared > word.len) {
+				return load_failed(htp, indexnm, word.data);
+			}
+			dp += n;
+		}
+		if ((n = varint_get(dp, end, &suffixlen)) == 0 || suffixlen > (uint64_t) (end - dp - n)) {
+			return load_failed(htp, indexnm, word.data);
+		}
+		dp += n;
+		word.len = shared;
+		if (!buffer_bytes(&word, dp, suffixlen)) {
+			return load_failed(htp, indexnm, word.data);
+		}
+		dp += suffixlen;
+
+		word_index_t *record = word_index_new((const char *) word.data, word.len);
+		if (record == NULL) {
+			return load_failed(htp, indexnm, word.data);
+		}
+		hput(htp, record, record->word, word.len);
+
+		if ((n = varint_get(dp, end, &ndocs)) == 0) return load_failed(htp, indexnm, word.data);
+		dp += n;
+		if ((n = varint_get(dp, end, &nbytes)) == 0 || nbytes > (uint64_t) (postings_end - pp)) {
+			return load_failed(htp, indexnm, word.data);
+		}
+		dp += n;
+		if (ndocs > nbytes / 2 || (ndocs > 0 && (record->docs = malloc(ndocs * sizeof(document_t))) == NULL)) {
+			return load_failed(htp, indexnm, word.data);
+		}
+		record->capacity = ndocs;
+
+		const uint8_t *stop = pp + nbytes;
+		uint64_t id = 0;
+		for (uint64_t i = 0; i < ndocs; i++) {
+			if ((n = varint_get(pp, stop, &gap)) == 0) return load_failed(htp, indexnm, word.data);
+			pp += n;
+			if ((n = varint_get(pp, stop, &count)) == 0) return load_failed(htp, indexnm, word.data);
+			pp += n;
+			id += gap;
+			record->docs[record->ndocs++] = (document_t) { .id = id, .count = count };
+		}
+		if (pp != stop) return load_failed(htp, indexnm, word.data);
+	}
+	free(word.data);
+	return htp;
+}
+
+// parses the text index in fp
+static hashtable_t *load_text(FILE *fp){
+	hashtable_t *htp = hopen(INDEXER_HASH_TABLE_SIZE);
+	if (htp == NULL) return NULL;
+
 	char word[128]; // stack buffer for reading word strings
 	uint64_t docID, count;
 	int n;
@@ -78,44 +571,18 @@ hashtable_t *indexload(char *indexnm){
 	size_t len;
 	
 	while (word_read == 1) {
-		word_index_t *record = malloc(sizeof(word_index_t));
-		if (record == NULL) {
-			fclose(fp);
-			return htp;
-		}
-
 		len = strlen(word);
-		record->word = malloc(len+1);
-		if (record->word == NULL){
-			free(record);
-			fclose(fp);
-			return htp;
-		}
-		strcpy(record->word, word);
-		
-		record->docs = qopen();
-		if (record->docs == NULL){
-			free(record->word);
-			free(record);
-			fclose(fp);
+		word_index_t *record = word_index_new(word, len);
+		if (record == NULL) {
 			return htp;
 		}
 		
 		n = fscanf(fp, "%lu %lu", &docID, &count);
 		while (n == 2){ // scan docID count pair
-			document_t *doc = malloc(sizeof(document_t));
-			if (doc == NULL) {
-				qclose(record->docs);
-				free(record->word);
-				free(record);
-				fclose(fp);
+			if (!postings_append(record, docID, count)) {
+				word_index_free(record);
 				return htp;
 			}
-
-			doc->id = docID;
-			doc->count = count;
-			qput(record->docs, doc);
-
 			n = fscanf(fp, "%lu %lu", &docID, &count);
 		}
 
@@ -123,7 +590,53 @@ hashtable_t *indexload(char *indexnm){
 
 		word_read = fscanf(fp, "%127s", word); // next word
 	}
+	return htp;
+}
 
+hashtable_t *indexload(char *indexnm){
+	if ( indexnm == NULL ) return NULL;
+
+	FILE *fp = fopen(indexnm, "r");
+	if (fp == NULL) {
+		printf("Error: fopen failed\n");
+		return NULL;
+	}
+
+	char magic[sizeof(INDEX_MAGIC)];
+	if (fread(magic, sizeof(magic), 1, fp) != 1 || memcmp(magic, INDEX_MAGIC, sizeof(magic)) != 0) {
+		rewind(fp);
+		hashtable_t *htp = load_text(fp);
+		fclose(fp);
+		return htp;
+	}
+
+	// a binary index is read whole and decoded in memory
+	if (fseek(fp, 0, SEEK_END) != 0) {
+		fclose(fp);
+		return NULL;
+	}
+	long len = ftell(fp);
+	uint8_t *buf = len >= HEADER_LEN_V1 ? malloc(len) : NULL;
+	rewind(fp);
+	if (buf == NULL || fread(buf, len, 1, fp) != 1) {
+		printf("Error: could not read index %s\n", indexnm);
+		free(buf);
+		fclose(fp);
+		return NULL;
+	}
 	fclose(fp);
+
+	hashtable_t *htp = load_binary(buf, len, indexnm);
+	free(buf);
 	return htp;
 }
+
+bool index_is_binary(char *indexnm){
+	if (indexnm == NULL) return false;
+	FILE *fp = fopen(indexnm, "r");
+	if (fp == NULL) return false;
+	char magic[sizeof(INDEX_MAGIC)];
+	bool binary = fread(magic, sizeof(magic), 1, fp) == 1 && memcmp(magic, INDEX_MAGIC, sizeof(magic)) == 0;
+	fclose(fp);
+	return binary;
+}
@@ -6,35 +6,215 @@
  * Created: 10-28-2025
  * Version: 1.0
  * 
- * Description: 
+ * Description: an index is saved in a versioned binary format:
+ *
+ *   header      an index_header_t
+ *   postings    for each term in order, (id gap, count) varint pairs;
+ *               the first gap is the first id
+ *   lexicon     for each term in strcmp order, the varints
+ *               <shared> <suffix length> <suffix> <ndocs> <postings bytes>
+ *               where the term is the first <shared> characters of the
+ *               term before it followed by the suffix (front coding).
+ *               Terms come in blocks of block_terms; the first term of
+ *               a block shares nothing, so it can be read on its own.
+ *   block table an index_block_t per block, so that a reader can
+ *               binary search the blocks in place
+ *
+ * Versions 1 and 2 store each term whole, as <length> <characters>,
+ * and version 2 has a table entry per term; indexload still reads
+ * them. The older text format, one line "word id count id count..."
+ * per word, can still be loaded and written (indexsave_text).
  * 
  */
 
 #include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
 #include <hash.h>
 
+#define INDEX_MAGIC "TSEINDX"
+#define INDEX_VERSION 3
+#define INDEX_BLOCK_TERMS 16
+
+/*
+ * index_header_t -- the start of a binary index. Version 1 indexes
+ * end after dict_offset, and have no block table.
+ */
+typedef struct index_header {
+  char magic[8];
+  uint32_t version;
+  uint32_t block_terms;      // 0 before version 3
+  uint64_t nterms;
+  uint64_t dict_offset;      // where the lexicon starts
+  uint64_t table_offset;
+} index_header_t;
+
+/*
+ * index_block_t -- an entry of the block table: where the block's
+ * first lexicon entry starts, from dict_offset, and where the postings
+ * of its first term start, from the start of the file
+ */
+typedef struct index_block {
+  uint64_t entry;
+  uint64_t postings;
+} index_block_t;
+
 typedef struct document {
   uint64_t id;
   uint64_t count;
 } document_t;
 
+/*
+ * word_index_t -- a word and its postings: a growable array of
+ * documents kept in ascending id order. Pages are indexed one at a
+ * time in id order, so a repeat of the word on the same page is always
+ * the last posting. A positional record also holds where the word
+ * occurs on each page, in the format of a positional index (see
+ * posindex.h); other records have no positions.
+ */
 typedef struct word_index {
   char *word;
-  queue_t *docs;
+  document_t *docs;
+  uint32_t ndocs;
+  uint32_t capacity;
+  uint8_t *positions;
+  uint64_t positions_len;
+  uint64_t positions_capacity;
+  uint32_t last_position;    // of the last posting
 } word_index_t;
 
 /*
- * indexsave -- writes your in-memory hashtable to a file
+ * word_index_new -- a record for the first len characters of word,
+ * with no postings; returns NULL on failure
+ */
+word_index_t *word_index_new(const char *word, int len);
+
+/* word_index_free -- frees a record, its word, and its postings */
+void word_index_free(word_index_t *record);
+
+/*
+ * postings_add -- counts one more occurrence of the word in document id,
+ *  which must be no smaller than the last posting's id
+ *  returns false if out of memory
+ */
+bool postings_add(word_index_t *record, uint64_t id);
+
+/*
+ * postings_append -- appends a posting with the given count; id must be
+ *  larger than the last posting's id
+ *  returns false if out of memory
+ */
+bool postings_append(word_index_t *record, uint64_t id, uint64_t count);
+
+/*
+ * positions_add -- records that the last posting's word occurs at
+ *  position, which must follow any it was recorded at before
+ *  returns false if out of memory
+ */
+bool positions_add(word_index_t *record, uint32_t position);
+
+/*
+ * postings_concat -- appends the postings of src, whose ids all follow
+ *  those of dst, to dst, and their positions; src keeps its postings
+ *  returns false if out of memory
+ */
+bool postings_concat(word_index_t *dst, const word_index_t *src);
+
+/*
+ * postings_find -- binary searches the postings for document id
+ *  returns NULL if the word does not occur in it
+ */
+document_t *postings_find(const word_index_t *record, uint64_t id);
+
+typedef struct indexwriter indexwriter_t;
+
+/*
+ * indexwriter_open -- starts writing a binary index to a file, a
+ *  term at a time. Postings go to the file as they come, and the
+ *  lexicon and block table are spilled to <indexnm>.lexicon.tmp and
+ *  <indexnm>.blocks.tmp until close, so the writer's memory does not
+ *  grow with the index.
+ *  returns NULL if error
+ */
+indexwriter_t *indexwriter_open(char *indexnm);
+
+/*
+ * indexwriter_begin -- starts the postings of word, which must follow
+ *  the previous word in strcmp order
+ *  returns 0 if successful
+ *  returns -1 if error, after which the writer only accepts close
+ */
+int32_t indexwriter_begin(indexwriter_t *iwp, const char *word);
+
+/*
+ * indexwriter_posting -- writes the next posting of the word begun,
+ *  whose id must be larger than the last one's
+ *  returns 0 if successful
+ *  returns -1 if error, after which the writer only accepts close
+ */
+int32_t indexwriter_posting(indexwriter_t *iwp, uint64_t id, uint64_t count);
+
+/*
+ * indexwriter_end -- finishes the word begun
+ *  returns 0 if successful
+ *  returns -1 if error, after which the writer only accepts close
+ */
+int32_t indexwriter_end(indexwriter_t *iwp);
+
+/*
+ * indexwriter_add -- writes the postings of word at once, as begin,
+ *  posting and end would; docs are in ascending id order
+ *  returns 0 if successful
+ *  returns -1 if error, after which the writer only accepts close
+ */
+int32_t indexwriter_add(indexwriter_t *iwp, const char *word, const document_t *docs, uint32_t ndocs);
+
+/*
+ * indexwriter_close -- finishes the file and frees the writer
+ *  returns 0 if every term was written
+ *  returns -1 if error
+ */
+int32_t indexwriter_close(indexwriter_t *iwp);
+
+/*
+ * indexsave -- writes your in-memory hashtable to a binary index file
  *  returns 0 if successfully saved to file
  *  returns -1 if error
  */
 int32_t indexsave(hashtable_t *htp, char *indexnm);
 
+/*
+ * indexsave_parts -- writes an index split over ntables hashtables,
+ *  no word appearing in more than one, to a file
+ *  returns 0 if successfully saved to file
+ *  returns -1 if error
+ */
+int32_t indexsave_parts(hashtable_t *htps[], int ntables, char *indexnm);
 
+/*
+ * indexsave_positional -- writes an index split over ntables
+ *  hashtables, like indexsave_parts, and the positions of its records
+ *  to the positional index posnm
+ *  returns 0 if successfully saved to files
+ *  returns -1 if error
+ */
+int32_t indexsave_positional(hashtable_t *htps[], int ntables, char *indexnm, char *posnm);
 
 /*
- * indexload -- reads file and reconstructs the hashtable in memory
+ * indexsave_text -- writes your in-memory hashtable to a file in the
+ *  text format
+ *  returns 0 if successfully saved to file
+ *  returns -1 if error
+ */
+int32_t indexsave_text(hashtable_t *htp, char *indexnm);
+
+/*
+ * indexload -- reads a binary or text index file and reconstructs the
+ * hashtable in memory
  * returns NULL if unsuccessful
  * returns hashtable if successful
  */
 hashtable_t *indexload(char *indexnm);
+
+/* index_is_binary -- whether indexnm is an index in the binary format */
+bool index_is_binary(char *indexnm);
@@ -0,0 +1,328 @@
+/* 
+ * indexmap.c --- 
+ * 
+ * Author: Khaidar Kairbek, Ava D. Rosenbaum
+ * Created: 10-18-2026
+ * Version: 1.0
+ * 
+ * Description: Implementation of the mapped index. Every offset read
+ * from the file is checked against the size of the map before it is
+ * followed, so a corrupt index makes lookups fail rather than crash.
+ * The lexicon is read with cursors that rebuild each front-coded term
+ * in a buffer of their own, so lookups need no shared state.
+ * 
+ */
+
+#define _POSIX_C_SOURCE 200809L   // mmap
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "varint.h"
+#include "indexio.h"
+#include "indexmap.h"
+
+struct indexmap {
+	const uint8_t *base;
+	size_t len;
+	index_header_t header;
+	const index_block_t *table;
+	uint64_t nblocks;
+	const uint8_t *dict;
+	const uint8_t *dict_end;   // the table follows the lexicon
+};
+
+indexmap_t *indexmap_open(char *indexnm) {
+	if (indexnm == NULL) return NULL;
+	int fd = open(indexnm, O_RDONLY);
+	if (fd < 0) {
+		printf("Error: could not open index %s\n", indexnm);
+		return NULL;
+	}
+	struct stat st;
+	if (fstat(fd, &st) != 0 || (size_t) st.st_size < sizeof(index_header_t)) {
+		close(fd);
+		return NULL;
+	}
+
+	void *base = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+	close(fd);                 // the mapping keeps the file
+	if (base == MAP_FAILED) {
+		printf("Error: could not map index %s\n", indexnm);
+		return NULL;
+	}
+
+	indexmap_t *imp = malloc(sizeof(indexmap_t));
+	if (imp == NULL) {
+		munmap(base, st.st_size);
+		return NULL;
+	}
+	imp->base = base;
+	imp->len = st.st_size;
+	memcpy(&imp->header, base, sizeof(index_header_t));
+
+	// older indexes are left to indexload
+	index_header_t *hp = &imp->header;
+	if (memcmp(hp->magic, INDEX_MAGIC, sizeof(INDEX_MAGIC)) != 0 || hp->version != INDEX_VERSION) {
+		indexmap_close(imp);
+		return NULL;
+	}
+	imp->nblocks = hp->block_terms == 0 ? 0 : (hp->nterms + hp->block_terms - 1) / hp->block_terms;
+	if (hp->block_terms == 0 || hp->dict_offset < sizeof(index_header_t) || hp->dict_offset > hp->table_offset ||
+			hp->table_offset > imp->len || hp->table_offset % sizeof(uint64_t) != 0 ||
+			imp->nblocks > (imp->len - hp->table_offset) / sizeof(index_block_t)) {
+		printf("Error: index %s is corrupt\n", indexnm);
+		indexmap_close(imp);
+		return NULL;
+	}
+	imp->table = (const index_block_t *) (imp->base + hp->table_offset);
+	imp->dict = imp->base + hp->dict_offset;
+	imp->dict_end = imp->base + hp->table_offset;
+	return imp;
+}
+
+void indexmap_close(indexmap_t *imp) {
+	if (imp == NULL) return;
+	munmap((void *) imp->base, imp->len);
+	free(imp);
+}
+
+uint64_t indexmap_nterms(indexmap_t *imp) {
+	return imp == NULL ? 0 : imp->header.nterms;
+}
+
+// the first term of block b, stored whole and not NUL-terminated; NULL if corrupt
+static const char *first_term(indexmap_t *imp, uint64_t b, int *len) {
+	uint64_t offset = imp->table[b].entry, shared, wordlen;
+	if (offset >= (uint64_t) (imp->dict_end - imp->dict)) return NULL;
+
+	const uint8_t *p = imp->dict + offset;
+	int n = varint_get(p, imp->dict_end, &shared);
+	if (n == 0 || shared != 0) return NULL;
+	p += n;
+	if ((n = varint_get(p, imp->dict_end, &wordlen)) == 0 || wordlen > (uint64_t) (imp->dict_end - p - n)) {
+		return NULL;
+	}
+	*len = (int) wordlen;
+	return (const char *) p + n;
+}
+
+// positions a cursor before the first entry of block b
+static void cursor_block(indexmap_cursor_t *cp, uint64_t b) {
+	indexmap_t *imp = cp->imp;
+	cp->next = imp->dict + imp->table[b].entry;
+	cp->i = (int64_t) (b * imp->header.block_terms) - 1;
+	cp->postings = imp->table[b].postings;
+	cp->nbytes = 0;
+}
+
+// positions a cursor before the first entry of block b, to read to the end of the block
+static void cursor_start(indexmap_cursor_t *cp, indexmap_t *imp, uint64_t b) {
+	uint64_t block_terms = imp->header.block_terms;
+	cp->imp = imp;
+	cp->end = (b + 1) * block_terms < imp->header.nterms ? (b + 1) * block_terms : imp->header.nterms;
+	cp->len = 0;
+	cursor_block(cp, b);
+}
+
+void indexmap_cursor_open(indexmap_t *imp, indexmap_cursor_t *cp) {
+	*cp = (indexmap_cursor_t) { .imp = imp, .i = -1, .end = 0 };
+	if (imp == NULL || imp->nblocks == 0) return;
+	cursor_block(cp, 0);
+	cp->end = imp->header.nterms;
+}
+
+void indexmap_cursor_close(indexmap_cursor_t *cp) {
+	free(cp->term);
+	cp->term = NULL;
+}
+
+bool indexmap_cursor_next(indexmap_cursor_t *cp) {
+	indexmap_t *imp = cp->imp;
+	if (imp == NULL || cp->i + 1 >= cp->end) return false;
+	if (cp->i >= 0 && (cp->i + 1) % imp->header.block_terms == 0) {
+		cursor_block(cp, (cp->i + 1) / imp->header.block_terms);
+	}
+	if (cp->next < imp->dict || cp->next >= imp->dict_end) return false;
+
+	const uint8_t *p = cp->next, *end = imp->dict_end;
+	uint64_t shared, suffixlen, ndocs, nbytes;
+	int n;
+	if ((n = varint_get(p, end, &shared)) == 0 || shared > (uint64_t) cp->len) return false;
+	p += n;
+	if ((n = varint_get(p, end, &suffixlen)) == 0 || suffixlen > (uint64_t) (end - p - n)) return false;
+	p += n;
+	if (shared + suffixlen + 1 > (uint64_t) cp->capacity) {
+		int capacity = cp->capacity > 0 ? cp->capacity : 64;
+		while ((uint64_t) capacity < shared + suffixlen + 1) capacity *= 2;
+		char *term = realloc(cp->term, capacity);
+		if (term == NULL) return false;
+		cp->term = term;
+		cp->capacity = capacity;
+	}
+	memcpy(cp->term + shared, p, suffixlen);
+	cp->len = shared + suffixlen;
+	cp->term[cp->len] = '\0';
+	p += suffixlen;
+
+	if ((n = varint_get(p, end, &ndocs)) == 0) return false;
+	p += n;
+	if ((n = varint_get(p, end, &nbytes)) == 0) return false;
+	p += n;
+
+	cp->postings += cp->nbytes;
+	cp->nbytes = nbytes;
+	cp->ndocs = ndocs;
+	cp->next = p;
+	cp->i++;
+	return true;
+}
+
+bool indexmap_cursor_postings(indexmap_cursor_t *cp, indexmap_iter_t *it) {
+	indexmap_t *imp = cp->imp;
+	uint64_t start = cp->postings, nbytes = cp->nbytes;
+	if (imp == NULL || cp->i < 0 || cp->ndocs > UINT32_MAX || start > imp->header.dict_offset ||
+			nbytes > imp->header.dict_offset - start) {
+		return false;
+	}
+	*it = (indexmap_iter_t) { .next = imp->base + start, .end = imp->base + start + nbytes,
+														.ndocs = cp->ndocs, .remaining = cp->ndocs, .id = 0, .count = 0 };
+	return true;
+}
+
+/*
+ * compare -- orders term against key in strcmp order; when prefix is
+ * set, a term that starts with key compares equal to it
+ */
+static int compare(const char *term, int len, const char *key, int keylen, bool prefix) {
+	int cmp = memcmp(term, key, len < keylen ? len : keylen);
+	if (cmp != 0) return cmp;
+	if (prefix && len >= keylen) return 0;
+	return len - keylen;
+}
+
+/*
+ * bound -- the number of the first term that compares at or above key
+ * (above it, if strict); nterms if there is none, -1 if the lexicon is
+ * corrupt
+ */
+static int64_t bound(indexmap_t *imp, const char *key, int keylen, bool prefix, bool strict) {
+	// the first block whose first term is past the bound
+	uint64_t lo = 0, hi = imp->nblocks;
+	while (lo < hi) {
+		uint64_t mid = lo + (hi - lo) / 2;
+		int len;
+		const char *term = first_term(imp, mid, &len);
+		if (term == NULL) return -1;
+		int cmp = compare(term, len, key, keylen, prefix);
+		if (strict ? cmp > 0 : cmp >= 0) hi = mid;
+		else lo = mid + 1;
+	}
+	int64_t result = lo * (uint64_t) imp->header.block_terms;
+	if (result > (int64_t) imp->header.nterms) result = imp->header.nterms;
+	if (lo == 0) return result;
+
+	// it lies in the block before, or is the first term of block lo
+	indexmap_cursor_t cursor = { 0 };
+	cursor_start(&cursor, imp, lo - 1);
+	while (indexmap_cursor_next(&cursor)) {
+		int cmp = compare(cursor.term, cursor.len, key, keylen, prefix);
+		if (strict ? cmp > 0 : cmp >= 0) {
+			result = cursor.i;
+			break;
+		}
+	}
+	if (cursor.i + 1 < cursor.end && result != cursor.i) result = -1;   // stopped early on a corrupt entry
+	indexmap_cursor_close(&cursor);
+	return result;
+}
+
+int64_t indexmap_find(indexmap_t *imp, const char *word, int len) {
+	if (imp == NULL || word == NULL || len < 0) return -1;
+	int64_t i = bound(imp, word, len, false, false);
+	if (i < 0 || i >= (int64_t) imp->header.nterms) return -1;
+
+	char *term = indexmap_term(imp, i);
+	bool found = term != NULL && compare(term, strlen(term), word, len, false) == 0;
+	free(term);
+	return found ? i : -1;
+}
+
+bool indexmap_prefix(indexmap_t *imp, const char *prefix, int len, int64_t *first, int64_t *last) {
+	if (imp == NULL || prefix == NULL || len < 0 || first == NULL || last == NULL) return false;
+	*first = bound(imp, prefix, len, true, false);
+	*last = bound(imp, prefix, len, true, true);
+	return *first >= 0 && *last > *first;
+}
+
+// positions a cursor on term i; false if i is out of range or the block is corrupt
+static bool cursor_seek(indexmap_cursor_t *cp, indexmap_t *imp, int64_t i) {
+	if (imp == NULL || i < 0 || (uint64_t) i >= imp->header.nterms) return false;
+	cursor_start(cp, imp, i / imp->header.block_terms);
+	while (indexmap_cursor_next(cp)) {
+		if (cp->i == i) return true;
+	}
+	return false;
+}
+
+char *indexmap_term(indexmap_t *imp, int64_t i) {
+	indexmap_cursor_t cursor = { 0 };
+	char *term = NULL;
+	if (cursor_seek(&cursor, imp, i)) {
+		term = cursor.term;        // the cursor's buffer becomes the caller's
+		cursor.term = NULL;
+	}
+	indexmap_cursor_close(&cursor);
+	return term;
+}
+
+bool indexmap_postings(indexmap_t *imp, int64_t i, indexmap_iter_t *it) {
+	indexmap_cursor_t cursor = { 0 };
+	bool ok = cursor_seek(&cursor, imp, i) && indexmap_cursor_postings(&cursor, it);
+	indexmap_cursor_close(&cursor);
+	return ok;
+}
+
+bool indexmap_next(indexmap_iter_t *it) {
+	if (it == NULL || it->remaining == 0) return false;
+	uint64_t gap, count;
+	int n = varint_get(it->next, it->end, &gap);
+	if (n == 0) return false;
+	int m = varint_get(it->next + n, it->end, &count);
+	if (m == 0) return false;
+
+	it->next += n + m;
+	it->id += gap;
+	it->count = count;
+	it->remaining--;
+	return true;
+}
+
+word_index_t *indexmap_record(indexmap_t *imp, int64_t i) {
+	char *term = indexmap_term(imp, i);
+	indexmap_iter_t it;
+	if (term == NULL || !indexmap_postings(imp, i, &it)) {
+		free(term);
+		return NULL;
+	}
+
+	word_index_t *record = word_index_new(term, strlen(term));
+	free(term);
+	if (record == NULL) return NULL;
+	while (indexmap_next(&it)) {
+		if (!postings_append(record, it.id, it.count)) {
+			word_index_free(record);
+			return NULL;
+		}
+	}
+	if (it.remaining != 0) {   // corrupt postings
+		word_index_free(record);
+		return NULL;
+	}
+	return record;
+}
@@ -0,0 +1,129 @@
+#pragma once
+/* 
+ * indexmap.h --- a binary index queried in place
+ * 
+ * Author: Khaidar Kairbek, Ava D. Rosenbaum
+ * Created: 10-18-2026
+ * Version: 1.0
+ * 
+ * Description: an indexmap maps a binary index (see indexio.h) into
+ * memory read-only instead of loading it. Opening one reads nothing
+ * but the header, so it takes the same time for any size of index,
+ * and processes mapping the same file share its pages through the
+ * page cache. Terms are numbered 0 to nterms - 1 in strcmp order. A
+ * term is found by binary search over the first terms of the lexicon
+ * blocks, which are stored whole, and then a scan of one block; the
+ * terms starting with a prefix are a range of term numbers. Postings
+ * are decoded only as an iterator walks them.
+ *
+ * Lookups do not change the map, so threads may share one.
+ */
+#include <stdint.h>
+#include <stdbool.h>
+#include "indexio.h"
+
+typedef struct indexmap indexmap_t;
+
+/*
+ * indexmap_iter_t -- walks the postings of a term in ascending id
+ * order; id and count describe the current posting
+ */
+typedef struct indexmap_iter {
+  const uint8_t *next;
+  const uint8_t *end;
+  uint32_t ndocs;        // postings of the term
+  uint32_t remaining;    // postings after the current one
+  uint64_t id;
+  uint64_t count;
+} indexmap_iter_t;
+
+/*
+ * indexmap_cursor_t -- reads the lexicon in term order; term (with len
+ * characters, NUL-terminated) is term number i. A cursor holds the
+ * term in a buffer of its own, so it must be closed.
+ */
+typedef struct indexmap_cursor {
+  indexmap_t *imp;
+  const uint8_t *next;   // the lexicon entry after term i
+  int64_t i;
+  int64_t end;           // the term to stop before
+  char *term;
+  int len;
+  int capacity;
+  uint64_t ndocs;
+  uint64_t postings;     // where the postings of term i start
+  uint64_t nbytes;
+} indexmap_cursor_t;
+
+/* 
+ * indexmap_open -- map the binary index indexnm
+ * returns NULL if it cannot be read or is not a binary index of the
+ * current version
+ */
+indexmap_t *indexmap_open(char *indexnm);
+
+/* indexmap_close -- unmap the index */
+void indexmap_close(indexmap_t *imp);
+
+/* indexmap_nterms -- number of terms in the index */
+uint64_t indexmap_nterms(indexmap_t *imp);
+
+/* 
+ * indexmap_find -- the number of the term made of the len characters
+ * at word
+ * returns -1 if the word is not in the index
+ */
+int64_t indexmap_find(indexmap_t *imp, const char *word, int len);
+
+/* 
+ * indexmap_prefix -- the terms that start with the len characters at
+ * prefix: numbers *first up to *last - 1
+ * returns false if there are none
+ */
+bool indexmap_prefix(indexmap_t *imp, const char *prefix, int len, int64_t *first, int64_t *last);
+
+/* 
+ * indexmap_term -- term number i of the index, NUL-terminated; the
+ * caller frees it
+ * returns NULL if i is out of range or the lexicon is corrupt
+ */
+char *indexmap_term(indexmap_t *imp, int64_t i);
+
+/* 
+ * indexmap_postings -- start an iterator over the postings of term
+ * number i, before the first posting
+ * returns false if i is out of range or the entry is corrupt
+ */
+bool indexmap_postings(indexmap_t *imp, int64_t i, indexmap_iter_t *it);
+
+/* 
+ * indexmap_next -- move to the next posting
+ * returns false at the end of the postings, or if they are corrupt
+ */
+bool indexmap_next(indexmap_iter_t *it);
+
+/* indexmap_cursor_open -- position a cursor before the first term */
+void indexmap_cursor_open(indexmap_t *imp, indexmap_cursor_t *cp);
+
+/* 
+ * indexmap_cursor_next -- move to the next term
+ * returns false after the last term, or if the lexicon is corrupt
+ */
+bool indexmap_cursor_next(indexmap_cursor_t *cp);
+
+/* 
+ * indexmap_cursor_postings -- start an iterator over the postings of
+ * the cursor's term
+ * returns false if they are corrupt
+ */
+bool indexmap_cursor_postings(indexmap_cursor_t *cp, indexmap_iter_t *it);
+
+/* indexmap_cursor_close -- free the cursor's term */
+void indexmap_cursor_close(indexmap_cursor_t *cp);
+
+/* 
+ * indexmap_record -- decode the postings of term number i into a new
+ * record, to be freed with word_index_free
+ * returns NULL if i is out of range, or on failure
+ */
+word_index_t *indexmap_record(indexmap_t *imp, int64_t i);
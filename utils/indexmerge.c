@@ -0,0 +1,194 @@
+/* 
+ * indexmerge.c --- 
+ * 
+ * Author: Khaidar Kairbek, Ava D. Rosenbaum
+ * Created: 10-18-2026
+ * Version: 1.0
+ * 
+ * Description: Implementation of the index merge. A binary heap holds
+ * one cursor per input that has terms left, smallest term first, and
+ * inputs in order among equal terms. The postings of a term go from
+ * the inputs' iterators to the writer one at a time.
+ * 
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include "indexio.h"
+#include "indexmap.h"
+#include "indexmerge.h"
+
+typedef struct input {
+	indexmap_t *imp;
+	indexmap_cursor_t cursor;
+	indexmap_iter_t it;       // over the postings of the term being merged
+	int rank;
+} input_t;
+
+static bool before(input_t *a, input_t *b) {
+	int cmp = strcmp(a->cursor.term, b->cursor.term);
+	return cmp < 0 || (cmp == 0 && a->rank < b->rank);
+}
+
+static void sift_down(input_t **heap, int n, int i) {
+	for (;;) {
+		int least = i, left = 2 * i + 1, right = 2 * i + 2;
+		if (left < n && before(heap[left], heap[least])) least = left;
+		if (right < n && before(heap[right], heap[least])) least = right;
+		if (least == i) return;
+		input_t *tmp = heap[i];
+		heap[i] = heap[least];
+		heap[least] = tmp;
+		i = least;
+	}
+}
+
+static void sift_up(input_t **heap, int i) {
+	while (i > 0 && before(heap[i], heap[(i - 1) / 2])) {
+		input_t *tmp = heap[i];
+		heap[i] = heap[(i - 1) / 2];
+		heap[(i - 1) / 2] = tmp;
+		i = (i - 1) / 2;
+	}
+}
+
+// moves the input to its next term; false at its end, and sets *corrupt if it ended early
+static bool advance(input_t *ip, bool *corrupt) {
+	if (indexmap_cursor_next(&ip->cursor)) return true;
+	if ((uint64_t) (ip->cursor.i + 1) < indexmap_nterms(ip->imp)) *corrupt = true;
+	return false;
+}
+
+// moves the input's iterator to its next live posting; false at its end, and sets *corrupt if it ended early
+static bool next_live(input_t *ip, bool (*live)(int input, uint64_t id), bool *corrupt) {
+	while (indexmap_next(&ip->it)) {
+		if (live == NULL || live(ip->rank, ip->it.id)) return true;
+	}
+	if (ip->it.remaining > 0) *corrupt = true;
+	return false;
+}
+
+/*
+ * write_term -- streams the postings of word from the m inputs holding
+ * it, in input order, to the writer. Without live, the postings of each
+ * input follow those before it, so the inputs are copied one after
+ * another and the writer refuses ids out of order. With live, their
+ * ids may interleave: the input with the smallest id goes next, and a
+ * term left with no postings is not written.
+ */
+static bool write_term(indexwriter_t *iwp, const char *word, input_t **holding, int m,
+											 bool (*live)(int input, uint64_t id), bool *corrupt) {
+	if (live == NULL) {
+		if (indexwriter_begin(iwp, word) != 0) return false;
+		for (int j = 0; j < m; j++) {
+			while (next_live(holding[j], NULL, corrupt)) {
+				if (indexwriter_posting(iwp, holding[j]->it.id, holding[j]->it.count) != 0) return false;
+			}
+		}
+		return indexwriter_end(iwp) == 0;
+	}
+
+	// inputs whose postings run out leave the front of holding
+	int left = m;
+	for (int j = 0; j < left; ) {
+		if (next_live(holding[j], live, corrupt)) {
+			j++;
+		} else {
+			holding[j] = holding[--left];
+		}
+	}
+	bool begun = left > 0;
+	if (begun && indexwriter_begin(iwp, word) != 0) return false;
+	while (left > 0) {
+		int least = 0;
+		for (int j = 1; j < left; j++) {
+			if (holding[j]->it.id < holding[least]->it.id) least = j;
+		}
+		if (indexwriter_posting(iwp, holding[least]->it.id, holding[least]->it.count) != 0) return false;
+		if (!next_live(holding[least], live, corrupt)) holding[least] = holding[--left];
+	}
+	return !begun || indexwriter_end(iwp) == 0;
+}
+
+int32_t indexmerge(char *inputs[], int ninputs, char *indexnm) {
+	return indexmerge_live(inputs, ninputs, NULL, indexnm);
+}
+
+int32_t indexmerge_live(char *inputs[], int ninputs, bool (*live)(int input, uint64_t id), char *indexnm) {
+	if (inputs == NULL || ninputs < 0 || indexnm == NULL) return -1;
+
+	input_t *all = calloc(ninputs > 0 ? ninputs : 1, sizeof(input_t));
+	input_t **heap = calloc(ninputs > 0 ? ninputs : 1, sizeof(input_t *));
+	input_t **holding = calloc(ninputs > 0 ? ninputs : 1, sizeof(input_t *));
+	if (all == NULL || heap == NULL || holding == NULL) {
+		free(all);
+		free(heap);
+		free(holding);
+		return -1;
+	}
+
+	bool ok = true, corrupt = false;
+	int n = 0;
+	for (int r = 0; r < ninputs && ok; r++) {
+		all[r].rank = r;
+		if ((all[r].imp = indexmap_open(inputs[r])) == NULL) {
+			printf("Error: could not map index %s to merge\n", inputs[r]);
+			ok = false;
+			break;
+		}
+		indexmap_cursor_open(all[r].imp, &all[r].cursor);
+		if (advance(&all[r], &corrupt)) {
+			heap[n] = &all[r];
+			sift_up(heap, n++);
+		}
+	}
+
+	indexwriter_t *iwp = ok ? indexwriter_open(indexnm) : NULL;
+	if (iwp == NULL) ok = false;
+
+	char *word = NULL;
+	int capacity = 0;
+	while (ok && n > 0) {
+		int len = heap[0]->cursor.len;
+		if (len + 1 > capacity) {
+			capacity = 2 * (len + 1);
+			char *larger = realloc(word, capacity);
+			if (larger == NULL) {
+				ok = false;
+				break;
+			}
+			word = larger;
+		}
+		memcpy(word, heap[0]->cursor.term, len + 1);
+
+		// every input holding the smallest term, in input order; an
+		// iterator stays valid once its cursor has moved on
+		int m = 0;
+		while (ok && n > 0 && strcmp(heap[0]->cursor.term, word) == 0) {
+			input_t *ip = heap[0];
+			ok = indexmap_cursor_postings(&ip->cursor, &ip->it);
+			holding[m++] = ip;
+			if (!advance(ip, &corrupt)) heap[0] = heap[--n];
+			sift_down(heap, n, 0);
+		}
+		if (ok) ok = write_term(iwp, word, holding, m, live, &corrupt);
+	}
+	free(word);
+	if (corrupt) {
+		printf("Error: an index to merge is corrupt\n");
+		ok = false;
+	}
+
+	if (iwp != NULL && indexwriter_close(iwp) != 0) ok = false;
+	for (int r = 0; r < ninputs; r++) {
+		indexmap_cursor_close(&all[r].cursor);
+		indexmap_close(all[r].imp);
+	}
+	free(all);
+	free(heap);
+	free(holding);
+	return ok ? 0 : -1;
+}
@@ -0,0 +1,36 @@
+#pragma once
+/* 
+ * indexmerge.h --- merging binary indexes
+ * 
+ * Author: Khaidar Kairbek, Ava D. Rosenbaum
+ * Created: 10-18-2026
+ * Version: 1.0
+ * 
+ * Description: merges several binary indexes into one with a k-way
+ * merge of their lexicons. The inputs are mapped and read in term
+ * order, and each posting goes straight from its input to an
+ * indexwriter, which spills the lexicon to disk, so memory holds a
+ * cursor per input and nothing that grows with the indexes.
+ */
+#include <stdint.h>
+#include <stdbool.h>
+
+/*
+ * indexmerge -- writes the binary index indexnm holding every term of
+ *  the ninputs binary indexes inputs. The postings of a term are taken
+ *  from the inputs in order, so each input's ids must all follow those
+ *  of the inputs before it.
+ *  returns 0 if successful
+ *  returns -1 if error
+ */
+int32_t indexmerge(char *inputs[], int ninputs, char *indexnm);
+
+/*
+ * indexmerge_live -- as indexmerge, but keeps only the postings for
+ *  which live(r, id) holds, r being the rank of their input in inputs.
+ *  The ids of the inputs may interleave, but an id must be live in one
+ *  input at most. A term left with no postings is dropped.
+ *  returns 0 if successful
+ *  returns -1 if error
+ */
+int32_t indexmerge_live(char *inputs[], int ninputs, bool (*live)(int input, uint64_t id), char *indexnm);
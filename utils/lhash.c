@@ -50,6 +50,20 @@ int32_t lhput(lhashtable_t *htp, void *ep, const char *key, int keylen){
 	return result;
 }
 
+int32_t lhputnew(lhashtable_t *htp, void *ep,
+								 bool (*searchfn)(void* elementp, const void* searchkeyp),
+								 const char *key, int keylen){
+	int32_t result = 1;
+
+	pthread_mutex_lock(&htp->lock);
+	if (hsearch(htp->h, searchfn, key, keylen) == NULL) {
+		result = hput(htp->h, ep, key, keylen) == 0 ? 0 : -1;
+	}
+	pthread_mutex_unlock(&htp->lock);
+
+	return result;
+}
+
 void lhapply(lhashtable_t *htp, void (*fn)(void* ep)) {
 	pthread_mutex_lock(&htp->lock);
 	happly(htp->h, fn);
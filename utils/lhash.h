@@ -23,6 +23,16 @@ void lhclose(lhashtable_t *htp);
  */
 int32_t lhput(lhashtable_t *htp, void *ep, const char *key, int keylen);
 
+/* lhputnew -- puts an entry under designated key only if searchfn
+ * finds no entry already stored under that key; the search and the
+ * put happen under one lock, so concurrent callers cannot both insert
+ * returns 0 if ep was inserted; 1 if the key was already present;
+ * -1 on failure
+ */
+int32_t lhputnew(lhashtable_t *htp, void *ep,
+								 bool (*searchfn)(void* elementp, const void* searchkeyp),
+								 const char *key, int keylen);
+
 /* lhapply -- applies a function to every entry in hash table */
 void lhapply(lhashtable_t *htp, void (*fn)(void* ep));
 
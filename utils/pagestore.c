@@ -0,0 +1,363 @@
+/* 
+ * pagestore.c --- 
+ * 
+ * Author: Khaidar Kairbek, Ava D. Rosenbaum
+ * Created: 10-18-2026
+ * Version: 1.0
+ * 
+ * Description: Implementation of the packed page store.
+ * 
+ */
+
+#define _POSIX_C_SOURCE 200809L   // pread, pwrite, fsync
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <sys/stat.h>
+#include "webpage.h"
+#include "pageio.h"
+#include "pagestore.h"
+
+#define PAGESTORE_MAGIC "TSEPAGE"
+#define PAGESTORE_VERSION 1
+#define PAGESTORE_DATA "pages.dat"
+#define PAGESTORE_INDEX "pages.idx"
+#define HEADER_LEN 16
+#define MAX_URL_LEN UINT16_MAX
+
+typedef struct entry {
+	uint64_t offset;
+	uint32_t length;
+	uint32_t reserved;
+} entry_t;
+
+struct pagestore {
+	int data_fd;
+	int index_fd;
+	bool writable;
+	uint64_t data_end;         // where the next record goes
+	entry_t *entries;          // entries[id-1]
+	int nentries;              // ids covered by the table
+	int maxid;
+};
+
+static void store_path(char *buf, const char *dirnm, const char *name) {
+	sprintf(buf, "%s/%s", dirnm, name);
+}
+
+bool pagestore_exists(char *dirnm) {
+	char path[300];
+	store_path(path, dirnm, PAGESTORE_INDEX);
+	return access(path, R_OK) == 0;
+}
+
+// reads exactly len bytes at off; returns 0 for success
+static int32_t read_at(int fd, void *buf, size_t len, uint64_t off) {
+	char *p = buf;
+	while (len > 0) {
+		ssize_t n = pread(fd, p, len, off);
+		if (n <= 0) return 1;
+		p += n;
+		len -= n;
+		off += n;
+	}
+	return 0;
+}
+
+// writes exactly len bytes at off; returns 0 for success
+static int32_t write_at(int fd, const void *buf, size_t len, uint64_t off) {
+	const char *p = buf;
+	while (len > 0) {
+		ssize_t n = pwrite(fd, p, len, off);
+		if (n < 0) return 1;
+		p += n;
+		len -= n;
+		off += n;
+	}
+	return 0;
+}
+
+// makes room in the id table for id
+static int32_t reserve(pagestore_t *psp, int id) {
+	if (id <= psp->nentries) return 0;
+
+	int n = psp->nentries ? psp->nentries : 1024;
+	while (n < id) n *= 2;
+	entry_t *entries = realloc(psp->entries, n * sizeof(entry_t));
+	if (entries == NULL) return 1;
+
+	memset(entries + psp->nentries, 0, (n - psp->nentries) * sizeof(entry_t));
+	psp->entries = entries;
+	psp->nentries = n;
+	return 0;
+}
+
+pagestore_t *pagestore_open(char *dirnm, bool writable) {
+	if (dirnm == NULL) return NULL;
+
+	char data_path[300], index_path[300];
+	store_path(data_path, dirnm, PAGESTORE_DATA);
+	store_path(index_path, dirnm, PAGESTORE_INDEX);
+
+	pagestore_t *psp = calloc(1, sizeof(pagestore_t));
+	if (psp == NULL) return NULL;
+	psp->writable = writable;
+
+	int flags = writable ? O_RDWR | O_CREAT : O_RDONLY;
+	psp->data_fd = open(data_path, flags, 0644);
+	psp->index_fd = open(index_path, flags, 0644);
+	if (psp->data_fd < 0 || psp->index_fd < 0) {
+		printf("Error: cannot open page store in %s\n", dirnm);
+		pagestore_close(psp);
+		return NULL;
+	}
+
+	char header[HEADER_LEN];
+	struct stat st;
+	fstat(psp->index_fd, &st);
+	if (st.st_size == 0 && writable) {         // new store
+		memset(header, 0, HEADER_LEN);
+		memcpy(header, PAGESTORE_MAGIC, sizeof(PAGESTORE_MAGIC));
+		uint32_t version = PAGESTORE_VERSION;
+		memcpy(header + sizeof(PAGESTORE_MAGIC), &version, sizeof(version));
+		if (write_at(psp->index_fd, header, HEADER_LEN, 0) != 0) {
+			pagestore_close(psp);
+			return NULL;
+		}
+	} else {
+		uint32_t version;
+		if (read_at(psp->index_fd, header, HEADER_LEN, 0) != 0 ||
+				memcmp(header, PAGESTORE_MAGIC, sizeof(PAGESTORE_MAGIC)) != 0 ||
+				(memcpy(&version, header + sizeof(PAGESTORE_MAGIC), sizeof(version)), version) != PAGESTORE_VERSION) {
+			printf("Error: %s is not a page store index\n", index_path);
+			pagestore_close(psp);
+			return NULL;
+		}
+
+		int n = (st.st_size - HEADER_LEN) / sizeof(entry_t);
+		if (reserve(psp, n) != 0 ||
+				(n > 0 && read_at(psp->index_fd, psp->entries, n * sizeof(entry_t), HEADER_LEN) != 0)) {
+			pagestore_close(psp);
+			return NULL;
+		}
+		for (int id = n; id > 0; id--) {
+			if (psp->entries[id - 1].length > 0) {
+				psp->maxid = id;
+				break;
+			}
+		}
+	}
+
+	fstat(psp->data_fd, &st);
+	psp->data_end = st.st_size;
+	return psp;
+}
+
+void pagestore_close(pagestore_t *psp) {
+	if (psp == NULL) return;
+
+	if (psp->writable) {
+		if (psp->data_fd >= 0) fsync(psp->data_fd);
+		if (psp->index_fd >= 0) fsync(psp->index_fd);
+	}
+	if (psp->data_fd >= 0) close(psp->data_fd);
+	if (psp->index_fd >= 0) close(psp->index_fd);
+	free(psp->entries);
+	free(psp);
+}
+
+int32_t pagestore_save(pagestore_t *psp, webpage_t *page, int id) {
+	if (psp == NULL || page == NULL || id < 1 || !psp->writable) return 1;
+
+	const char *url = webpage_getURL(page);
+	const char *html = webpage_getHTML(page);
+	size_t url_bytes = strlen(url);
+	uint32_t depth = webpage_getDepth(page);
+	uint32_t html_len = html ? webpage_getHTMLlen(page) : 0;
+	if (url_bytes > MAX_URL_LEN) {
+		printf("Error: url of page %d is too long for the page store\n", id);
+		return 4;
+	}
+	uint16_t url_len = url_bytes;
+	uint32_t record_len = sizeof(url_len) + url_len + sizeof(depth) + sizeof(html_len) + html_len;
+
+	char *record = malloc(record_len);
+	if (record == NULL || reserve(psp, id) != 0) {
+		free(record);
+		return 2;
+	}
+
+	char *p = record;
+	memcpy(p, &url_len, sizeof(url_len));     p += sizeof(url_len);
+	memcpy(p, url, url_len);                  p += url_len;
+	memcpy(p, &depth, sizeof(depth));         p += sizeof(depth);
+	memcpy(p, &html_len, sizeof(html_len));   p += sizeof(html_len);
+	memcpy(p, html, html_len);
+
+	// the data goes first so an entry never points past the data file
+	entry_t entry = { psp->data_end, record_len, 0 };
+	int32_t status = write_at(psp->data_fd, record, record_len, psp->data_end) ||
+		write_at(psp->index_fd, &entry, sizeof(entry), HEADER_LEN + (uint64_t) (id - 1) * sizeof(entry_t));
+	free(record);
+	if (status != 0) {
+		printf("Error: cannot save page %d into page store\n", id);
+		return 3;
+	}
+
+	psp->data_end += record_len;
+	psp->entries[id - 1] = entry;
+	if (id > psp->maxid) psp->maxid = id;
+	return 0;
+}
+
+// whether the record of entry lies within the data file
+static bool entry_valid(pagestore_t *psp, entry_t *entry) {
+	return entry->offset <= psp->data_end && entry->length <= psp->data_end - entry->offset;
+}
+
+// whether the url and html lengths of a record of length bytes add up to it
+static bool record_valid(const char *record, uint32_t length) {
+	uint16_t url_len;
+	uint32_t html_len;
+	uint64_t head = sizeof(url_len) + sizeof(uint32_t) + sizeof(html_len);
+	if (length < head) return false;
+	memcpy(&url_len, record, sizeof(url_len));
+	if (length < head + url_len) return false;
+	memcpy(&html_len, record + sizeof(url_len) + url_len + sizeof(uint32_t), sizeof(html_len));
+	return head + url_len + html_len == length;
+}
+
+// reads the head of the record for id: url length, then url
+static char *load_url(pagestore_t *psp, entry_t *entry) {
+	uint16_t url_len;
+	if (!entry_valid(psp, entry) || entry->length < sizeof(url_len) ||
+			read_at(psp->data_fd, &url_len, sizeof(url_len), entry->offset) != 0 ||
+			url_len > entry->length - sizeof(url_len)) {
+		return NULL;
+	}
+
+	char *url = malloc(url_len + 1);
+	if (url == NULL || read_at(psp->data_fd, url, url_len, entry->offset + sizeof(url_len)) != 0) {
+		free(url);
+		return NULL;
+	}
+	url[url_len] = '\0';
+	return url;
+}
+
+char *pagestore_url(pagestore_t *psp, int id) {
+	if (psp == NULL || id < 1 || id > psp->maxid || psp->entries[id - 1].length == 0) return NULL;
+	return load_url(psp, &psp->entries[id - 1]);
+}
+
+webpage_t *pagestore_load(pagestore_t *psp, int id) {
+	if (psp == NULL || id < 1 || id > psp->maxid || psp->entries[id - 1].length == 0) return NULL;
+
+	entry_t *entry = &psp->entries[id - 1];
+	if (!entry_valid(psp, entry)) {
+		printf("Error: page %d lies past the end of the page store\n", id);
+		return NULL;
+	}
+	char *record = malloc((size_t) entry->length + 1);
+	if (record == NULL) return NULL;
+	if (read_at(psp->data_fd, record, entry->length, entry->offset) != 0) {
+		printf("Error: cannot read page %d from page store\n", id);
+		free(record);
+		return NULL;
+	}
+
+	uint16_t url_len;
+	uint32_t depth, html_len;
+	if (!record_valid(record, entry->length)) {
+		printf("Error: page %d in the page store is corrupt\n", id);
+		free(record);
+		return NULL;
+	}
+	char *p = record;
+	memcpy(&url_len, p, sizeof(url_len));     p += sizeof(url_len);
+	char *url = p;                            p += url_len;
+	memcpy(&depth, p, sizeof(depth));         p += sizeof(depth);
+	memcpy(&html_len, p, sizeof(html_len));   p += sizeof(html_len);
+
+	char *html = malloc(html_len + 1);
+	if (html == NULL) {
+		free(record);
+		return NULL;
+	}
+	memcpy(html, p, html_len);
+	html[html_len] = '\0';
+	url[url_len] = '\0';                      // overwrites depth, already read
+
+	webpage_t *page = webpage_new(url, depth, html);
+	if (page == NULL) free(html);
+	free(record);
+	return page;
+}
+
+int pagestore_maxid(pagestore_t *psp) {
+	return psp ? psp->maxid : 0;
+}
+
+// stamps are offsets into the data file, plus one to leave 0 for none
+uint64_t pagestore_stamp(pagestore_t *psp, int id) {
+	if (psp == NULL || id < 1 || id > psp->maxid || psp->entries[id - 1].length == 0) return 0;
+	return psp->entries[id - 1].offset + 1;
+}
+
+uint64_t pagestore_end(pagestore_t *psp) {
+	return psp ? psp->data_end + 1 : 0;
+}
+
+int pagestore_import(char *dirnm) {
+	DIR *d = opendir(dirnm);
+	if (d == NULL) {
+		printf("Error: could not open page directory %s\n", dirnm);
+		return -1;
+	}
+
+	pagestore_t *psp = pagestore_open(dirnm, true);
+	if (psp == NULL) {
+		closedir(d);
+		return -1;
+	}
+
+	int count = 0;
+	struct dirent *dir;
+	while ((dir = readdir(d)) != NULL) {
+		char *endptr;
+		errno = 0;
+		long id = strtol(dir->d_name, &endptr, 10);
+		if (endptr == dir->d_name || *endptr != '\0' || errno != 0 || id < 1) continue;
+
+		webpage_t *page = pageload(id, dirnm);
+		if (page == NULL) continue;
+		if (pagestore_save(psp, page, id) == 0) count++;
+		webpage_delete(page);
+	}
+
+	closedir(d);
+	pagestore_close(psp);
+	return count;
+}
+
+int pagestore_export(char *dirnm) {
+	pagestore_t *psp = pagestore_open(dirnm, false);
+	if (psp == NULL) return -1;
+
+	int count = 0;
+	for (int id = 1; id <= pagestore_maxid(psp); id++) {
+		webpage_t *page = pagestore_load(psp, id);
+		if (page == NULL) continue;
+		if (pagesave(page, id, dirnm) == 0) count++;
+		webpage_delete(page);
+	}
+
+	pagestore_close(psp);
+	return count;
+}
@@ -0,0 +1,91 @@
+#pragma once
+/* 
+ * pagestore.h --- crawled pages packed into one segment
+ * 
+ * Author: Khaidar Kairbek, Ava D. Rosenbaum
+ * Created: 10-18-2026
+ * Version: 1.0
+ * 
+ * Description: instead of one small file per page, a page store keeps
+ * every page of a crawl in two files inside the page directory:
+ *
+ *   pages.dat  append-only records <url len:u16><url><depth:u32>
+ *              <html len:u32><html>
+ *   pages.idx  "TSEPAGE" '\0' <version:u32> <reserved:u32>, then one
+ *              16-byte entry per id: <offset:u64><record len:u32>
+ *              <reserved:u32>, at position id-1; length 0 marks an
+ *              id with no page
+ *
+ * Loading a page is a lookup in the in-memory id table and a single
+ * pread, and readers never share a file position, so any number of
+ * threads may load pages at once. Saving a page under an id that
+ * already has one appends the new record and repoints the entry.
+ *
+ * pagestore_import and pagestore_export convert between a store and
+ * the one-file-per-page layout of pageio.h.
+ */
+#include <stdint.h>
+#include <stdbool.h>
+#include <webpage.h>
+
+typedef struct pagestore pagestore_t;
+
+/* pagestore_exists -- does directory dirnm hold a page store */
+bool pagestore_exists(char *dirnm);
+
+/* 
+ * pagestore_open -- open the store in directory dirnm; if writable,
+ * the store is created when missing and pages can be saved
+ * returns NULL on failure
+ */
+pagestore_t *pagestore_open(char *dirnm, bool writable);
+
+/* pagestore_close -- close the store, making saved pages durable */
+void pagestore_close(pagestore_t *psp);
+
+/* 
+ * pagestore_save -- append page to the store under id (>= 1)
+ * returns 0 for success; nonzero otherwise, also when the url is longer
+ * than a record can hold (65535 bytes)
+ */
+int32_t pagestore_save(pagestore_t *psp, webpage_t *page, int id);
+
+/* 
+ * pagestore_load -- load the page saved under id into a new webpage
+ * returns NULL if there is none, or its record is cut off or corrupt
+ */
+webpage_t *pagestore_load(pagestore_t *psp, int id);
+
+/* 
+ * pagestore_url -- the url of the page saved under id, in a new buffer
+ * the caller must free; only the head of the record is read
+ * returns NULL if there is none
+ */
+char *pagestore_url(pagestore_t *psp, int id);
+
+/* pagestore_maxid -- the highest id with a page (0 for an empty store) */
+int pagestore_maxid(pagestore_t *psp);
+
+/* 
+ * pagestore_stamp -- where the page saved under id was appended, so a
+ * page saved later has a higher stamp
+ * returns 0 if there is none
+ */
+uint64_t pagestore_stamp(pagestore_t *psp, int id);
+
+/* pagestore_end -- the lowest stamp a page saved from now on can get */
+uint64_t pagestore_end(pagestore_t *psp);
+
+/* 
+ * pagestore_import -- pack the numbered page files in dirnm into a
+ * store in the same directory; the page files are left in place
+ * returns the number of pages packed; -1 on failure
+ */
+int pagestore_import(char *dirnm);
+
+/* 
+ * pagestore_export -- write every page of the store in dirnm out as a
+ * numbered page file next to it
+ * returns the number of pages written; -1 on failure
+ */
+int pagestore_export(char *dirnm);
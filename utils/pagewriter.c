@@ -0,0 +1,169 @@
+/* 
+ * pagewriter.c --- 
+ * 
+ * Author: Khaidar Kairbek, Ava D. Rosenbaum
+ * Created: 10-18-2026
+ * Version: 1.0
+ * 
+ * Description: Implementation of the background page writer.
+ * 
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <pthread.h>
+#include "bqueue.h"
+#include "pageio.h"
+#include "pagestore.h"
+#include "validators.h"
+#include "pagewriter.h"
+
+typedef struct pending {
+	webpage_t *page;
+	int id;
+} pending_t;
+
+struct pagewriter {
+	char *dirnm;
+	pagestore_t *store;               // NULL when saving one file per page
+	FILE *validators;                 // opened on the first page that has any
+	bqueue_t *queue;
+	pthread_t thread;
+	int failed;
+	int pending;                      // put but not yet saved
+	pthread_mutex_t lock;
+	pthread_cond_t idle;              // signalled when pending drops to 0
+};
+
+// appends the validators of a saved page to the directory's list
+static int32_t save_validators(pagewriter_t *pwp, webpage_t *page, int id) {
+	if (webpage_getETag(page) == NULL && webpage_getLastModified(page) == NULL) return 0;
+
+	if (pwp->validators == NULL) {
+		char path[300];
+		sprintf(path, "%s/%s", pwp->dirnm, VALIDATORS_FILE);
+		if ((pwp->validators = fopen(path, "a")) == NULL) return 1;
+	}
+	return validators_append(pwp->validators, page, id);
+}
+
+static void *writer_main(void *arg) {
+	pagewriter_t *pwp = (pagewriter_t *) arg;
+	pending_t *pp;
+
+	while ((pp = bqget(pwp->queue)) != NULL) {
+		int32_t status = pwp->store ? pagestore_save(pwp->store, pp->page, pp->id)
+			: pagesave(pp->page, pp->id, pwp->dirnm);
+		if (status != 0) {
+			printf("Failed to save webpage %d\n", pp->id);
+			pwp->failed++;
+		} else if (save_validators(pwp, pp->page, pp->id) != 0) {
+			printf("Failed to save validators of webpage %d\n", pp->id);
+		}
+		webpage_delete(pp->page);
+		free(pp);
+
+		pthread_mutex_lock(&pwp->lock);
+		if (--pwp->pending == 0) pthread_cond_broadcast(&pwp->idle);
+		pthread_mutex_unlock(&pwp->lock);
+	}
+
+	return NULL;
+}
+
+pagewriter_t *pagewriter_open(char *dirnm, int capacity, bool packed) {
+	if (dirnm == NULL) return NULL;
+
+	pagewriter_t *pwp = malloc(sizeof(pagewriter_t));
+	if (pwp == NULL) return NULL;
+
+	pwp->dirnm = dirnm;
+	pwp->failed = 0;
+	pwp->pending = 0;
+	pwp->store = NULL;
+	pwp->validators = NULL;
+	if (packed && (pwp->store = pagestore_open(dirnm, true)) == NULL) {
+		free(pwp);
+		return NULL;
+	}
+	pwp->queue = bqopen(capacity);
+	if (pwp->queue == NULL) {
+		pagestore_close(pwp->store);
+		free(pwp);
+		return NULL;
+	}
+	pthread_mutex_init(&pwp->lock, NULL);
+	pthread_cond_init(&pwp->idle, NULL);
+
+	if (pthread_create(&pwp->thread, NULL, writer_main, pwp) != 0) {
+		pthread_cond_destroy(&pwp->idle);
+		pthread_mutex_destroy(&pwp->lock);
+		bqclose(pwp->queue);
+		pagestore_close(pwp->store);
+		free(pwp);
+		return NULL;
+	}
+
+	return pwp;
+}
+
+int32_t pagewriter_put(pagewriter_t *pwp, webpage_t *page, int id) {
+	if (pwp == NULL || page == NULL) {
+		webpage_delete(page);
+		return 1;
+	}
+
+	pending_t *pp = malloc(sizeof(pending_t));
+	if (pp == NULL) {
+		webpage_delete(page);
+		return 2;
+	}
+	pp->page = page;
+	pp->id = id;
+
+	pthread_mutex_lock(&pwp->lock);
+	pwp->pending++;
+	pthread_mutex_unlock(&pwp->lock);
+
+	if (bqput(pwp->queue, pp) != 0) {
+		pthread_mutex_lock(&pwp->lock);
+		if (--pwp->pending == 0) pthread_cond_broadcast(&pwp->idle);
+		pthread_mutex_unlock(&pwp->lock);
+
+		webpage_delete(page);
+		free(pp);
+		return 3;
+	}
+	return 0;
+}
+
+int pagewriter_flush(pagewriter_t *pwp) {
+	if (pwp == NULL) return 0;
+
+	pthread_mutex_lock(&pwp->lock);
+	while (pwp->pending > 0) {
+		pthread_cond_wait(&pwp->idle, &pwp->lock);
+	}
+	int failed = pwp->failed;
+	if (pwp->validators != NULL) fflush(pwp->validators);
+	pthread_mutex_unlock(&pwp->lock);
+
+	return failed;
+}
+
+int pagewriter_close(pagewriter_t *pwp) {
+	if (pwp == NULL) return 0;
+
+	bqshutdown(pwp->queue);           // the writer drains what is queued
+	pthread_join(pwp->thread, NULL);
+	bqclose(pwp->queue);
+	pagestore_close(pwp->store);
+	if (pwp->validators != NULL) fclose(pwp->validators);
+	pthread_cond_destroy(&pwp->idle);
+	pthread_mutex_destroy(&pwp->lock);
+
+	int failed = pwp->failed;
+	free(pwp);
+	return failed;
+}
@@ -0,0 +1,47 @@
+#pragma once
+/* 
+ * pagewriter.h --- saving crawled pages on a background thread
+ * 
+ * Author: Khaidar Kairbek, Ava D. Rosenbaum
+ * Created: 10-18-2026
+ * Version: 1.0
+ * 
+ * Description: the crawler hands each page to the writer as soon as it
+ * is parsed; a writer thread saves it, with pagesave or into a page
+ * store (pagestore.h), appends its validators, if the server sent
+ * any, to the directory's list (validators.h), and deletes it.
+ * At most capacity pages wait in memory, so a crawl's footprint stays
+ * flat however many pages it saves; pagewriter_put blocks while the
+ * writer is that far behind.
+ */
+#include <stdint.h>
+#include <stdbool.h>
+#include <webpage.h>
+
+typedef struct pagewriter pagewriter_t;
+
+/* 
+ * pagewriter_open -- start a writer saving into directory dirnm, one
+ * file per page, or packed into the directory's page store
+ * returns NULL on failure
+ */
+pagewriter_t *pagewriter_open(char *dirnm, int capacity, bool packed);
+
+/* 
+ * pagewriter_put -- queue page to be saved under id; the writer owns
+ * (and deletes) the page from now on, even if the put fails
+ * returns 0 for success; nonzero otherwise
+ */
+int32_t pagewriter_put(pagewriter_t *pwp, webpage_t *page, int id);
+
+/* 
+ * pagewriter_flush -- wait until every page put so far has been saved
+ * returns the number of pages that could not be saved so far
+ */
+int pagewriter_flush(pagewriter_t *pwp);
+
+/* 
+ * pagewriter_close -- save every queued page and stop the writer
+ * returns the number of pages that could not be saved
+ */
+int pagewriter_close(pagewriter_t *pwp);
@@ -0,0 +1,219 @@
+/*
+ * posindex.c ---
+ *
+ * Author: Khaidar Kairbek, Ava D. Rosenbaum
+ * Created: 10-18-2026
+ * Version: 1.0
+ *
+ * Description: Implementation of the positional index. The writer
+ * streams the positions to the file and keeps only the table in
+ * memory; the reader checks a term's offsets against the size of the
+ * map before following them.
+ *
+ */
+
+#define _POSIX_C_SOURCE 200809L   // mmap
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "varint.h"
+#include "posindex.h"
+
+struct posindex_writer {
+	FILE *fp;
+	uint64_t offset;        // where the next term's positions go
+	uint64_t *table;
+	uint64_t nterms;
+	uint64_t capacity;
+	bool failed;
+};
+
+struct posindex {
+	const uint8_t *base;
+	size_t len;
+	posindex_header_t header;
+	const uint64_t *table;
+};
+
+char *posindex_file(char *indexnm) {
+	char *name = malloc(strlen(indexnm) + 8);
+	if (name != NULL) sprintf(name, "%s.pos", indexnm);
+	return name;
+}
+
+posindex_writer_t *posindex_writer_open(char *posnm) {
+	if (posnm == NULL) return NULL;
+	posindex_writer_t *pwp = calloc(1, sizeof(posindex_writer_t));
+	if (pwp == NULL) return NULL;
+
+	pwp->fp = fopen(posnm, "w");
+	if (pwp->fp == NULL) {
+		printf("Error: could not create positional index %s\n", posnm);
+		free(pwp);
+		return NULL;
+	}
+
+	// the header is written last, once the table is placed
+	posindex_header_t header = { 0 };
+	if (fwrite(&header, sizeof(header), 1, pwp->fp) != 1) pwp->failed = true;
+	pwp->offset = sizeof(header);
+	return pwp;
+}
+
+int32_t posindex_writer_add(posindex_writer_t *pwp, const uint8_t *positions, uint64_t len) {
+	if (pwp == NULL || (positions == NULL && len > 0)) return -1;
+	if (pwp->failed) return -1;
+
+	// room for this term's start and the end after it
+	if (pwp->nterms + 2 > pwp->capacity) {
+		uint64_t capacity = pwp->capacity ? 2 * pwp->capacity : 1024;
+		uint64_t *table = realloc(pwp->table, capacity * sizeof(uint64_t));
+		if (table == NULL) {
+			pwp->failed = true;
+			return -1;
+		}
+		pwp->table = table;
+		pwp->capacity = capacity;
+	}
+	pwp->table[pwp->nterms++] = pwp->offset;
+
+	if (len > 0 && fwrite(positions, len, 1, pwp->fp) != 1) {
+		pwp->failed = true;
+		return -1;
+	}
+	pwp->offset += len;
+	return 0;
+}
+
+int32_t posindex_writer_close(posindex_writer_t *pwp) {
+	if (pwp == NULL) return -1;
+	bool ok = !pwp->failed;
+	uint64_t end = pwp->offset;
+
+	// the table is aligned so that a mapped index can use it in place
+	while (ok && pwp->offset % sizeof(uint64_t) != 0) {
+		ok = fputc('\0', pwp->fp) != EOF;
+		pwp->offset++;
+	}
+	posindex_header_t header = { .version = POSINDEX_VERSION, .nterms = pwp->nterms, .table_offset = pwp->offset };
+	memcpy(header.magic, POSINDEX_MAGIC, sizeof(POSINDEX_MAGIC));
+	if (ok && pwp->nterms > 0 && fwrite(pwp->table, sizeof(uint64_t), pwp->nterms, pwp->fp) != pwp->nterms) ok = false;
+	if (ok && fwrite(&end, sizeof(uint64_t), 1, pwp->fp) != 1) ok = false;
+	if (ok && (fseek(pwp->fp, 0, SEEK_SET) != 0 || fwrite(&header, sizeof(header), 1, pwp->fp) != 1)) ok = false;
+	if (fclose(pwp->fp) != 0) ok = false;
+	if (!ok) printf("Error: could not write positional index\n");
+
+	free(pwp->table);
+	free(pwp);
+	return ok ? 0 : -1;
+}
+
+posindex_t *posindex_open(char *posnm) {
+	if (posnm == NULL) return NULL;
+	int fd = open(posnm, O_RDONLY);
+	if (fd < 0) return NULL;
+	struct stat st;
+	if (fstat(fd, &st) != 0 || (size_t) st.st_size < sizeof(posindex_header_t)) {
+		printf("Error: positional index %s is corrupt\n", posnm);
+		close(fd);
+		return NULL;
+	}
+
+	void *base = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+	close(fd);                 // the mapping keeps the file
+	if (base == MAP_FAILED) {
+		printf("Error: could not map positional index %s\n", posnm);
+		return NULL;
+	}
+
+	posindex_t *pip = malloc(sizeof(posindex_t));
+	if (pip == NULL) {
+		munmap(base, st.st_size);
+		return NULL;
+	}
+	pip->base = base;
+	pip->len = st.st_size;
+	memcpy(&pip->header, base, sizeof(posindex_header_t));
+
+	posindex_header_t *hp = &pip->header;
+	if (memcmp(hp->magic, POSINDEX_MAGIC, sizeof(POSINDEX_MAGIC)) != 0 || hp->version != POSINDEX_VERSION ||
+			hp->table_offset < sizeof(posindex_header_t) || hp->table_offset > pip->len ||
+			hp->table_offset % sizeof(uint64_t) != 0 ||
+			hp->nterms >= (pip->len - hp->table_offset) / sizeof(uint64_t)) {
+		printf("Error: positional index %s is corrupt\n", posnm);
+		posindex_close(pip);
+		return NULL;
+	}
+	pip->table = (const uint64_t *) (pip->base + hp->table_offset);
+	return pip;
+}
+
+void posindex_close(posindex_t *pip) {
+	if (pip == NULL) return;
+	munmap((void *) pip->base, pip->len);
+	free(pip);
+}
+
+uint64_t posindex_nterms(posindex_t *pip) {
+	return pip == NULL ? 0 : pip->header.nterms;
+}
+
+bool posindex_positions(posindex_t *pip, int64_t t, posindex_iter_t *it) {
+	if (pip == NULL || it == NULL || t < 0 || (uint64_t) t >= pip->header.nterms) return false;
+	uint64_t start = pip->table[t], end = pip->table[t + 1];
+	if (start < sizeof(posindex_header_t) || start > end || end > pip->header.table_offset) return false;
+	*it = (posindex_iter_t) { .next = pip->base + start, .end = pip->base + end };
+	return true;
+}
+
+bool posindex_skip(posindex_iter_t *it, uint64_t n) {
+	// a varint ends at the first byte without the high bit
+	for (; n > 0; it->next++) {
+		if (it->next >= it->end) return false;
+		if ((*it->next & 0x80) == 0) n--;
+	}
+	return true;
+}
+
+bool posindex_read(posindex_iter_t *it, uint64_t count, uint32_t *positions) {
+	uint64_t position = 0;
+	for (uint64_t i = 0; i < count; i++) {
+		uint64_t gap;
+		int n = varint_get(it->next, it->end, &gap);
+		if (n == 0) return false;
+		it->next += n;
+		position += gap;
+		if (position > UINT32_MAX) return false;
+		positions[i] = (uint32_t) position;
+	}
+	return true;
+}
+
+uint64_t posindex_phrase(uint32_t **positions, const uint64_t *counts, uint64_t **next, int nwords, uint32_t slop) {
+	// one pass per word, from the last back, sets next[w][i] to the nearest
+	// position at or after i from which the rest of the phrase follows
+	uint64_t matches = 0;
+	for (int w = nwords - 1; w >= 0; w--) {
+		uint32_t *p = positions[w];
+		next[w][counts[w]] = counts[w];
+		uint64_t j = w + 1 < nwords ? counts[w + 1] : 0;
+		for (uint64_t i = counts[w]; i-- > 0; ) {
+			bool follows = true;
+			if (w + 1 < nwords) {
+				// j is the first position of the next word past p[i]
+				while (j > 0 && positions[w + 1][j - 1] > p[i]) j--;
+				uint64_t r = next[w + 1][j];
+				follows = r < counts[w + 1] && positions[w + 1][r] - p[i] <= slop + 1;
+			}
+			next[w][i] = follows ? i : next[w][i + 1];
+			if (follows && w == 0) matches++;
+		}
+	}
+	return matches;
+}
@@ -0,0 +1,118 @@
+#pragma once
+/*
+ * posindex.h --- where each word of an index occurs on its pages
+ *
+ * Author: Khaidar Kairbek, Ava D. Rosenbaum
+ * Created: 10-18-2026
+ * Version: 1.0
+ *
+ * Description: a positional index keeps, next to a binary index, the
+ * positions at which each posting's word occurs on its page: the
+ * ordinal of the word among the words indexed on the page, from 0.
+ * The indexer writes it as <indexnm>.pos, a stream of its own, so
+ * that a query without phrases never reads it:
+ *
+ *   header     a posindex_header_t
+ *   positions  for each term of the index, in its order, for each of
+ *              its postings, count varints: the first position, then
+ *              the gaps between the next ones
+ *   table      from table_offset, aligned, nterms + 1 offsets from the
+ *              start of the file; the positions of term t run from
+ *              entry t to entry t + 1
+ *
+ * The count of a posting, in the index, is the number of its
+ * positions, so the stream of a term is read along with its postings.
+ * Lookups do not change the map, so threads may share one.
+ */
+#include <stdint.h>
+#include <stdbool.h>
+
+#define POSINDEX_MAGIC "TSEPOS"
+#define POSINDEX_VERSION 1
+
+typedef struct posindex_header {
+	char magic[8];
+	uint32_t version;
+	uint32_t reserved;
+	uint64_t nterms;        // of the index the positions belong to
+	uint64_t table_offset;
+} posindex_header_t;
+
+/*
+ * posindex_iter_t -- walks the positions of a term, a posting at a
+ * time; the count of each posting says how many positions it has
+ */
+typedef struct posindex_iter {
+	const uint8_t *next;
+	const uint8_t *end;
+} posindex_iter_t;
+
+typedef struct posindex posindex_t;
+typedef struct posindex_writer posindex_writer_t;
+
+/*
+ * posindex_writer_open -- start writing the positional index posnm
+ * returns NULL on failure
+ */
+posindex_writer_t *posindex_writer_open(char *posnm);
+
+/*
+ * posindex_writer_add -- add the positions of the next term, len bytes
+ * in the format above
+ * returns 0 for success; -1 otherwise, and the close fails too
+ */
+int32_t posindex_writer_add(posindex_writer_t *pwp, const uint8_t *positions, uint64_t len);
+
+/*
+ * posindex_writer_close -- write the table and close the index
+ * returns 0 for success; -1 if any step of the writing failed
+ */
+int32_t posindex_writer_close(posindex_writer_t *pwp);
+
+/*
+ * posindex_open -- map the positional index posnm
+ * returns NULL if it is missing or corrupt
+ */
+posindex_t *posindex_open(char *posnm);
+
+/* posindex_close -- unmap the positional index */
+void posindex_close(posindex_t *pip);
+
+/* posindex_nterms -- the number of terms, which is that of its index */
+uint64_t posindex_nterms(posindex_t *pip);
+
+/*
+ * posindex_positions -- start walking the positions of term t
+ * returns false if there is no such term, or its entry is corrupt
+ */
+bool posindex_positions(posindex_t *pip, int64_t t, posindex_iter_t *it);
+
+/*
+ * posindex_skip -- skip n positions, those of the postings passed over
+ * returns false if the positions run out first
+ */
+bool posindex_skip(posindex_iter_t *it, uint64_t n);
+
+/*
+ * posindex_read -- read the count positions of the current posting into
+ * positions, in ascending order
+ * returns false if they are cut off
+ */
+bool posindex_read(posindex_iter_t *it, uint64_t count, uint32_t *positions);
+
+/*
+ * posindex_phrase -- the number of times a phrase of nwords words starts
+ * on a page, given the ascending positions of each word there: the
+ * positions of the first word from which each next word follows the one
+ * before with at most slop words between. next holds room for
+ * counts[w] + 1 entries for each word w, which it uses as scratch. The
+ * time taken is linear in the positions, whatever the slop and however
+ * often a word repeats.
+ */
+uint64_t posindex_phrase(uint32_t **positions, const uint64_t *counts, uint64_t **next, int nwords, uint32_t slop);
+
+/*
+ * posindex_file -- the name of the positional index of the index
+ * indexnm, in a new buffer the caller must free
+ */
+char *posindex_file(char *indexnm);
@@ -0,0 +1,250 @@
+/* 
+ * sched.c --- 
+ * 
+ * Author: Khaidar Kairbek, Ava D. Rosenbaum
+ * Created: 10-18-2026
+ * Version: 1.0
+ * 
+ * Description: Implementation of the per-host politeness scheduler.
+ * 
+ */
+
+#define _POSIX_C_SOURCE 200809L   // clock_gettime
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <ctype.h>
+#include <time.h>
+#include "hash.h"
+#include "queue.h"
+#include "sched.h"
+
+#define HOST_HASH_LENGTH 101
+#define MAX_HOST_LEN 256
+
+typedef struct host {
+	char *name;
+	queue_t *pages;
+	int npages;
+	long delay_ms;
+	int64_t ready_ms;     // earliest time the next page may go out
+	bool busy;            // a page is out between schedget and scheddone
+	bool in_heap;
+} host_t;
+
+struct sched {
+	hashtable_t *hosts;
+	host_t **heap;        // min-heap on ready_ms of idle hosts with pages
+	int nheap;
+	int heapcap;
+	int npages;
+	long delay_ms;
+};
+
+static int64_t now_ms(void) {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (int64_t) ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+// copies the lowercased host[:port] of url into buf
+static void url_host(const char *url, char *buf) {
+	const char *beg = strstr(url, "://");
+	beg = beg ? beg + 3 : url;
+
+	int len = 0;
+	for (const char *p = beg; *p && *p != '/' && *p != '?' && *p != '#' && len < MAX_HOST_LEN - 1; p++) {
+		buf[len++] = tolower(*p);
+	}
+	buf[len] = '\0';
+}
+
+static bool host_searchfn(void *elementp, const void *keyp) {
+	return strcmp(((host_t *) elementp)->name, (const char *) keyp) == 0;
+}
+
+static host_t *find_host(sched_t *sp, const char *name) {
+	return hsearch(sp->hosts, host_searchfn, name, strlen(name));
+}
+
+static host_t *get_host(sched_t *sp, const char *name) {
+	host_t *hp = find_host(sp, name);
+	if (hp != NULL) return hp;
+
+	hp = calloc(1, sizeof(host_t));
+	if (hp == NULL) return NULL;
+
+	hp->name = malloc(strlen(name) + 1);
+	hp->pages = qopen();
+	if (hp->name == NULL || hp->pages == NULL || hput(sp->hosts, hp, name, strlen(name)) != 0) {
+		if (hp->pages) qclose(hp->pages);
+		free(hp->name);
+		free(hp);
+		return NULL;
+	}
+	strcpy(hp->name, name);
+	hp->delay_ms = sp->delay_ms;
+
+	return hp;
+}
+
+/* heap helpers */
+
+static void heap_swap(sched_t *sp, int i, int j) {
+	host_t *tmp = sp->heap[i];
+	sp->heap[i] = sp->heap[j];
+	sp->heap[j] = tmp;
+}
+
+// makes room for one more host, so that the push after it cannot fail
+static int32_t heap_reserve(sched_t *sp) {
+	if (sp->nheap < sp->heapcap) return 0;
+	int cap = sp->heapcap ? 2 * sp->heapcap : 16;
+	host_t **heap = realloc(sp->heap, cap * sizeof(host_t *));
+	if (heap == NULL) return 1;
+	sp->heap = heap;
+	sp->heapcap = cap;
+	return 0;
+}
+
+static void heap_push(sched_t *sp, host_t *hp) {
+	int i = sp->nheap++;
+	sp->heap[i] = hp;
+	hp->in_heap = true;
+	for (; i > 0 && sp->heap[(i - 1) / 2]->ready_ms > sp->heap[i]->ready_ms; i = (i - 1) / 2) {
+		heap_swap(sp, i, (i - 1) / 2);
+	}
+}
+
+static host_t *heap_pop(sched_t *sp) {
+	host_t *top = sp->heap[0];
+	sp->heap[0] = sp->heap[--sp->nheap];
+	top->in_heap = false;
+
+	for (int i = 0; ; ) {
+		int l = 2 * i + 1, r = l + 1, min = i;
+		if (l < sp->nheap && sp->heap[l]->ready_ms < sp->heap[min]->ready_ms) min = l;
+		if (r < sp->nheap && sp->heap[r]->ready_ms < sp->heap[min]->ready_ms) min = r;
+		if (min == i) break;
+		heap_swap(sp, i, min);
+		i = min;
+	}
+	return top;
+}
+
+/* public interface */
+
+sched_t *schedopen(long delay_ms) {
+	sched_t *sp = calloc(1, sizeof(sched_t));
+	if (sp == NULL) return NULL;
+
+	sp->hosts = hopen(HOST_HASH_LENGTH);
+	if (sp->hosts == NULL) {
+		free(sp);
+		return NULL;
+	}
+	sp->delay_ms = delay_ms < 0 ? 0 : delay_ms;
+	return sp;
+}
+
+static void close_host(void *ep) {
+	host_t *hp = (host_t *) ep;
+	qapply(hp->pages, webpage_delete);
+	qclose(hp->pages);
+	free(hp->name);
+	free(hp);
+}
+
+void schedclose(sched_t *sp) {
+	if (sp == NULL) return;
+	happly(sp->hosts, close_host);
+	hclose(sp->hosts);
+	free(sp->heap);
+	free(sp);
+}
+
+int32_t scheddelay(sched_t *sp, const char *host, long delay_ms) {
+	if (sp == NULL || delay_ms < 0) return 1;
+
+	if (host == NULL) {
+		sp->delay_ms = delay_ms;
+		return 0;
+	}
+
+	char name[MAX_HOST_LEN];
+	url_host(host, name);
+	host_t *hp = get_host(sp, name);
+	if (hp == NULL) return 2;
+
+	hp->delay_ms = delay_ms;
+	return 0;
+}
+
+int32_t schedput(sched_t *sp, webpage_t *page) {
+	if (sp == NULL || page == NULL) return 1;
+
+	char name[MAX_HOST_LEN];
+	url_host(webpage_getURL(page), name);
+	host_t *hp = get_host(sp, name);
+	if (hp == NULL) return 2;
+
+	// the heap is grown before the page is queued: once queued, the page is ours
+	bool push = !hp->busy && !hp->in_heap;
+	if (push && heap_reserve(sp) != 0) return 3;
+	if (qput(hp->pages, page) != 0) return 2;
+
+	hp->npages++;
+	sp->npages++;
+	if (push) heap_push(sp, hp);
+	return 0;
+}
+
+webpage_t *schedget(sched_t *sp, long *wait_ms) {
+	*wait_ms = -1;
+	if (sp == NULL || sp->nheap == 0) return NULL;
+
+	int64_t now = now_ms();
+	if (sp->heap[0]->ready_ms > now) {
+		*wait_ms = sp->heap[0]->ready_ms - now;
+		return NULL;
+	}
+
+	host_t *hp = heap_pop(sp);
+	hp->busy = true;
+	hp->npages--;
+	sp->npages--;
+	return qget(hp->pages);
+}
+
+void scheddone(sched_t *sp, const webpage_t *page, bool fetched) {
+	if (sp == NULL || page == NULL) return;
+
+	char name[MAX_HOST_LEN];
+	url_host(webpage_getURL(page), name);
+	host_t *hp = find_host(sp, name);
+	if (hp == NULL || !hp->busy) return;
+
+	hp->busy = false;
+	if (fetched) hp->ready_ms = now_ms() + hp->delay_ms;
+
+	// the host left the heap in schedget, so there is room for it
+	if (hp->npages > 0) heap_push(sp, hp);
+}
+
+static void (*apply_fn)(void *page);
+
+static void apply_host(void *ep) {
+	qapply(((host_t *) ep)->pages, apply_fn);
+}
+
+void schedapply(sched_t *sp, void (*fn)(void *page)) {
+	if (sp == NULL || fn == NULL) return;
+	apply_fn = fn;
+	happly(sp->hosts, apply_host);
+}
+
+int schedsize(sched_t *sp) {
+	return sp ? sp->npages : 0;
+}
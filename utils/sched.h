@@ -0,0 +1,67 @@
+#pragma once
+/* 
+ * sched.h --- per-host politeness scheduler for the crawl frontier
+ * 
+ * Author: Khaidar Kairbek, Ava D. Rosenbaum
+ * Created: 10-18-2026
+ * Version: 1.0
+ * 
+ * Description: pages are queued per host. A host hands out one page at
+ * a time; once that page is done the host cools down for its delay
+ * before it may hand out the next one. Hosts that are ready sit in a
+ * min-heap keyed by the time they become ready, so schedget is O(log
+ * hosts) and only has nothing to give when every host with queued
+ * pages is busy or still cooling down.
+ *
+ * The scheduler is not locked; callers sharing one between threads
+ * must serialize access.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <webpage.h>
+
+typedef struct sched sched_t;
+
+/* schedopen -- create an empty scheduler with a default per-host delay */
+sched_t *schedopen(long delay_ms);
+
+/* schedclose -- deallocate the scheduler, deleting any queued pages */
+void schedclose(sched_t *sp);
+
+/* 
+ * scheddelay -- set the delay for one host (e.g. "www.example.com"),
+ * or, if host is NULL, the default for hosts without a delay of their
+ * own that are seen from now on
+ * returns 0 for success; nonzero otherwise
+ */
+int32_t scheddelay(sched_t *sp, const char *host, long delay_ms);
+
+/* 
+ * schedput -- queue page behind the other pages of its host
+ * returns 0 for success, and the scheduler owns page; nonzero
+ * otherwise, and page was not queued
+ */
+int32_t schedput(sched_t *sp, webpage_t *page);
+
+/* 
+ * schedget -- take the next page of the host that has been ready the
+ * longest. That host is busy until scheddone is called for the page.
+ * returns NULL if no host is ready; *wait_ms is then set to the time
+ * until one will be, or to -1 if every queued host is busy (or nothing
+ * is queued at all)
+ */
+webpage_t *schedget(sched_t *sp, long *wait_ms);
+
+/* 
+ * scheddone -- release the host of a page returned by schedget. If
+ * fetched, the host cools down for its delay; otherwise no request was
+ * sent and it is ready again at once. Call before the page is deleted.
+ */
+void scheddone(sched_t *sp, const webpage_t *page, bool fetched);
+
+/* schedapply -- apply a function to every queued page, host by host */
+void schedapply(sched_t *sp, void (*fn)(void *page));
+
+/* schedsize -- number of pages queued (not counting pages handed out) */
+int schedsize(sched_t *sp);
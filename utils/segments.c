@@ -0,0 +1,345 @@
+/*
+ * segments.c ---
+ *
+ * Author: Khaidar Kairbek, Ava D. Rosenbaum
+ * Created: 10-18-2026
+ * Version: 1.0
+ *
+ * Description: Implementation of the segment manifest and its merge
+ * policy.
+ *
+ */
+
+#define _POSIX_C_SOURCE 200809L   // getline
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <stdbool.h>
+#include <string.h>
+#include "indexmerge.h"
+#include "segments.h"
+
+static int compare_ids(const void *a, const void *b) {
+	uint64_t x = *(const uint64_t *) a, y = *(const uint64_t *) b;
+	return x < y ? -1 : x > y;
+}
+
+static bool has_id(const uint64_t *ids, uint32_t n, uint64_t id) {
+	return n > 0 && bsearch(&id, ids, n, sizeof(uint64_t), compare_ids) != NULL;
+}
+
+bool segments_exists(char *indexnm) {
+	if (indexnm == NULL) return false;
+	FILE *fp = fopen(indexnm, "r");
+	if (fp == NULL) return false;
+	char magic[sizeof(SEGMENTS_MAGIC) - 1];
+	bool manifest = fread(magic, sizeof(magic), 1, fp) == 1 && memcmp(magic, SEGMENTS_MAGIC, sizeof(magic)) == 0;
+	fclose(fp);
+	return manifest;
+}
+
+segments_t *segments_new(void) {
+	segments_t *ssp = calloc(1, sizeof(segments_t));
+	if (ssp != NULL) ssp->next_gen = 1;
+	return ssp;
+}
+
+static void segment_free(segment_t *sp) {
+	free(sp->ids);
+	free(sp->deleted);
+}
+
+void segments_free(segments_t *ssp) {
+	if (ssp == NULL) return;
+	for (int i = 0; i < ssp->nsegs; i++) segment_free(&ssp->segs[i]);
+	free(ssp->segs);
+	free(ssp->obsolete);
+	free(ssp);
+}
+
+char *segments_file(char *indexnm, uint32_t gen) {
+	char *name = malloc(strlen(indexnm) + 16);
+	if (name != NULL) sprintf(name, "%s.%" PRIu32, indexnm, gen);
+	return name;
+}
+
+// appends the segment, whose arrays ssp then owns
+static int32_t append(segments_t *ssp, segment_t *sp) {
+	segment_t *segs = realloc(ssp->segs, (ssp->nsegs + 1) * sizeof(segment_t));
+	if (segs == NULL) return -1;
+	ssp->segs = segs;
+	ssp->segs[ssp->nsegs++] = *sp;
+	return 0;
+}
+
+// writes the ids as runs of consecutive ids, then a newline
+static void write_ids(FILE *fp, uint64_t *ids, uint32_t n) {
+	for (uint32_t i = 0; i < n; ) {
+		uint32_t j = i;
+		while (j + 1 < n && ids[j + 1] == ids[j] + 1) j++;
+		fprintf(fp, i == 0 ? "%" PRIu64 : " %" PRIu64, ids[i]);
+		if (j > i) fprintf(fp, "-%" PRIu64, ids[j]);
+		i = j + 1;
+	}
+	fprintf(fp, "\n");
+}
+
+// reads a line of n ascending ids written by write_ids into a new array
+static uint64_t *read_ids(FILE *fp, uint32_t n, char **line, size_t *capacity) {
+	if (getline(line, capacity, fp) < 0) return NULL;
+	uint64_t *ids = malloc((n > 0 ? n : 1) * sizeof(uint64_t));
+	if (ids == NULL) return NULL;
+
+	uint32_t count = 0;
+	char *p = *line, *end;
+	for (;;) {
+		while (*p == ' ') p++;
+		if (*p == '\n' || *p == '\0') break;
+		uint64_t first = strtoull(p, &end, 10), last = first;
+		if (end == p) break;
+		if (*end == '-') {
+			p = end + 1;
+			last = strtoull(p, &end, 10);
+			if (end == p) break;
+		}
+		p = end;
+		if (last < first || last - first >= n - count || (count > 0 && first <= ids[count - 1])) break;
+		for (uint64_t id = first; id <= last; id++) ids[count++] = id;
+	}
+	if (count != n || (*p != '\n' && *p != '\0')) {
+		free(ids);
+		return NULL;
+	}
+	return ids;
+}
+
+segments_t *segments_load(char *indexnm) {
+	FILE *fp = fopen(indexnm, "r");
+	if (fp == NULL) {
+		printf("Error: could not open index %s\n", indexnm);
+		return NULL;
+	}
+
+	segments_t *ssp = segments_new();
+	char *line = NULL, kind[8];
+	size_t capacity = 0;
+	uint32_t version;
+	bool ok = ssp != NULL &&
+		getline(&line, &capacity, fp) > 0 &&
+		sscanf(line, SEGMENTS_MAGIC " %" SCNu32, &version) == 1 && version == SEGMENTS_VERSION &&
+		getline(&line, &capacity, fp) > 0 &&
+		sscanf(line, "next %" SCNu32 " mark %7s %" SCNu64, &ssp->next_gen, kind, &ssp->mark) == 3;
+	if (ok) ssp->store = strcmp(kind, "store") == 0;
+
+	while (ok && getline(&line, &capacity, fp) > 0) {
+		segment_t seg = { 0 };
+		ok = sscanf(line, "segment %" SCNu32 " %" SCNu32 " %" SCNu32, &seg.gen, &seg.nids, &seg.ndeleted) == 3 &&
+			seg.gen < ssp->next_gen && seg.ndeleted <= seg.nids &&
+			(seg.ids = read_ids(fp, seg.nids, &line, &capacity)) != NULL &&
+			(seg.deleted = read_ids(fp, seg.ndeleted, &line, &capacity)) != NULL &&
+			append(ssp, &seg) == 0;
+		if (!ok) segment_free(&seg);
+	}
+	free(line);
+	fclose(fp);
+
+	if (!ok) {
+		printf("Error: %s is not a valid segment manifest\n", indexnm);
+		segments_free(ssp);
+		return NULL;
+	}
+	return ssp;
+}
+
+int32_t segments_save(segments_t *ssp, char *indexnm) {
+	if (ssp == NULL || indexnm == NULL) return -1;
+
+	char *tmpnm = malloc(strlen(indexnm) + 8);
+	if (tmpnm == NULL) return -1;
+	sprintf(tmpnm, "%s.tmp", indexnm);
+	FILE *fp = fopen(tmpnm, "w");
+	if (fp == NULL) {
+		printf("Error: could not write index %s\n", tmpnm);
+		free(tmpnm);
+		return -1;
+	}
+
+	fprintf(fp, "%s %d\n", SEGMENTS_MAGIC, SEGMENTS_VERSION);
+	fprintf(fp, "next %" PRIu32 " mark %s %" PRIu64 "\n", ssp->next_gen, ssp->store ? "store" : "files", ssp->mark);
+	for (int i = 0; i < ssp->nsegs; i++) {
+		segment_t *sp = &ssp->segs[i];
+		fprintf(fp, "segment %" PRIu32 " %" PRIu32 " %" PRIu32 "\n", sp->gen, sp->nids, sp->ndeleted);
+		write_ids(fp, sp->ids, sp->nids);
+		write_ids(fp, sp->deleted, sp->ndeleted);
+	}
+	bool ok = !ferror(fp);
+	if (fclose(fp) != 0) ok = false;
+	if (ok && rename(tmpnm, indexnm) != 0) ok = false;
+	if (!ok) {
+		printf("Error: could not write index %s\n", indexnm);
+		remove(tmpnm);
+		free(tmpnm);
+		return -1;
+	}
+	free(tmpnm);
+
+	for (int i = 0; i < ssp->nobsolete; i++) {
+		char *segnm = segments_file(indexnm, ssp->obsolete[i]);
+		if (segnm != NULL) remove(segnm);
+		free(segnm);
+	}
+	ssp->nobsolete = 0;
+	return 0;
+}
+
+int32_t segments_add(segments_t *ssp, uint64_t *ids, uint32_t nids) {
+	if (ssp == NULL || (ids == NULL && nids > 0)) return -1;
+
+	segment_t seg = { .gen = ssp->next_gen, .nids = nids };
+	seg.ids = malloc((nids > 0 ? nids : 1) * sizeof(uint64_t));
+	seg.deleted = malloc(sizeof(uint64_t));
+	if (seg.ids == NULL || seg.deleted == NULL || append(ssp, &seg) != 0) {
+		segment_free(&seg);
+		return -1;
+	}
+	if (nids > 0) memcpy(seg.ids, ids, nids * sizeof(uint64_t));
+	ssp->next_gen++;
+	return 0;
+}
+
+bool segment_live(segment_t *sp, uint64_t id) {
+	return has_id(sp->ids, sp->nids, id) && !has_id(sp->deleted, sp->ndeleted, id);
+}
+
+bool segment_deleted(segment_t *sp, uint64_t id) {
+	return has_id(sp->deleted, sp->ndeleted, id);
+}
+
+int segments_find(segments_t *ssp, uint64_t id) {
+	if (ssp == NULL) return -1;
+	for (int i = ssp->nsegs - 1; i >= 0; i--) {
+		if (segment_live(&ssp->segs[i], id)) return i;
+	}
+	return -1;
+}
+
+int32_t segments_delete(segments_t *ssp, uint64_t id) {
+	int i = segments_find(ssp, id);
+	if (i < 0) return -1;
+
+	segment_t *sp = &ssp->segs[i];
+	uint64_t *deleted = realloc(sp->deleted, (sp->ndeleted + 1) * sizeof(uint64_t));
+	if (deleted == NULL) return -1;
+	uint32_t at = sp->ndeleted;
+	while (at > 0 && deleted[at - 1] > id) at--;
+	memmove(deleted + at + 1, deleted + at, (sp->ndeleted - at) * sizeof(uint64_t));
+	deleted[at] = id;
+	sp->deleted = deleted;
+	sp->ndeleted++;
+	return 0;
+}
+
+// the pages of the segment that are not deleted
+static uint32_t live_count(segment_t *sp) {
+	return sp->nids - sp->ndeleted;
+}
+
+static int32_t retire(segments_t *ssp, uint32_t gen) {
+	uint32_t *obsolete = realloc(ssp->obsolete, (ssp->nobsolete + 1) * sizeof(uint32_t));
+	if (obsolete == NULL) return -1;
+	ssp->obsolete = obsolete;
+	ssp->obsolete[ssp->nobsolete++] = gen;
+	return 0;
+}
+
+// replaces count segments from first with the segment at first
+static void replace(segments_t *ssp, int first, int count, segment_t *sp) {
+	for (int i = first; i < first + count; i++) segment_free(&ssp->segs[i]);
+	ssp->segs[first] = *sp;
+	memmove(ssp->segs + first + 1, ssp->segs + first + count, (ssp->nsegs - first - count) * sizeof(segment_t));
+	ssp->nsegs -= count - 1;
+}
+
+static _Thread_local segment_t *merging;   // the segments being merged
+static bool live_in(int input, uint64_t id) {
+	return !segment_deleted(&merging[input], id);
+}
+
+// merges count segments from first into a new segment in their place
+static int32_t merge(segments_t *ssp, char *indexnm, int first, int count) {
+	segment_t merged = { .gen = ssp->next_gen };
+	uint64_t total = 0;
+	for (int i = first; i < first + count; i++) total += live_count(&ssp->segs[i]);
+	merged.ids = malloc((total > 0 ? total : 1) * sizeof(uint64_t));
+	merged.deleted = malloc(sizeof(uint64_t));
+	char **inputs = calloc(count, sizeof(char *));
+	char *mergednm = segments_file(indexnm, merged.gen);
+	bool ok = merged.ids != NULL && merged.deleted != NULL && inputs != NULL && mergednm != NULL;
+
+	for (int i = first; ok && i < first + count; i++) {
+		segment_t *sp = &ssp->segs[i];
+		for (uint32_t j = 0; j < sp->nids; j++) {
+			if (!segment_deleted(sp, sp->ids[j])) merged.ids[merged.nids++] = sp->ids[j];
+		}
+		ok = (inputs[i - first] = segments_file(indexnm, sp->gen)) != NULL;
+	}
+	qsort(merged.ids, merged.nids, sizeof(uint64_t), compare_ids);
+
+	if (ok) {
+		printf("Merging %d segment(s) into segment %" PRIu32 " of %" PRIu32 " pages\n", count, merged.gen, merged.nids);
+		merging = &ssp->segs[first];
+		ok = indexmerge_live(inputs, count, live_in, mergednm) == 0;
+		merging = NULL;
+		if (!ok) remove(mergednm);
+	}
+	for (int i = first; ok && i < first + count; i++) {
+		ok = retire(ssp, ssp->segs[i].gen) == 0;
+	}
+	if (ok) {
+		ssp->next_gen++;
+		replace(ssp, first, count, &merged);
+	} else {
+		segment_free(&merged);
+	}
+
+	for (int i = 0; inputs != NULL && i < count; i++) free(inputs[i]);
+	free(inputs);
+	free(mergednm);
+	return ok ? 0 : -1;
+}
+
+int32_t segments_compact(segments_t *ssp, char *indexnm) {
+	if (ssp == NULL || indexnm == NULL) return -1;
+
+	int32_t merges = 0;
+	for (;;) {
+		for (int i = 0; i < ssp->nsegs; i++) {
+			if (live_count(&ssp->segs[i]) > 0) continue;
+			if (retire(ssp, ssp->segs[i].gen) != 0) return -1;
+			segment_free(&ssp->segs[i]);
+			memmove(ssp->segs + i, ssp->segs + i + 1, (ssp->nsegs - i - 1) * sizeof(segment_t));
+			ssp->nsegs--;
+			i--;
+		}
+
+		int first = -1, count = 0;
+		for (int i = ssp->nsegs - 1; i > 0 && first < 0; i--) {
+			if (live_count(&ssp->segs[i - 1]) < (uint64_t) SEGMENTS_MERGE_RATIO * live_count(&ssp->segs[i])) {
+				first = i - 1;
+				count = 2;
+			}
+		}
+		for (int i = 0; i < ssp->nsegs && first < 0; i++) {
+			if (2 * ssp->segs[i].ndeleted > ssp->segs[i].nids) {
+				first = i;
+				count = 1;
+			}
+		}
+		if (first < 0) return merges;
+
+		if (merge(ssp, indexnm, first, count) != 0) return -1;
+		merges++;
+	}
+}
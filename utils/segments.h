@@ -0,0 +1,120 @@
+#pragma once
+/*
+ * segments.h --- an index kept as segments
+ *
+ * Author: Khaidar Kairbek, Ava D. Rosenbaum
+ * Created: 10-18-2026
+ * Version: 1.0
+ *
+ * Description: an index that is updated rather than rebuilt is kept
+ * as segments, each a binary index over some of the pages, named by a
+ * manifest. The manifest is the file the index is known by, and
+ * segment gen is the file <indexnm>.<gen> next to it. The manifest is
+ * text:
+ *
+ *   TSESEGS <version>
+ *   next <gen> mark <files|store> <stamp>
+ *   segment <gen> <nids> <ndeleted>      for each segment, oldest first
+ *   <ids>
+ *   <deleted ids>
+ *
+ * where an id list is ascending, with a run of consecutive ids written
+ * first-last. A page deleted or replaced since its segment was written
+ * keeps its postings there until the segment is merged, but a
+ * tombstone, its id in the deleted list, hides them. A page is live in
+ * one segment at most. The mark records the state of the page
+ * directory at the last update: the time, or the end of the page
+ * store, so that the pages saved since can be told apart.
+ *
+ * The manifest is replaced with a rename, so a reader sees the
+ * segments from before an update or after it, never a mix; the files
+ * of merged segments are removed only once it no longer names them.
+ */
+#include <stdint.h>
+#include <stdbool.h>
+
+#define SEGMENTS_MAGIC "TSESEGS"
+#define SEGMENTS_VERSION 1
+#define SEGMENTS_MERGE_RATIO 4
+
+typedef struct segment {
+	uint32_t gen;
+	uint64_t *ids;          // the pages indexed in the segment, ascending
+	uint32_t nids;
+	uint64_t *deleted;      // tombstones: those since deleted or replaced, ascending
+	uint32_t ndeleted;
+} segment_t;
+
+typedef struct segments {
+	uint32_t next_gen;      // the generation of the next segment written
+	bool store;             // whether the mark is a page store's end, not a time
+	uint64_t mark;
+	segment_t *segs;        // oldest first
+	int nsegs;
+	uint32_t *obsolete;     // segments merged away, to remove on the next save
+	int nobsolete;
+} segments_t;
+
+/* segments_exists -- is the file indexnm a segment manifest */
+bool segments_exists(char *indexnm);
+
+/* segments_new -- an index with no segments */
+segments_t *segments_new(void);
+
+/*
+ * segments_load -- read the manifest indexnm
+ * returns NULL on failure
+ */
+segments_t *segments_load(char *indexnm);
+
+/*
+ * segments_save -- replace the manifest indexnm, then remove the files
+ * of the segments merged away
+ * returns 0 for success; -1 otherwise
+ */
+int32_t segments_save(segments_t *ssp, char *indexnm);
+
+/* segments_free -- free the manifest */
+void segments_free(segments_t *ssp);
+
+/*
+ * segments_file -- the name of segment gen of the index indexnm, in a
+ * new buffer the caller must free
+ */
+char *segments_file(char *indexnm, uint32_t gen);
+
+/*
+ * segments_add -- add the segment over the nids pages ids, ascending,
+ * written as segment ssp->next_gen
+ * returns 0 for success; -1 otherwise
+ */
+int32_t segments_add(segments_t *ssp, uint64_t *ids, uint32_t nids);
+
+/* segment_live -- is page id indexed in the segment and not deleted since */
+bool segment_live(segment_t *sp, uint64_t id);
+
+/* segment_deleted -- has page id a tombstone in the segment */
+bool segment_deleted(segment_t *sp, uint64_t id);
+
+/*
+ * segments_find -- the segment page id is live in
+ * returns its position in segs; -1 if there is none
+ */
+int segments_find(segments_t *ssp, uint64_t id);
+
+/*
+ * segments_delete -- tombstone page id in the segment it is live in
+ * returns 0 for success; -1 if it is live in none, or on failure
+ */
+int32_t segments_delete(segments_t *ssp, uint64_t id);
+
+/*
+ * segments_compact -- apply the merge policy to the segments of the
+ * index indexnm: a segment with no live pages is dropped, a segment
+ * merges with the newer one after it while it holds fewer than
+ * SEGMENTS_MERGE_RATIO times its live pages, and a segment more than
+ * half tombstones is rewritten without them. Every page is rewritten
+ * a logarithmic number of times as the index grows.
+ * returns the number of merges; -1 on failure
+ */
+int32_t segments_compact(segments_t *ssp, char *indexnm);
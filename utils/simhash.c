@@ -0,0 +1,275 @@
+/* 
+ * simhash.c --- 
+ * 
+ * Author: Khaidar Kairbek, Ava D. Rosenbaum
+ * Created: 10-18-2026
+ * Version: 1.0
+ * 
+ * Description: Implementation of SimHash and the banded fingerprint
+ * index. Each band has its own chained hash table over the band value
+ * of every fingerprint; the chains are index arrays parallel to the
+ * fingerprint array, so a fingerprint costs 12 bytes plus 4 per band.
+ * 
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <ctype.h>
+#include "webpage.h"
+#include "simhash.h"
+
+#define SIMINDEX_INITIAL_SIZE 1024
+#define SIMINDEX_MAX_BANDS (SIMHASH_MAX_DISTANCE + 1)
+#define NONE -1
+
+typedef struct fingerprint {
+	uint64_t fp;
+	int id;
+} fingerprint_t;
+
+struct simindex {
+	int max_distance;
+	int nbands;
+	int shift[SIMINDEX_MAX_BANDS];   // band b is (fp >> shift[b]) & mask[b]
+	uint64_t mask[SIMINDEX_MAX_BANDS];
+	fingerprint_t *fps;
+	int size;
+	int capacity;                    // of fps, and of every table (a power of two)
+	int32_t *heads[SIMINDEX_MAX_BANDS];  // first fingerprint per bucket
+	int32_t *next[SIMINDEX_MAX_BANDS];   // next fingerprint in the same bucket
+};
+
+// the MurmurHash3 finalizer
+static uint64_t mix(uint64_t h) {
+	h ^= h >> 33;
+	h *= 0xff51afd7ed558ccdULL;
+	h ^= h >> 33;
+	h *= 0xc4ceb9fe1a85ec53ULL;
+	h ^= h >> 33;
+	return h;
+}
+
+// FNV-1a over the case folded word of len letters
+static uint64_t word_hash(const char *word, int len) {
+	uint64_t h = 14695981039346656037ULL;
+	for (const unsigned char *p = (const unsigned char *) word; len-- > 0; p++) {
+		h ^= tolower(*p);
+		h *= 1099511628211ULL;
+	}
+	return h;
+}
+
+static uint64_t rotl(uint64_t x, int r) {
+	return r == 0 ? x : (x << r) | (x >> (64 - r));
+}
+
+// adds the vote of one shingle to each bit
+static void vote(int votes[64], const uint64_t *words, int nwords) {
+	uint64_t h = 0;
+	for (int i = 0; i < nwords; i++) {
+		h ^= rotl(words[i], 21 * i);
+	}
+	h = mix(h);
+	for (int bit = 0; bit < 64; bit++) {
+		votes[bit] += (h >> bit) & 1 ? 1 : -1;
+	}
+}
+
+uint64_t simhash(webpage_t *page) {
+	int votes[64] = { 0 };
+	uint64_t window[SIMHASH_SHINGLE];   // hashes of the last words, as a ring
+	uint64_t shingle[SIMHASH_SHINGLE];
+	int nwords = 0;
+	webpage_token_t token;
+
+	for (int pos = 0; (pos = webpage_nextToken(page, pos, &token)) > 0; ) {
+		if (token.kind != WEBPAGE_WORD) continue;
+		window[nwords % SIMHASH_SHINGLE] = word_hash(webpage_getHTML(page) + token.offset, token.length);
+		nwords++;
+		if (nwords >= SIMHASH_SHINGLE) {
+			for (int i = 0; i < SIMHASH_SHINGLE; i++) {
+				shingle[i] = window[(nwords + i) % SIMHASH_SHINGLE];
+			}
+			vote(votes, shingle, SIMHASH_SHINGLE);
+		}
+	}
+
+	if (nwords == 0) return 0;
+	if (nwords < SIMHASH_SHINGLE) vote(votes, window, nwords);  // one short shingle
+
+	uint64_t fp = 0;
+	for (int bit = 0; bit < 64; bit++) {
+		if (votes[bit] > 0) fp |= 1ULL << bit;
+	}
+	return fp;
+}
+
+int simhash_distance(uint64_t a, uint64_t b) {
+	uint64_t x = a ^ b;
+	x = x - ((x >> 1) & 0x5555555555555555ULL);
+	x = (x & 0x3333333333333333ULL) + ((x >> 2) & 0x3333333333333333ULL);
+	x = (x + (x >> 4)) & 0x0f0f0f0f0f0f0f0fULL;
+	return (int) ((x * 0x0101010101010101ULL) >> 56);
+}
+
+// bucket of fingerprint fp in the table of band b
+static uint32_t bucket(simindex_t *sip, int b, uint64_t fp) {
+	uint64_t value = (fp >> sip->shift[b]) & sip->mask[b];
+	return mix(value ^ ((uint64_t) (b + 1) << 58)) & (sip->capacity - 1);
+}
+
+static void link_fp(simindex_t *sip, int i) {
+	for (int b = 0; b < sip->nbands; b++) {
+		uint32_t h = bucket(sip, b, sip->fps[i].fp);
+		sip->next[b][i] = sip->heads[b][h];
+		sip->heads[b][h] = i;
+	}
+}
+
+/*
+ * doubles every table and relinks the fingerprints; returns 0 for
+ * success. The new tables are all allocated before any old one is
+ * given up, so on failure the index is left as it was.
+ */
+static int32_t grow(simindex_t *sip) {
+	int capacity = sip->capacity * 2;
+	fingerprint_t *fps = realloc(sip->fps, capacity * sizeof(fingerprint_t));
+	if (fps == NULL) return 1;
+	sip->fps = fps;
+
+	int32_t *heads[SIMINDEX_MAX_BANDS], *next[SIMINDEX_MAX_BANDS];
+	bool failed = false;
+	for (int b = 0; b < sip->nbands; b++) {
+		heads[b] = malloc(capacity * sizeof(int32_t));
+		next[b] = malloc(capacity * sizeof(int32_t));
+		failed = failed || heads[b] == NULL || next[b] == NULL;
+	}
+	if (failed) {
+		for (int b = 0; b < sip->nbands; b++) {
+			free(heads[b]);
+			free(next[b]);
+		}
+		return 2;
+	}
+
+	sip->capacity = capacity;
+	for (int b = 0; b < sip->nbands; b++) {
+		free(sip->heads[b]);
+		free(sip->next[b]);
+		sip->heads[b] = heads[b];
+		sip->next[b] = next[b];
+		for (int h = 0; h < capacity; h++) sip->heads[b][h] = NONE;
+	}
+	for (int i = 0; i < sip->size; i++) link_fp(sip, i);
+	return 0;
+}
+
+simindex_t *simindex_open(int max_distance) {
+	if (max_distance < 0 || max_distance > SIMHASH_MAX_DISTANCE) return NULL;
+
+	simindex_t *sip = calloc(1, sizeof(simindex_t));
+	if (sip == NULL) return NULL;
+
+	sip->max_distance = max_distance;
+	sip->nbands = max_distance + 1;
+	sip->capacity = SIMINDEX_INITIAL_SIZE;
+	sip->fps = malloc(sip->capacity * sizeof(fingerprint_t));
+
+	int width = 64 / sip->nbands;
+	bool failed = sip->fps == NULL;
+	for (int b = 0; b < sip->nbands; b++) {
+		sip->shift[b] = b * width;
+		// the last band takes the bits left over
+		int bits = b == sip->nbands - 1 ? 64 - b * width : width;
+		sip->mask[b] = bits == 64 ? UINT64_MAX : (1ULL << bits) - 1;
+
+		sip->heads[b] = malloc(sip->capacity * sizeof(int32_t));
+		sip->next[b] = malloc(sip->capacity * sizeof(int32_t));
+		if (sip->heads[b] == NULL || sip->next[b] == NULL) {
+			failed = true;
+			continue;
+		}
+		for (int h = 0; h < sip->capacity; h++) sip->heads[b][h] = NONE;
+	}
+
+	if (failed) {
+		simindex_close(sip);
+		return NULL;
+	}
+	return sip;
+}
+
+void simindex_close(simindex_t *sip) {
+	if (sip == NULL) return;
+	for (int b = 0; b < sip->nbands; b++) {
+		free(sip->heads[b]);
+		free(sip->next[b]);
+	}
+	free(sip->fps);
+	free(sip);
+}
+
+int simindex_size(simindex_t *sip) {
+	return sip ? sip->size : 0;
+}
+
+int simindex_find(simindex_t *sip, uint64_t fp) {
+	if (sip == NULL) return 0;
+
+	for (int b = 0; b < sip->nbands; b++) {
+		uint64_t value = (fp >> sip->shift[b]) & sip->mask[b];
+		for (int32_t i = sip->heads[b][bucket(sip, b, fp)]; i != NONE; i = sip->next[b][i]) {
+			uint64_t other = sip->fps[i].fp;
+			if (((other >> sip->shift[b]) & sip->mask[b]) == value &&
+					simhash_distance(fp, other) <= sip->max_distance) {
+				return sip->fps[i].id;
+			}
+		}
+	}
+	return 0;
+}
+
+int32_t simindex_add(simindex_t *sip, uint64_t fp, int id) {
+	if (sip == NULL || id < 1) return 1;
+	if (sip->size == sip->capacity && grow(sip) != 0) return 2;
+
+	int i = sip->size++;
+	sip->fps[i].fp = fp;
+	sip->fps[i].id = id;
+	link_fp(sip, i);
+	return 0;
+}
+
+int32_t simindex_save(simindex_t *sip, FILE *fp) {
+	if (sip == NULL || fp == NULL) return 1;
+
+	uint64_t count = sip->size;
+	if (fwrite(&count, sizeof(count), 1, fp) != 1) return 2;
+	for (int i = 0; i < sip->size; i++) {
+		uint32_t id = sip->fps[i].id;
+		if (fwrite(&sip->fps[i].fp, sizeof(uint64_t), 1, fp) != 1 ||
+				fwrite(&id, sizeof(id), 1, fp) != 1) {
+			return 2;
+		}
+	}
+	return 0;
+}
+
+int32_t simindex_load(simindex_t *sip, FILE *fp) {
+	if (sip == NULL || fp == NULL) return 1;
+
+	uint64_t count, fprint;
+	uint32_t id;
+	if (fread(&count, sizeof(count), 1, fp) != 1) return 2;
+	for (uint64_t i = 0; i < count; i++) {
+		if (fread(&fprint, sizeof(fprint), 1, fp) != 1 ||
+				fread(&id, sizeof(id), 1, fp) != 1 ||
+				simindex_add(sip, fprint, id) != 0) {
+			return 2;
+		}
+	}
+	return 0;
+}
@@ -0,0 +1,81 @@
+#pragma once
+/* 
+ * simhash.h --- near-duplicate detection for crawled pages
+ * 
+ * Author: Khaidar Kairbek, Ava D. Rosenbaum
+ * Created: 10-18-2026
+ * Version: 1.0
+ * 
+ * Description: the SimHash of a page is a 64-bit fingerprint of the
+ * words of its text (see webpage_nextToken): every run of SIMHASH_SHINGLE consecutive words (a shingle)
+ * votes on each bit with the matching bit of its hash, and a bit is
+ * set where the votes are positive. Pages that share most of their
+ * shingles get fingerprints that differ in only a few bits, so the
+ * Hamming distance between fingerprints measures how near two pages
+ * are.
+ *
+ * A simindex keeps the fingerprints of stored pages and finds one
+ * within max_distance bits of a new fingerprint without comparing
+ * against them all. Fingerprints are cut into max_distance + 1 bands;
+ * two fingerprints that differ in at most max_distance bits agree
+ * exactly on at least one band, so only pages sharing a band value
+ * with the new one are compared.
+ *
+ * The index is not locked; callers sharing one between threads must
+ * serialize access.
+ */
+#include <stdio.h>
+#include <stdint.h>
+#include <webpage.h>
+
+#define SIMHASH_SHINGLE 3       // words per shingle
+#define SIMHASH_MAX_DISTANCE 15 // keeps every band at least 4 bits wide
+
+typedef struct simindex simindex_t;
+
+/* 
+ * simhash -- the SimHash of the words of page, case folded
+ * returns 0 if the page has no words
+ */
+uint64_t simhash(webpage_t *page);
+
+/* simhash_distance -- the number of bits in which a and b differ */
+int simhash_distance(uint64_t a, uint64_t b);
+
+/* 
+ * simindex_open -- create an empty index finding fingerprints at most
+ * max_distance (0 to SIMHASH_MAX_DISTANCE) bits apart
+ * returns NULL on failure
+ */
+simindex_t *simindex_open(int max_distance);
+
+/* simindex_close -- deallocate the index */
+void simindex_close(simindex_t *sip);
+
+/* simindex_size -- number of fingerprints in the index */
+int simindex_size(simindex_t *sip);
+
+/* 
+ * simindex_find -- look for a fingerprint within max_distance bits of fp
+ * returns the id it was added with; 0 if there is none
+ */
+int simindex_find(simindex_t *sip, uint64_t fp);
+
+/* 
+ * simindex_add -- add fingerprint fp of the page saved under id (>= 1)
+ * returns 0 for success; nonzero otherwise
+ */
+int32_t simindex_add(simindex_t *sip, uint64_t fp, int id);
+
+/* 
+ * simindex_save -- write the fingerprints to fp as <count:u64> then
+ * <fingerprint:u64><id:u32> each, in native byte order
+ * returns 0 for success; nonzero otherwise
+ */
+int32_t simindex_save(simindex_t *sip, FILE *fp);
+
+/* 
+ * simindex_load -- add the fingerprints written by simindex_save
+ * returns 0 for success; nonzero otherwise
+ */
+int32_t simindex_load(simindex_t *sip, FILE *fp);
@@ -0,0 +1,156 @@
+/* 
+ * termdict.c --- 
+ * 
+ * Author: Khaidar Kairbek, Ava D. Rosenbaum
+ * Created: 10-18-2026
+ * Version: 1.0
+ * 
+ * Description: Implementation of the term dictionary: an open
+ * addressing table with linear probing, kept at most half full. Each
+ * slot keeps the hash and length of its term, so a probe compares the
+ * characters only when both match.
+ * 
+ */
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include "arena.h"
+#include "termdict.h"
+
+#define TERMDICT_MIN_SLOTS 64
+#define TERMDICT_SCRATCH_SIZE 256
+
+typedef struct slot {
+	const char *term;     // NULL if the slot is free
+	uint32_t hash;
+	int len;
+	void *value;
+} slot_t;
+
+struct termdict {
+	slot_t *slots;
+	uint32_t nslots;      // a power of two
+	uint32_t size;
+	arena_t *arena;
+	char *scratch;
+	int scratch_size;
+};
+
+// FNV-1a
+static uint32_t hash_term(const char *term, int len) {
+	uint32_t h = 2166136261u;
+	for (int i = 0; i < len; i++) {
+		h ^= (unsigned char) term[i];
+		h *= 16777619u;
+	}
+	return h;
+}
+
+termdict_t *termdict_open(uint32_t capacity) {
+	termdict_t *tdp = malloc(sizeof(termdict_t));
+	if (tdp == NULL) return NULL;
+
+	tdp->nslots = TERMDICT_MIN_SLOTS;
+	while (tdp->nslots / 2 < capacity && tdp->nslots < (1u << 31)) tdp->nslots *= 2;
+	tdp->slots = calloc(tdp->nslots, sizeof(slot_t));
+	tdp->size = 0;
+	tdp->arena = arena_open(0);
+	tdp->scratch_size = TERMDICT_SCRATCH_SIZE;
+	tdp->scratch = malloc(tdp->scratch_size);
+	if (tdp->slots == NULL || tdp->arena == NULL || tdp->scratch == NULL) {
+		termdict_close(tdp);
+		return NULL;
+	}
+	return tdp;
+}
+
+void termdict_close(termdict_t *tdp) {
+	if (tdp == NULL) return;
+	free(tdp->slots);
+	arena_close(tdp->arena);
+	free(tdp->scratch);
+	free(tdp);
+}
+
+uint32_t termdict_size(termdict_t *tdp) {
+	return tdp == NULL ? 0 : tdp->size;
+}
+
+size_t termdict_memory(termdict_t *tdp) {
+	if (tdp == NULL) return 0;
+	return sizeof(termdict_t) + tdp->nslots * sizeof(slot_t) + tdp->scratch_size + arena_used(tdp->arena);
+}
+
+// the slot holding the term, or the free slot where it would go
+static slot_t *probe(slot_t *slots, uint32_t nslots, const char *term, int len, uint32_t hash) {
+	uint32_t mask = nslots - 1;
+	for (uint32_t i = hash & mask; ; i = (i + 1) & mask) {
+		slot_t *sp = &slots[i];
+		if (sp->term == NULL) return sp;
+		if (sp->hash == hash && sp->len == len && memcmp(sp->term, term, len) == 0) return sp;
+	}
+}
+
+// doubles the table
+static bool grow(termdict_t *tdp) {
+	if (tdp->nslots >= (1u << 31)) return false;
+	uint32_t nslots = tdp->nslots * 2;
+	slot_t *slots = calloc(nslots, sizeof(slot_t));
+	if (slots == NULL) return false;
+
+	for (uint32_t i = 0; i < tdp->nslots; i++) {
+		slot_t *sp = &tdp->slots[i];
+		if (sp->term != NULL) *probe(slots, nslots, sp->term, sp->len, sp->hash) = *sp;
+	}
+	free(tdp->slots);
+	tdp->slots = slots;
+	tdp->nslots = nslots;
+	return true;
+}
+
+void *termdict_find(termdict_t *tdp, const char *term, int len) {
+	if (tdp == NULL || term == NULL || len < 0) return NULL;
+	slot_t *sp = probe(tdp->slots, tdp->nslots, term, len, hash_term(term, len));
+	return sp->term == NULL ? NULL : sp->value;
+}
+
+const char *termdict_add(termdict_t *tdp, const char *term, int len, void *value) {
+	if (tdp == NULL || term == NULL || len < 0) return NULL;
+	if (tdp->size + 1 > tdp->nslots / 2 && !grow(tdp)) return NULL;
+
+	uint32_t hash = hash_term(term, len);
+	slot_t *sp = probe(tdp->slots, tdp->nslots, term, len, hash);
+	if (sp->term != NULL) return NULL;  // already there
+
+	char *copy = arena_strndup(tdp->arena, term, len);
+	if (copy == NULL) return NULL;
+	*sp = (slot_t) { .term = copy, .hash = hash, .len = len, .value = value };
+	tdp->size++;
+	return copy;
+}
+
+void *termdict_alloc(termdict_t *tdp, size_t size) {
+	return tdp == NULL ? NULL : arena_alloc(tdp->arena, size);
+}
+
+char *termdict_scratch(termdict_t *tdp, int len) {
+	if (tdp == NULL || len < 0) return NULL;
+	if (len + 1 > tdp->scratch_size) {
+		int size = tdp->scratch_size;
+		while (size < len + 1) size *= 2;
+		char *scratch = realloc(tdp->scratch, size);
+		if (scratch == NULL) return NULL;
+		tdp->scratch = scratch;
+		tdp->scratch_size = size;
+	}
+	return tdp->scratch;
+}
+
+void termdict_apply(termdict_t *tdp, void (*fn)(void *value)) {
+	if (tdp == NULL || fn == NULL) return;
+	for (uint32_t i = 0; i < tdp->nslots; i++) {
+		if (tdp->slots[i].term != NULL) fn(tdp->slots[i].value);
+	}
+}
@@ -0,0 +1,67 @@
+#pragma once
+/* 
+ * termdict.h --- an interned term dictionary
+ * 
+ * Author: Khaidar Kairbek, Ava D. Rosenbaum
+ * Created: 10-18-2026
+ * Version: 1.0
+ * 
+ * Description: a term dictionary maps terms to values. Terms are
+ * looked up by pointer and length, so a caller can search for a word
+ * in place or in a scratch buffer without making a string of it; only
+ * a term added for the first time is copied, into the dictionary's
+ * arena. The arena also serves the caller's values (termdict_alloc),
+ * and closing the dictionary frees all of it in one step.
+ *
+ * A dictionary is not locked; each thread should use its own.
+ */
+#include <stdint.h>
+#include <stddef.h>
+
+typedef struct termdict termdict_t;
+
+/* 
+ * termdict_open -- create an empty dictionary sized for about
+ * capacity terms; it grows as needed
+ * returns NULL on failure
+ */
+termdict_t *termdict_open(uint32_t capacity);
+
+/* termdict_close -- free the dictionary, its terms, and its arena */
+void termdict_close(termdict_t *tdp);
+
+/* termdict_size -- number of terms in the dictionary */
+uint32_t termdict_size(termdict_t *tdp);
+
+/* termdict_memory -- bytes held by the dictionary, its terms and its arena */
+size_t termdict_memory(termdict_t *tdp);
+
+/* 
+ * termdict_find -- the value of the len characters at term
+ * returns NULL if the term is not in the dictionary
+ */
+void *termdict_find(termdict_t *tdp, const char *term, int len);
+
+/* 
+ * termdict_add -- add a term not yet in the dictionary with a value
+ * returns the interned, NUL-terminated copy of the term, which lives
+ * as long as the dictionary; NULL on failure
+ */
+const char *termdict_add(termdict_t *tdp, const char *term, int len, void *value);
+
+/* 
+ * termdict_alloc -- size bytes from the dictionary's arena, freed
+ * when the dictionary is closed
+ * returns NULL on failure
+ */
+void *termdict_alloc(termdict_t *tdp, size_t size);
+
+/* 
+ * termdict_scratch -- a buffer of at least len + 1 bytes to build a
+ * term in before looking it up; valid until the next call
+ * returns NULL on failure
+ */
+char *termdict_scratch(termdict_t *tdp, int len);
+
+/* termdict_apply -- apply fn to the value of every term */
+void termdict_apply(termdict_t *tdp, void (*fn)(void *value));
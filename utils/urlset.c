@@ -0,0 +1,209 @@
+/* 
+ * urlset.c --- 
+ * 
+ * Author: Khaidar Kairbek, Ava D. Rosenbaum
+ * Created: 10-18-2026
+ * Version: 1.0
+ * 
+ * Description: Implementation of the url fingerprint set: linear
+ * probing over a power-of-two table kept at most half full, with 0
+ * marking an empty slot.
+ * 
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include "urlset.h"
+
+#define URLSET_INITIAL_SIZE 1024
+#define BLOOM_HASHES 4
+
+struct urlset {
+	uint64_t *slots;
+	uint64_t capacity;          // always a power of two
+	uint64_t size;
+	uint8_t *bloom;             // NULL when there is no filter
+	uint64_t bloom_bits;        // always a power of two
+	int bits_per_url;
+};
+
+/* 
+ * FNV-1a over the url, followed by the MurmurHash3 finalizer so that
+ * every bit of the fingerprint depends on every byte of the url.
+ */
+uint64_t urlfp(const char *url) {
+	uint64_t h = 14695981039346656037ULL;
+	for (const unsigned char *p = (const unsigned char *) url; *p; p++) {
+		h ^= *p;
+		h *= 1099511628211ULL;
+	}
+
+	h ^= h >> 33;
+	h *= 0xff51afd7ed558ccdULL;
+	h ^= h >> 33;
+	h *= 0xc4ceb9fe1a85ec53ULL;
+	h ^= h >> 33;
+
+	return h == 0 ? 1 : h;
+}
+
+/* bloom filter: BLOOM_HASHES probes by double hashing the fingerprint */
+
+static void bloom_set(urlset_t *usp, uint64_t fp) {
+	uint64_t h2 = (fp >> 32) | 1;
+	for (int i = 0; i < BLOOM_HASHES; i++) {
+		uint64_t bit = (fp + i * h2) & (usp->bloom_bits - 1);
+		usp->bloom[bit >> 3] |= 1 << (bit & 7);
+	}
+}
+
+static bool bloom_test(urlset_t *usp, uint64_t fp) {
+	uint64_t h2 = (fp >> 32) | 1;
+	for (int i = 0; i < BLOOM_HASHES; i++) {
+		uint64_t bit = (fp + i * h2) & (usp->bloom_bits - 1);
+		if (!(usp->bloom[bit >> 3] & (1 << (bit & 7)))) return false;
+	}
+	return true;
+}
+
+// sizes the filter for a full table; returns 0 for success
+static int32_t bloom_resize(urlset_t *usp) {
+	uint64_t bits = 64;
+	while (bits < usp->capacity / 2 * usp->bits_per_url) bits <<= 1;
+
+	uint8_t *bloom = calloc(bits / 8, 1);
+	if (bloom == NULL) return 1;
+
+	free(usp->bloom);
+	usp->bloom = bloom;
+	usp->bloom_bits = bits;
+	for (uint64_t i = 0; i < usp->capacity; i++) {
+		if (usp->slots[i] != 0) bloom_set(usp, usp->slots[i]);
+	}
+	return 0;
+}
+
+/* table */
+
+static uint64_t *find_slot(uint64_t *slots, uint64_t capacity, uint64_t fp) {
+	uint64_t i = fp & (capacity - 1);
+	while (slots[i] != 0 && slots[i] != fp) {
+		i = (i + 1) & (capacity - 1);
+	}
+	return &slots[i];
+}
+
+// the slot fp goes in, for an fp known not to be in the table
+static uint64_t *free_slot(uint64_t *slots, uint64_t capacity, uint64_t fp) {
+	uint64_t i = fp & (capacity - 1);
+	while (slots[i] != 0) {
+		i = (i + 1) & (capacity - 1);
+	}
+	return &slots[i];
+}
+
+static int32_t grow(urlset_t *usp) {
+	uint64_t capacity = usp->capacity * 2;
+	uint64_t *slots = calloc(capacity, sizeof(uint64_t));
+	if (slots == NULL) return 1;
+
+	for (uint64_t i = 0; i < usp->capacity; i++) {
+		if (usp->slots[i] != 0) *free_slot(slots, capacity, usp->slots[i]) = usp->slots[i];
+	}
+	free(usp->slots);
+	usp->slots = slots;
+	usp->capacity = capacity;
+
+	// a filter that cannot be resized still holds every url, only with more false hits
+	if (usp->bits_per_url > 0) bloom_resize(usp);
+	return 0;
+}
+
+urlset_t *urlset_open(int bloom_bits) {
+	urlset_t *usp = calloc(1, sizeof(urlset_t));
+	if (usp == NULL) return NULL;
+
+	usp->capacity = URLSET_INITIAL_SIZE;
+	usp->slots = calloc(usp->capacity, sizeof(uint64_t));
+	usp->bits_per_url = bloom_bits > 0 ? bloom_bits : 0;
+	if (usp->slots == NULL || (usp->bits_per_url > 0 && bloom_resize(usp) != 0)) {
+		urlset_close(usp);
+		return NULL;
+	}
+	return usp;
+}
+
+void urlset_close(urlset_t *usp) {
+	if (usp == NULL) return;
+	free(usp->slots);
+	free(usp->bloom);
+	free(usp);
+}
+
+bool urlset_containsfp(urlset_t *usp, uint64_t fp) {
+	if (usp == NULL || fp == 0) return false;
+	if (usp->bloom != NULL && !bloom_test(usp, fp)) return false;
+	return *find_slot(usp->slots, usp->capacity, fp) == fp;
+}
+
+bool urlset_addfp(urlset_t *usp, uint64_t fp) {
+	if (usp == NULL || fp == 0) return false;
+
+	// a url the filter turns away is new: it needs a free slot, not a search
+	uint64_t *slot = NULL;
+	if (usp->bloom == NULL || bloom_test(usp, fp)) {
+		slot = find_slot(usp->slots, usp->capacity, fp);
+		if (*slot == fp) return false;
+	}
+
+	// keep the table at most half full; a table that cannot grow takes no more
+	if (2 * (usp->size + 1) > usp->capacity) {
+		if (grow(usp) != 0) {
+			printf("Error: url set could not grow past %lu urls\n", (unsigned long) usp->size);
+			return false;
+		}
+		slot = NULL;
+	}
+	if (slot == NULL) slot = free_slot(usp->slots, usp->capacity, fp);
+
+	*slot = fp;
+	usp->size++;
+	if (usp->bloom != NULL) bloom_set(usp, fp);
+	return true;
+}
+
+bool urlset_contains(urlset_t *usp, const char *url) {
+	return url != NULL && urlset_containsfp(usp, urlfp(url));
+}
+
+bool urlset_add(urlset_t *usp, const char *url) {
+	return url != NULL && urlset_addfp(usp, urlfp(url));
+}
+
+uint64_t urlset_size(urlset_t *usp) {
+	return usp ? usp->size : 0;
+}
+
+int32_t urlset_save(urlset_t *usp, FILE *fp) {
+	if (usp == NULL || fp == NULL) return 1;
+
+	if (fwrite(&usp->size, sizeof(uint64_t), 1, fp) != 1) return 2;
+	for (uint64_t i = 0; i < usp->capacity; i++) {
+		if (usp->slots[i] != 0 && fwrite(&usp->slots[i], sizeof(uint64_t), 1, fp) != 1) return 2;
+	}
+	return 0;
+}
+
+int32_t urlset_load(urlset_t *usp, FILE *fp) {
+	if (usp == NULL || fp == NULL) return 1;
+
+	uint64_t count, fprint;
+	if (fread(&count, sizeof(uint64_t), 1, fp) != 1) return 2;
+	for (uint64_t i = 0; i < count; i++) {
+		if (fread(&fprint, sizeof(uint64_t), 1, fp) != 1) return 2;
+		if (!urlset_addfp(usp, fprint) && !urlset_containsfp(usp, fprint)) return 3;
+	}
+	return 0;
+}
@@ -0,0 +1,69 @@
+#pragma once
+/* 
+ * urlset.h --- compact set of url fingerprints
+ * 
+ * Author: Khaidar Kairbek, Ava D. Rosenbaum
+ * Created: 10-18-2026
+ * Version: 1.0
+ * 
+ * Description: instead of url strings the set keeps a 64-bit
+ * fingerprint of each url in an open-addressed table, 8 bytes per url
+ * plus slack. Two different urls share a fingerprint with probability
+ * about n^2 / 2^65, which a crawl of any size we run can ignore.
+ *
+ * An optional Bloom filter sits in front of the table: it is a
+ * fraction of the table's size and stays in cache, so most urls that
+ * were never added are turned away by a lookup without a probe into
+ * the (much larger) table, and are added without searching it first.
+ *
+ * The set is not locked; callers sharing one between threads must
+ * serialize access.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+typedef struct urlset urlset_t;
+
+/* urlfp -- the 64-bit fingerprint of a url (never 0) */
+uint64_t urlfp(const char *url);
+
+/* 
+ * urlset_open -- create an empty set; bloom_bits is the number of
+ * Bloom filter bits kept per url (0 for no filter)
+ */
+urlset_t *urlset_open(int bloom_bits);
+
+/* urlset_close -- deallocate the set */
+void urlset_close(urlset_t *usp);
+
+/* 
+ * urlset_add -- add a url to the set
+ * returns true if it was not in the set before; false if it was, or
+ * if the set is full and could not grow, in which case the url was
+ * not added and an error is printed
+ */
+bool urlset_add(urlset_t *usp, const char *url);
+
+/* urlset_contains -- is a url in the set */
+bool urlset_contains(urlset_t *usp, const char *url);
+
+/* urlset_addfp / urlset_containsfp -- as above, given a fingerprint */
+bool urlset_addfp(urlset_t *usp, uint64_t fp);
+bool urlset_containsfp(urlset_t *usp, uint64_t fp);
+
+/* urlset_size -- number of urls in the set */
+uint64_t urlset_size(urlset_t *usp);
+
+/* 
+ * urlset_save -- write the fingerprints as <count:u64><fp:u64>...
+ * returns 0 for success; nonzero otherwise
+ */
+int32_t urlset_save(urlset_t *usp, FILE *fp);
+
+/* 
+ * urlset_load -- add the fingerprints written by urlset_save
+ * returns 0 for success; nonzero otherwise
+ */
+int32_t urlset_load(urlset_t *usp, FILE *fp);
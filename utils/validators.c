@@ -0,0 +1,148 @@
+/* 
+ * validators.c --- 
+ * 
+ * Author: Khaidar Kairbek, Ava D. Rosenbaum
+ * Created: 10-18-2026
+ * Version: 1.0
+ * 
+ * Description: Implementation of the saved validators of a crawl.
+ * 
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include "hash.h"
+#include "webpage.h"
+#include "validators.h"
+
+#define VALIDATORS_HASH_SIZE 1021
+#define LINE_MAX_LEN 4096
+
+typedef struct entry {
+	int id;
+	char *url;
+	char *etag;             // NULL for none
+	char *last_modified;    // NULL for none
+} entry_t;
+
+struct validators {
+	hashtable_t *table;     // entries by url
+	int size;
+};
+
+static bool match_url(void *ep, const void *keyp) {
+	return strcmp(((entry_t *) ep)->url, (const char *) keyp) == 0;
+}
+
+static void free_entry(void *ep) {
+	entry_t *e = (entry_t *) ep;
+	free(e->url);
+	free(e->etag);
+	free(e->last_modified);
+	free(e);
+}
+
+// copies field, or returns NULL if it is empty
+static char *copy_field(const char *field) {
+	if (*field == '\0') return NULL;
+	char *copy = malloc(strlen(field) + 1);
+	if (copy != NULL) strcpy(copy, field);
+	return copy;
+}
+
+// splits a line into its four fields in place; returns 0 for success
+static int32_t split_line(char *line, char *fields[4]) {
+	line[strcspn(line, "\r\n")] = '\0';
+	fields[0] = line;
+	for (int i = 1; i < 4; i++) {
+		char *tab = strchr(fields[i - 1], '\t');
+		if (tab == NULL) return 1;
+		*tab = '\0';
+		fields[i] = tab + 1;
+	}
+	return 0;
+}
+
+validators_t *validators_load(char *dirnm) {
+	if (dirnm == NULL) return NULL;
+
+	validators_t *vp = malloc(sizeof(validators_t));
+	if (vp == NULL) return NULL;
+	vp->size = 0;
+	vp->table = hopen(VALIDATORS_HASH_SIZE);
+	if (vp->table == NULL) {
+		free(vp);
+		return NULL;
+	}
+
+	char path[300];
+	sprintf(path, "%s/%s", dirnm, VALIDATORS_FILE);
+	FILE *fp = fopen(path, "r");
+	if (fp == NULL) return vp;      // nothing saved
+
+	char line[LINE_MAX_LEN];
+	char *fields[4];
+	while (fgets(line, sizeof(line), fp) != NULL) {
+		if (split_line(line, fields) != 0) continue;
+		int id = atoi(fields[0]);
+		if (id < 1 || *fields[1] == '\0') continue;
+
+		entry_t *e = hremove(vp->table, match_url, fields[1], strlen(fields[1]));
+		if (e != NULL) {
+			free_entry(e);          // the later line wins
+			vp->size--;
+		}
+
+		e = malloc(sizeof(entry_t));
+		if (e == NULL) break;
+		e->id = id;
+		e->url = copy_field(fields[1]);
+		e->etag = copy_field(fields[2]);
+		e->last_modified = copy_field(fields[3]);
+		if (e->url == NULL || hput(vp->table, e, e->url, strlen(e->url)) != 0) {
+			free_entry(e);
+			continue;
+		}
+		vp->size++;
+	}
+
+	fclose(fp);
+	return vp;
+}
+
+void validators_close(validators_t *vp) {
+	if (vp == NULL) return;
+	happly(vp->table, free_entry);
+	hclose(vp->table);
+	free(vp);
+}
+
+int validators_size(validators_t *vp) {
+	return vp ? vp->size : 0;
+}
+
+int validators_find(validators_t *vp, const char *url, const char **etag, const char **last_modified) {
+	if (vp == NULL || url == NULL) return 0;
+
+	entry_t *e = hsearch(vp->table, match_url, url, strlen(url));
+	if (e == NULL) return 0;
+
+	*etag = e->etag;
+	*last_modified = e->last_modified;
+	return e->id;
+}
+
+int32_t validators_append(FILE *fp, webpage_t *page, int id) {
+	if (fp == NULL || page == NULL) return 1;
+
+	const char *etag = webpage_getETag(page);
+	const char *last_modified = webpage_getLastModified(page);
+	if (etag == NULL && last_modified == NULL) return 0;
+
+	int n = fprintf(fp, "%d\t%s\t%s\t%s\n", id, webpage_getURL(page),
+									etag ? etag : "", last_modified ? last_modified : "");
+	return n < 0 ? 2 : 0;
+}
@@ -0,0 +1,53 @@
+#pragma once
+/* 
+ * validators.h --- the HTTP validators saved with a crawl
+ * 
+ * Author: Khaidar Kairbek, Ava D. Rosenbaum
+ * Created: 10-18-2026
+ * Version: 1.0
+ * 
+ * Description: next to its pages, a crawl keeps the ETag and
+ * Last-Modified headers each page was served with in the text file
+ * <pagedir>/.validators, one line per page:
+ *
+ *   <id> TAB <url> TAB <etag> TAB <last-modified>
+ *
+ * where either validator may be empty. A later crawl of the same site
+ * loads them to fetch each page conditionally and reuse the saved
+ * copy when the server answers 304 Not Modified. Lines are appended as
+ * pages are saved; if an id or url repeats, the last line wins.
+ */
+#include <stdio.h>
+#include <stdint.h>
+#include <webpage.h>
+
+#define VALIDATORS_FILE ".validators"
+
+typedef struct validators validators_t;
+
+/* 
+ * validators_load -- load the validators saved in directory dirnm; a
+ * directory without any gives an empty set
+ * returns NULL on failure
+ */
+validators_t *validators_load(char *dirnm);
+
+/* validators_close -- free the set */
+void validators_close(validators_t *vp);
+
+/* validators_size -- number of urls in the set */
+int validators_size(validators_t *vp);
+
+/* 
+ * validators_find -- look up url; on success, *etag and *last_modified
+ * point into the set (NULL where the server sent none)
+ * returns the id the page was saved under; 0 if url is not in the set
+ */
+int validators_find(validators_t *vp, const char *url, const char **etag, const char **last_modified);
+
+/* 
+ * validators_append -- append the line for page, saved under id, to
+ * fp; pages the server sent no validators for are skipped
+ * returns 0 for success; nonzero otherwise
+ */
+int32_t validators_append(FILE *fp, webpage_t *page, int id);
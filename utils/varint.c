@@ -0,0 +1,35 @@
+/* 
+ * varint.c --- 
+ * 
+ * Author: Khaidar Kairbek, Ava D. Rosenbaum
+ * Created: 10-18-2026
+ * Version: 1.0
+ * 
+ * Description: Implementation of variable-length integers.
+ * 
+ */
+
+#include <stdint.h>
+#include "varint.h"
+
+int varint_put(uint8_t *buf, uint64_t v) {
+	int n = 0;
+	while (v >= 0x80) {
+		buf[n++] = (uint8_t) (v | 0x80);
+		v >>= 7;
+	}
+	buf[n++] = (uint8_t) v;
+	return n;
+}
+
+int varint_get(const uint8_t *buf, const uint8_t *end, uint64_t *v) {
+	uint64_t result = 0;
+	for (int n = 0; n < VARINT_MAX_LEN && buf + n < end; n++) {
+		result |= (uint64_t) (buf[n] & 0x7f) << (7 * n);
+		if ((buf[n] & 0x80) == 0) {
+			*v = result;
+			return n + 1;
+		}
+	}
+	return 0;
+}
@@ -0,0 +1,25 @@
+#pragma once
+/* 
+ * varint.h --- variable-length integers
+ * 
+ * Author: Khaidar Kairbek, Ava D. Rosenbaum
+ * Created: 10-18-2026
+ * Version: 1.0
+ * 
+ * Description: unsigned integers written seven bits per byte, low
+ * bits first, with the high bit of a byte set when more follow (LEB128).
+ * Small numbers such as the gaps between sorted ids take one byte.
+ */
+#include <stdint.h>
+
+#define VARINT_MAX_LEN 10   // bytes taken by the largest uint64_t
+
+/* varint_put -- write v at buf; returns the number of bytes written */
+int varint_put(uint8_t *buf, uint64_t v);
+
+/* 
+ * varint_get -- read a number at buf into *v, reading no further than end
+ * returns the number of bytes read; 0 if the number is truncated or
+ * longer than VARINT_MAX_LEN
+ */
+int varint_get(const uint8_t *buf, const uint8_t *end, uint64_t *v);
@@ -30,6 +30,10 @@ typedef struct webpage {
   char *html;                              // html code of the page
   size_t html_len;                         // length of html code
   int depth;                               // depth of crawl
+  char *etag;                              // ETag validator, or NULL
+  char *last_modified;                     // Last-Modified validator, or NULL
+  bool not_modified;                       // the last fetch answered 304
+  struct curl_slist *request_headers;      // conditional headers being sent
 } webpage_t;
 
 struct URL {
@@ -43,7 +47,6 @@ struct URL {
 
 /* Private function prototypes */
 static char *RemoveDotSegments(char *input);
-static void RemoveWhitespace(char* str);
 static int ParseURL(char* str, struct URL* url);
 static char *FixupRelativeURL(char *base, char *rel, size_t len);
 static void *checkp(void *p, char *message);
@@ -61,6 +64,24 @@ int   webpage_getDepth(const webpage_t *page) { return page ? page->depth : 0;
 int   webpage_getHTMLlen(const webpage_t *page) { return page ? page->html_len : 0; }
 char *webpage_getHTML(const webpage_t *page)  { return page ? page->html  : NULL; }
 char *webpage_getURL(const webpage_t *page)   { return page ? page->url   : NULL; }
+char *webpage_getETag(const webpage_t *page)  { return page ? page->etag  : NULL; }
+char *webpage_getLastModified(const webpage_t *page) { return page ? page->last_modified : NULL; }
+bool  webpage_notModified(const webpage_t *page) { return page ? page->not_modified : false; }
+
+void webpage_setHTML(webpage_t *page, char *html) {
+  if (page == NULL) return;
+  free(page->html);
+  page->html = html;
+  page->html_len = html ? strlen(html) : 0;
+}
+
+void webpage_setValidators(webpage_t *page, const char *etag, const char *last_modified) {
+  if (page == NULL) return;
+  free(page->etag);
+  free(page->last_modified);
+  page->etag = etag && *etag ? checkp(strdup(etag), "page->etag") : NULL;
+  page->last_modified = last_modified && *last_modified ? checkp(strdup(last_modified), "page->last_modified") : NULL;
+}
 
 
 webpage_t *webpage_new(char *url, const int depth, char *html) {
@@ -74,6 +95,10 @@ webpage_t *webpage_new(char *url, const int depth, char *html) {
   page->depth = depth;
   page->html = html;
   page->html_len = html ? strlen(html) : 0;
+  page->etag = NULL;
+  page->last_modified = NULL;
+  page->not_modified = false;
+  page->request_headers = NULL;
   return page;
 }
 
@@ -84,211 +109,197 @@ void webpage_delete(void *data)
   if (page != NULL) {
     if (page->url) free(page->url);
     if (page->html) free(page->html);
+    free(page->etag);
+    free(page->last_modified);
+    curl_slist_free_all(page->request_headers);
     free(page);
   }
 }
 
-/**************** webpage_getNextWord ****************/
+/**************** webpage_nextToken ****************/
 /*
- * webpage_getNextWord - returns the next word from doc[pos] into word
+ * webpage_nextToken - the next word or href from html[pos]
  * See "webpage.h" for full documentation.
- * Code is courtesy of Ray Jenkins and/or Charles Palmer, 
- *   cleaned by David Kotz in April 2016, 2017.
  *
  * Pseudocode:
- *     1. skip any leading non-alphabetic characters
- *     2. if we find a tag, i.e., <...tag...>, skip that tag
- *     3. save beginning of the word
- *     4. find the end, i.e., first non-alphabetic character
- *     5. create a new word buffer
- *     6. copy the word into the new buffer
- *     7. return first position past end of word
- * 
+ *     1. skip any non-alphabetic text
+ *     2. at a '<', find the end of the tag; for an <a> tag, walk its
+ *        attributes and, if it has an href, return its value and the
+ *        position past the tag
+ *     3. otherwise skip the tag and carry on
+ *     4. at a letter, return the run of letters as a word
  */
-int webpage_getNextWord(webpage_t *page, int pos, char **word) {
-  // make sure we have something to search, and a place for the result
-  if (page == NULL || page->html == NULL || word == NULL) {
-    return -1;
-  }
 
-  const char *doc = page->html;		   // the html document
-  const char *beg;                         // beginning of word
-  const char *end;                         // end of word
+// is c a character that ends a tag or attribute name?
+static bool EndsName(char c) {
+  return c == '\0' || c == '>' || c == '=' || c == '/' || isspace((unsigned char) c);
+}
 
-  // consume any non-alphabetic characters
-  while (doc[pos] != '\0' && !isalpha(doc[pos])) {
-    // if we find a tag, i.e., <...tag...>, skip it
-    if (doc[pos] == '<') {
-      end = strchr(&doc[pos], '>');    // find the close
-			/* ST: end is a pointer -- cant compare to a char */
-      if(*end == '\0' || *(++end) == '\0') { // ran out of html
-				return -1;
-      }
-      pos = end - doc;	      // skip over the <...tag...>
+/*
+ * ScanAnchor - walk the attributes of the <a> tag at html[pos], which
+ * points just past the tag name, noting the span of the href value.
+ * Returns the position past the closing '>', or -1 if the html ends first.
+ */
+static int ScanAnchor(const char *html, int pos, int *href, int *href_len) {
+  *href = -1;
+  while (true) {
+    while (isspace((unsigned char) html[pos]) || html[pos] == '/') pos++;
+    if (html[pos] == '\0') return -1;
+    if (html[pos] == '>') return pos + 1;
+
+    // attribute name
+    int name = pos;
+    while (!EndsName(html[pos])) pos++;
+    int name_len = pos - name;
+    if (name_len == 0) { pos++; continue; } // a stray '='
+
+    while (isspace((unsigned char) html[pos])) pos++;
+    if (html[pos] != '=') continue;         // attribute without a value
+    pos++;
+    while (isspace((unsigned char) html[pos])) pos++;
+
+    // attribute value, quoted or not
+    int value, value_len;
+    if (html[pos] == '"' || html[pos] == '\'') {
+      const char *close = strchr(&html[pos + 1], html[pos]);
+      if (close == NULL) return -1;
+      value = pos + 1;
+      value_len = close - &html[value];
+      pos = close - html + 1;
     } else {
-      pos++;		      // just move forward
+      value = pos;
+      while (html[pos] != '\0' && html[pos] != '>' && !isspace((unsigned char) html[pos])) pos++;
+      value_len = pos - value;
+    }
+
+    if (*href < 0 && name_len == 4 && strncasecmp(&html[name], "href", 4) == 0) {
+      // trim whitespace inside the quotes
+      while (value_len > 0 && isspace((unsigned char) html[value])) { value++; value_len--; }
+      while (value_len > 0 && isspace((unsigned char) html[value + value_len - 1])) value_len--;
+      *href = value;
+      *href_len = value_len;
     }
   }
+}
 
-  // ran out of html
-  if (doc[pos] == '\0') {
-    *word = NULL;
+int webpage_nextToken(const webpage_t *page, int pos, webpage_token_t *token) {
+  if (page == NULL || page->html == NULL || token == NULL || pos < 0) {
     return -1;
   }
 
-  // pos is at the first character of a word
-  beg = &(doc[pos]);
-
-  // consume word
-  while (doc[pos] != '\0' && isalpha(doc[pos])) {
-    pos++;
-  }
-  // at this point, doc[pos] is the first character *after* the word.
+  const char *html = page->html;
+
+  while (html[pos] != '\0') {
+    if (isalpha((unsigned char) html[pos])) {
+      // a word: the run of letters
+      int beg = pos;
+      while (isalpha((unsigned char) html[pos])) pos++;
+      token->kind = WEBPAGE_WORD;
+      token->offset = beg;
+      token->length = pos - beg;
+      return pos;
+    }
 
-  // pos refers to the last character of the word
-  end = &(doc[pos-1]);
+    if (html[pos] != '<') {
+      pos++;
+      continue;
+    }
 
-  // 'beg' points to first character of the word
-  // 'end' points to last character of the word
-  int wordlen = end - beg + 1;
+    // an anchor: "<a" followed by the end of the tag name
+    if ((html[pos + 1] == 'a' || html[pos + 1] == 'A') && EndsName(html[pos + 2])) {
+      int href, href_len;
+      int end = ScanAnchor(html, pos + 2, &href, &href_len);
+      if (end < 0) return -1;               // ran out of html
+      pos = end;
+      if (href >= 0) {
+        token->kind = WEBPAGE_HREF;
+        token->offset = href;
+        token->length = href_len;
+        return pos;
+      }
+      continue;
+    }
 
-  // allocate space for length of new word + '\0'
-  *word = calloc(wordlen + 1, sizeof(char));
-  if (*word == NULL) {	      // out of memory!
-    return -1;
+    // any other tag is skipped up to the next '>'
+    const char *end = strchr(&html[pos], '>');
+    if (end == NULL) return -1;             // ran out of html
+    pos = end - html + 1;
   }
 
-  // copy the new word
-  strncpy(*word, beg, wordlen);
-
-  return pos;
+  return -1;
 }
 
-/**************** webpage_getNextURL ****************/
+/**************** webpage_resolveHREF ****************/
 /*
- * get the next url from html[pos] into result
- *
- * Assumptions:
- *     1. page is valid, contains html and base_url
- *     2. pos = 0 on initial call
- *     3. result is NULL and will be allocated internally
+ * webpage_resolveHREF - see webpage.h for usage documentation.
  *
  * Pseudocode:
- *     1. check arguments
- *     2. if pos = 0: remove whitespace from html
- *     3. find hyperlink starting tags "<a" or "<A"
- *     4. find next href attribute "href="
- *     5. find next end tag ">"
- *     6. check that href comes before end tag
- *     7. deal with quoted and unquoted urls
- *     8. determine if url is absolute
- *     9. fixup relative links
- *    10. create new character buffer for result and return it
+ *     1. drop any #fragment; skip links that are only a fragment
+ *     2. determine if the url is absolute, i.e., ':' precedes any '/', '?' or '#'
+ *     3. skip absolute urls that are not http(s)
+ *     4. fixup relative links
  */
-int webpage_getNextURL(webpage_t *page, int pos, char **result) {
-  // make sure we have text and base url
-  if (page == NULL || page->html == NULL || page->url == NULL) {
-    return -1;
-  }
-
-  char *html = page->html;                 // the html document
-  char *base_url = page->url;		   // the base URL for this html
-  int bad_link;                            // is this link ill formatted?
-  int relative;                            // is this link relative?
-  char delim;                              // url delimiter: ' ', ''', '"'
-  char *lnk;                               // hyperlink tags
-  char *href;                              // href in a tag
-  char *end;                               // end of hyperlink tag or url
-  char *ptr;                               // absolute vs. relative
-  char *hash;                              // hash mark character
-
-  // condense html, makes parsing easier
-  if (pos == 0) {
-    RemoveWhitespace(html);
+char *webpage_resolveHREF(const webpage_t *page, const webpage_token_t *token) {
+  if (page == NULL || page->html == NULL || page->url == NULL ||
+      token == NULL || token->kind != WEBPAGE_HREF) {
+    return NULL;
   }
 
-  // parse for hyperlinks
-  do {
-    relative = 0;                        // assume absolute link
-    bad_link = 0;                        // assume valid link
-
-    // find tag "<a" or "<A""
-    lnk = strcasestr(&html[pos], "<a");
-
-    // no more links on this page
-    if (!lnk) { result = NULL; return -1; }
-
+  char *href = &page->html[token->offset];
+  int len = token->length;
 
-    // find next href after hyperlink tag
-    href = strcasestr(lnk, "href=");
+  const char *hash = memchr(href, '#', len);
+  if (hash != NULL) len = hash - href;
+  if (len == 0 && hash != NULL) return NULL;   // internal reference
 
-    // no more links on this page
-    if (!href) { result = NULL; return -1; }
-
-    // find end of hyperlink tag
-    end = strchr(lnk, '>');
-
-    // if the href we have is outside the current tag, continue
-    if (end && (end < href)) {
-      bad_link = 1; pos+=2; continue;
-    }
-
-    // move href to beginning of url
-    href+=5;
-
-    // something went wrong, just continue
-    if (!href) { bad_link=1; pos+=2; continue; }
-
-    // is the url quoted?
-    if (*href == '\'' || *href == '"') {  // yes, href="url" or href='url'
-      delim = *(href++);               // remember delimiter
-      end = strchr(href, delim);       // find next of same delimiter
-    } else {			       // no, href=url
-      end = strchr(href, '>');         // hope: <a ... href=url>
-      // since we've stripped whitespace
-      // this could mangle things like:
-      // <a ... href=url name=val>
-    }
+  // is the url absolute?
+  int i = 0;
+  while (i < len && strchr(":/?", href[i]) == NULL) i++;
+  if (i == len || href[i] != ':') {
+    return FixupRelativeURL(page->url, href, len);
+  }
+  if (len < 4 || strncasecmp(href, "http", 4) != 0) {
+    return NULL;                                // absolute, but not http(s)
+  }
 
-    // if there is a # before the end of the url, exclude the #fragment
-    hash = strchr(href, '#');
-    if (hash && hash < end) {
-      end = hash;
-    }
+  return checkp(strndup(href, len), "url");
+}
 
-    // if we don't know where to end the url, continue
-    if (!end) {
-      bad_link = 1; pos += 2; continue;
+/**************** webpage_getNextWord ****************/
+/*
+ * webpage_getNextWord - returns the next word from doc[pos] into word
+ * See "webpage.h" for full documentation.
+ */
+int webpage_getNextWord(webpage_t *page, int pos, char **word) {
+  webpage_token_t token;
+
+  if (word == NULL) return -1;
+  *word = NULL;
+  while ((pos = webpage_nextToken(page, pos, &token)) > 0) {
+    if (token.kind == WEBPAGE_WORD) {
+      *word = checkp(strndup(&page->html[token.offset], token.length), "word");
+      return pos;
     }
+  }
+  return -1;
+}
 
-    // have a link now
-    if (*href == '#') {                   // internal reference
-      bad_link = 1; pos += 2; continue;
-    }
+/**************** webpage_getNextURL ****************/
+/*
+ * webpage_getNextURL - returns the next url from html[pos] into result
+ * See "webpage.h" for full documentation.
+ */
+int webpage_getNextURL(webpage_t *page, int pos, char **result) {
+  webpage_token_t token;
 
-    // is the url absolute, i.e, ':' must precede any '/', '?', or '#'
-    ptr = strpbrk(href, ":/?#");
-    if (!ptr || *ptr != ':') { 
-      relative = 1; 
-    } else if (strncasecmp(href, "http", 4)) { // absolute, but not http(s)
-      bad_link = 1; pos += 2; continue;
+  if (result == NULL || page == NULL || page->url == NULL) return -1;
+  *result = NULL;
+  while ((pos = webpage_nextToken(page, pos, &token)) > 0) {
+    if (token.kind == WEBPAGE_HREF && (*result = webpage_resolveHREF(page, &token)) != NULL) {
+      return pos;
     }
-  } while (bad_link);                       // keep parsing
-
-  // have a good link now
-  if (relative) {                           // need to fixup relative links
-    *result = FixupRelativeURL(base_url, href, end - href);
-    if (!*result) { return -2; }
-  }
-	else {
-    // create new buffer
-    *result = calloc(end-href+1, sizeof(char));
-    if (!*result) { return -2; }          // check memory
-    // copy over absolute url
-    strncpy(*result, href, end - href);
-  }
-  // return position at the end of the url
-  return end - html;
+  }
+  return -1;
 }
 
 /******************** NormalizeURL *******************************/
@@ -849,30 +860,6 @@ static char *FixupRelativeURL(char *base, char *rel, size_t len)
 }
 
 
-/* ***************************************************************** */
-/*
- * RemoveWhitespace - removes whitespace from str
- * @str: char buffer to modify
- *
- * Eliminates whitespace by shifting and condensing all the non-whitespace
- * toward the beginning of the buffer. This does not alter the size of the
- * buffer.
- *
- * Should have no use outside of this file, thus declared static.
- */
-static void RemoveWhitespace(char* str)
-{
-  char *prev;                              // previous whitespace
-  char *cur;                               // current non-whitespace
-
-  // start at beginning of str
-  cur = prev = str;
-
-  do {
-    while (isspace(*cur)) cur++;          // consume any whitespace
-  } while ((*prev++ = *cur++));            // condense to front of str
-}
-
 /**************** checkp ****************/
 /* if pointer p is NULL, print error message and die,
  * otherwise, return p unchanged.
@@ -912,34 +899,55 @@ static size_t WriteMemoryCallback(void *contents, size_t size, size_t nmemb, voi
 }
 
 
-/* ************* webpage_fetch ******************** */
-/* see webpage.h for usage documentation.
+/* HeaderCallback - curl callback for each response header line
  *
- * Pseudocode:
- *     1. check for valid page pointer
- *     2. allocate buffer to page->html, set page->html_len to 0
- *     3. setup curl
- *     4. curl the page->url
- *     5. check return status
- *     6. cleanup
+ * Notes whether the response is a 304 and keeps the ETag and
+ * Last-Modified validators; a response other than 304 drops the
+ * validators the page was fetched with.
  */
-bool webpage_fetch(webpage_t *page) {
-  const int MAX_TRY = 3;               // maximum attempts to fetch
-  static char errbuf[CURL_ERROR_SIZE]; // buffer for error messages
-  int tries = 0;		       // number of attempts at curl
-  bool status = true;		       // return value
-  CURL* curl_handle;		       // curl handle
-  CURLcode res;		               // curl response code
+static size_t HeaderCallback(char *buffer, size_t size, size_t nitems, void *userp) {
+  size_t len = size * nitems;
+  webpage_t *page = (webpage_t*) userp;
+  char **field = NULL;
+  size_t skip = 0;
+
+  if (len > 5 && strncmp(buffer, "HTTP/", 5) == 0) {
+    char *code = memchr(buffer, ' ', len);
+    page->not_modified = code != NULL && strncmp(code, " 304", 4) == 0;
+    if (!page->not_modified) webpage_setValidators(page, NULL, NULL);
+    return len;
+  }
 
-  // check page
-  if (page == NULL) { return false; }
+  if (len > 5 && strncasecmp(buffer, "ETag:", 5) == 0) {
+    field = &page->etag;
+    skip = 5;
+  } else if (len > 14 && strncasecmp(buffer, "Last-Modified:", 14) == 0) {
+    field = &page->last_modified;
+    skip = 14;
+  } else {
+    return len;
+  }
+
+  // trim the value; it may not be null-terminated
+  char *value = buffer + skip;
+  size_t vlen = len - skip;
+  while (vlen > 0 && isspace(*value)) { value++; vlen--; }
+  while (vlen > 0 && isspace(value[vlen - 1])) vlen--;
+  if (vlen > 0) {
+    free(*field);
+    *field = checkp(strndup(value, vlen), "page validator");
+  }
+  return len;
+}
 
+/* ************* webpage_prepare ******************** */
+/* see webpage.h for usage documentation. */
+void webpage_prepare(webpage_t *page, CURL *curl_handle, char *errbuf) {
   // allocate space for the html, curl will realloc as needed
-  page->html = calloc(1, sizeof(char));
+  free(page->html);
+  page->html = checkp(calloc(1, sizeof(char)), "page->html");
   page->html_len = 0;
-
-  // init curl session
-  curl_handle = curl_easy_init();
+  errbuf[0] = '\0';
 
   // specify url
   curl_easy_setopt(curl_handle, CURLOPT_URL, page->url);
@@ -957,32 +965,85 @@ bool webpage_fetch(webpage_t *page) {
   curl_easy_setopt(curl_handle, CURLOPT_FAILONERROR, 1);
 
   // save error messages
-  curl_easy_setopt(curl_handle, CURLOPT_ERRORBUFFER, &errbuf);
+  curl_easy_setopt(curl_handle, CURLOPT_ERRORBUFFER, errbuf);
+
+  // ask only for changes since the validators the page holds, if any
+  curl_slist_free_all(page->request_headers);
+  page->request_headers = NULL;
+  page->not_modified = false;
+  char header[1024];
+  if (page->etag != NULL) {
+    snprintf(header, sizeof(header), "If-None-Match: %s", page->etag);
+    page->request_headers = curl_slist_append(page->request_headers, header);
+  }
+  if (page->last_modified != NULL) {
+    snprintf(header, sizeof(header), "If-Modified-Since: %s", page->last_modified);
+    page->request_headers = curl_slist_append(page->request_headers, header);
+  }
+  curl_easy_setopt(curl_handle, CURLOPT_HTTPHEADER, page->request_headers);
+
+  // note the status and validators of the response
+  curl_easy_setopt(curl_handle, CURLOPT_HEADERFUNCTION, HeaderCallback);
+  curl_easy_setopt(curl_handle, CURLOPT_HEADERDATA, (void*)page);
+}
+
+/* ************* webpage_complete ******************** */
+/* see webpage.h for usage documentation. */
+bool webpage_complete(webpage_t *page, CURLcode res, const char *errbuf) {
+  if (res == CURLE_OK) {
+    return true;
+  }
+
+  // we're going to return the curl error message on failure
+  if (errbuf[0] == '\0') {
+    errbuf = curl_easy_strerror(res);
+  }
+  free(page->html);
+  page->html = checkp(calloc(strlen(errbuf) + 1, sizeof(char)), "page->html");
+  page->html_len = strlen(errbuf);
+  strcpy(page->html, errbuf);
+
+  return false;
+}
+
+/* ************* webpage_fetch ******************** */
+/* see webpage.h for usage documentation.
+ *
+ * Pseudocode:
+ *     1. check for valid page pointer
+ *     2. setup curl and the page buffer (webpage_prepare)
+ *     3. curl the page->url
+ *     4. check return status (webpage_complete)
+ *     5. cleanup
+ */
+bool webpage_fetch(webpage_t *page) {
+  const int MAX_TRY = 3;               // maximum attempts to fetch
+  char errbuf[CURL_ERROR_SIZE] = "";   // buffer for error messages
+  int tries = 0;		       // number of attempts at curl
+  bool status = true;		       // return value
+  CURL* curl_handle;		       // curl handle
+  CURLcode res;		               // curl response code
+
+  // check page
+  if (page == NULL) { return false; }
+
+  // init curl session
+  curl_handle = curl_easy_init();
+  if (curl_handle == NULL) { return false; }
+
+  webpage_prepare(page, curl_handle, errbuf);
 
   // get the page; repeat MAX_TRY times
   do {
+    page->html_len = 0;                // drop any partial earlier attempt
     res = curl_easy_perform(curl_handle);
-#ifndef NOSLEEP // CS50 students: please don't turn off the sleep!
-    sleep(1);   // sleep one second between fetches, to lighten load on server
-#endif
   } while (res != CURLE_OK && ++tries < MAX_TRY);
 
   // check response code
-  if (res != CURLE_OK) {
-    // we're going to return the curl error message on failure
-    free(page->html);
-    page->html = calloc(strlen(errbuf) + 1, sizeof(char));
-    page->html_len = strlen(errbuf);
-    strcpy(page->html, errbuf);
+  status = webpage_complete(page, res, errbuf);
 
-    status = false;                          // signal failure
-  }
-
-  // cleanup curl stuff
+  // cleanup curl stuff; global state is left to the caller (see webpage.h)
   curl_easy_cleanup(curl_handle);
-  curl_global_cleanup();
 
   return status;
 }
-
-
@@ -22,6 +22,23 @@ int   webpage_getDepth(const webpage_t *page);
 int   webpage_getHTMLlen(const webpage_t *page);
 char *webpage_getURL(const webpage_t *page);
 char *webpage_getHTML(const webpage_t *page);
+char *webpage_getETag(const webpage_t *page);
+char *webpage_getLastModified(const webpage_t *page);
+bool  webpage_notModified(const webpage_t *page);
+
+/* webpage_setHTML: replace the page's html (freed) with html, which
+ * the page now owns; html may be NULL.
+ */
+void webpage_setHTML(webpage_t *page, char *html);
+
+/* webpage_setValidators: set the ETag and Last-Modified validators of
+ * the page (copied; NULL or "" for none). A fetch of a page holding
+ * validators is conditional: it sends If-None-Match/If-Modified-Since,
+ * and if the server answers 304 Not Modified, the fetch succeeds with
+ * empty html and webpage_notModified() is true. After any fetch, the
+ * page holds the validators the server sent with it.
+ */
+void webpage_setValidators(webpage_t *page, const char *etag, const char *last_modified);
 
 /**************** webpage_new ****************/
 /* Allocate and initialize a new webpage_t structure.
@@ -70,17 +87,82 @@ void webpage_delete(void *data);
  * Returns:
  *     True: success; caller must later free(webpage_getHTML(page));
  *     False: some error fetching page.
+ *
+ * Politeness:
+ *     webpage_fetch does not pause between fetches; callers crawling a
+ *     server are expected to space their requests out (see sched.h).
+ *
+ * Threads:
+ *     webpage_fetch may be called from several threads at once, provided
+ *     the program calls curl_global_init() once before starting them and
+ *     curl_global_cleanup() once after they have all finished.
  */
 bool webpage_fetch(webpage_t *page);
 
+/***************** webpage_prepare / webpage_complete *****************/
+/* the two halves of webpage_fetch, for callers that drive their own
+ * curl handles (see fetch.h).
+ *
+ * webpage_prepare sets the url, user agent and write and header
+ * callbacks of handle so that the response body lands in page->html
+ * and the validators in the page; any html the page already holds is
+ * freed. The request is conditional if the page holds validators.
+ * errbuf must hold CURL_ERROR_SIZE bytes and stay valid until the
+ * transfer is over.
+ *
+ * webpage_complete is given the result of the transfer. On success it
+ * returns true; otherwise page->html is replaced by the error message,
+ * as webpage_fetch does, and it returns false.
+ */
+void webpage_prepare(webpage_t *page, CURL *handle, char *errbuf);
+bool webpage_complete(webpage_t *page, CURLcode res, const char *errbuf);
 
-/**************** webpage_getNextWord ***********************************/
-/* return the next word from html[pos] into word
+
+/**************** webpage_nextToken ***********************************/
+/* scan the html from html[pos] for the next token, a word of the text
+ * or the href of a link, in a single pass
+ * @page: pointer to the webpage info, with html
+ * @pos: current position in html buffer; 0 on the initial call
+ * @token: filled in with the kind and the span of the token
  *
- * Assumptions:
- *     1. webpage has html
- *     2. don't care about opening/closing tags: ignore anything between <...>
- *     3. if the html is malformed, we don't care: match '<' with next '>'
+ * Returns the position to continue from; otherwise, returns < 0 once
+ * the html is exhausted.
+ *
+ * A word is a run of letters outside of any tag (<...>). An href is
+ * the value of the href attribute of an <a> tag, quotes and
+ * surrounding white space left out. Tokens are spans of the page's
+ * html (html + offset, length bytes, not null-terminated): nothing is
+ * allocated and the html is not changed, so a page may be scanned any
+ * number of times, from several threads at once.
+ *
+ * Usage example: (count the words and links of a page)
+ * webpage_token_t token;
+ * for (int pos = 0; (pos = webpage_nextToken(page, pos, &token)) > 0; ) {
+ *     if (token.kind == WEBPAGE_WORD) words++; else links++;
+ * }
+ */
+typedef enum { WEBPAGE_WORD, WEBPAGE_HREF } webpage_token_kind_t;
+
+typedef struct webpage_token {
+  webpage_token_kind_t kind;
+  int offset;                              // of the first character in html
+  int length;                              // in characters
+} webpage_token_t;
+
+int webpage_nextToken(const webpage_t *page, int pos, webpage_token_t *token);
+
+/**************** webpage_resolveHREF ***********************************/
+/* the absolute url an href token of page refers to, resolved against
+ * the page's url and without its #fragment, in a newly allocated buffer
+ * the caller must free. Returns NULL for links that cannot be followed:
+ * fragments of the page itself and absolute urls other than http(s).
+ * The url is not normalized (see NormalizeURL).
+ */
+char *webpage_resolveHREF(const webpage_t *page, const webpage_token_t *token);
+
+/**************** webpage_getNextWord ***********************************/
+/* return the next word from html[pos] into word; a convenience over
+ * webpage_nextToken that copies the word
  *
  * Memory contract:
  *     1. inbound, webpage points to an existing struct, with existing html;
@@ -91,7 +173,8 @@ bool webpage_fetch(webpage_t *page);
 int webpage_getNextWord(webpage_t *page, int pos, char **word);
 
 /****************** webpage_getNextURL ***********************************/
-/* return the next url from html[pos] into result
+/* return the next url from html[pos] into result; a convenience over
+ * webpage_nextToken and webpage_resolveHREF
  * @page: pointer to the webpage info
  * @pos: current position in html buffer
  * @result: a pointer to character pointer, used to pass the url back out
@@ -99,13 +182,10 @@ int webpage_getNextWord(webpage_t *page, int pos, char **word);
  * Returns the current position search so far in html; otherwise, returns < 0.
  * The page should already exist (not NULL), and contain non-NULL html and url strings.
  * The pos argument should be 0 on the initial call; a new position is returned.
- * The result argument should be a NULL pointer.
  * On successful parse of html, result will contain a newly allocated character
  * buffer; may be NULL on failed return. The caller is responsible for free'ing
  * this memory.
  *
- * Side effect: the page's html will be compressed to remove white space.
- *
  * Usage example: (retrieve all urls in a page)
  * int pos = 0;
  * char *result;